@@ -13,7 +13,7 @@ USE_DEFAULT_QUEUE="#define USE_MY_QUEUE (0)"
 
 set_up
 
-for test_name in SIMPLE FAST_SLOW SLOW_FAST SEND_BACK_ISR RECEIVE_ISR
+for test_name in SIMPLE FAST_SLOW SLOW_FAST SEND_BACK_ISR RECEIVE_ISR BATCH SPSC ZERO_COPY STATIC QUEUE_SET VARIABLE ZERO_COPY_SHARED
 do
     # set test
     running_test="#define RUNNING_TEST ($test_name)"
@@ -44,3 +44,6 @@ do
 done
 
 tear_down
+
+# manual benchmarks (compare the cycle counts printed for each queue)
+# - ISR_BENCH
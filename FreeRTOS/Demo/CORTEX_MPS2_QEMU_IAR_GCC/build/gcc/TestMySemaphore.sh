@@ -14,7 +14,8 @@ USE_DEFAULT_SEM="#define USE_MY_SEM (0)"
 set_up
 
 for test_name in BINARY_SAME_PRIORITY BINARY_DIFF_PRIORITY \
-                 COUNTING_SAME_PRIORITY COUNTING_DIFF_PRIORITY GIVE_FROM_ISR
+                 COUNTING_SAME_PRIORITY COUNTING_DIFF_PRIORITY GIVE_FROM_ISR TAKE_N \
+                 MUTEX_INHERIT
 do
     # set test
     running_test="#define RUNNING_TEST ($test_name)"
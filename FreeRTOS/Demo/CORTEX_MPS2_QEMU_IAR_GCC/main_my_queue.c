@@ -1,6 +1,8 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "semphr.h"
+#include "message_buffer.h"
 #include "my_semaphore.h"
 #include "my_queue.h"
 
@@ -8,6 +10,7 @@
 #include "core_cm3.h"
 
 #include <stdio.h>
+#include <string.h>
 
 // Identifiers for test
 #define SIMPLE (0)
@@ -15,6 +18,14 @@
 #define SLOW_FAST (2)
 #define SEND_BACK_ISR (3)
 #define RECEIVE_ISR (4)
+#define BATCH (5)
+#define SPSC (6)
+#define ZERO_COPY (7)
+#define STATIC (8)
+#define ISR_BENCH (9)
+#define QUEUE_SET (10)
+#define VARIABLE (11)
+#define ZERO_COPY_SHARED (12)
 
 #define SEND_IRQN (UARTRX1_IRQn)
 #define RECEIVE_IRQN (UARTTX1_IRQn)
@@ -41,6 +52,18 @@
         xMyQueueReceiveFromISR(MyQueue, \
                                ((void*) (BUFFER)), \
                                (BaseType_t*) (WOKEN))
+    #define QUEUE_SEND_BACK_BATCH(ITEMS, COUNT, DELAY) \
+        xMyQueueSendToBackBatch(MyQueue, \
+                                ((void*) (ITEMS)), \
+                                (COUNT), \
+                                pdTRUE, \
+                                (DELAY))
+    #define QUEUE_RECEIVE_BATCH(BUFFER, COUNT, DELAY) \
+        xMyQueueReceiveBatch(MyQueue, \
+                             ((void*) (BUFFER)), \
+                             (COUNT), \
+                             pdFALSE, \
+                             (DELAY))
 #else
     #define QUEUE_NAME "Default Queue"
     #define QUEUE_SEND_BACK(ITEM, DELAY) xQueueSendToBack(DefaultQueue, \
@@ -57,6 +80,11 @@
         xQueueReceiveFromISR(DefaultQueue, \
                              ((void*) (BUFFER)), \
                              (BaseType_t*) (WOKEN))
+    // default queue has no batch API so move the items one at a time
+    #define QUEUE_SEND_BACK_BATCH(ITEMS, COUNT, DELAY) \
+        DefaultQueueSendBatch((ITEMS), (COUNT), (DELAY))
+    #define QUEUE_RECEIVE_BATCH(BUFFER, COUNT, DELAY) \
+        DefaultQueueReceiveBatch((BUFFER), (COUNT), (DELAY))
 #endif
 
 // Global queue variables
@@ -74,14 +102,79 @@ void InitializeQueue(UBaseType_t QueueLength, UBaseType_t ItemSize) {
     #endif
 }
 
+// queue and its storage live in caller provided buffers, no heap is used
+void InitializeStaticQueue(UBaseType_t QueueLength,
+                           UBaseType_t ItemSize,
+                           uint8_t* Storage) {
+    #if USE_MY_QUEUE == 1
+        static StaticMyQueue_t QueueBuffer;
+        MyQueue = xMyQueueCreateStatic(QueueLength, ItemSize, Storage, &QueueBuffer);
+        configASSERT(MyQueue);
+    #else
+        static StaticQueue_t QueueBuffer;
+        DefaultQueue = xQueueCreateStatic(QueueLength, ItemSize, Storage, &QueueBuffer);
+        configASSERT(DefaultQueue);
+    #endif
+}
+
+// default queue has no SPSC mode so it uses a regular queue
+void InitializeSPSCQueue(UBaseType_t QueueLength, UBaseType_t ItemSize) {
+    #if USE_MY_QUEUE == 1
+        MyQueue = pxMyQueueCreateSPSC(QueueLength, ItemSize);
+        configASSERT(MyQueue);
+    #else
+        DefaultQueue = xQueueCreate(QueueLength, ItemSize);
+        configASSERT(DefaultQueue);
+    #endif
+}
+
 extern void CallIRQN(IRQn_Type irqn, uint32_t Priority);
 
+#if USE_MY_QUEUE != 1
+// send all items or none, like xMyQueueSendToBackBatch with xWaitForAll set
+size_t DefaultQueueSendBatch(const int* Items, size_t Count, TickType_t Delay) {
+    TickType_t Start = xTaskGetTickCount();
+    while (uxQueueSpacesAvailable(DefaultQueue) < Count) {
+        if (xTaskGetTickCount() - Start >= Delay)
+            return 0;
+        vTaskDelay(1);
+    }
+
+    for (size_t i = 0; i < Count; ++i)
+        configASSERT(xQueueSendToBack(DefaultQueue, &Items[i], 0) == pdTRUE);
+
+    return Count;
+}
+
+// receive at least one item, like xMyQueueReceiveBatch without xWaitForAll
+size_t DefaultQueueReceiveBatch(int* Buffer, size_t Count, TickType_t Delay) {
+    size_t Received = 0;
+
+    if (xQueueReceive(DefaultQueue, &Buffer[Received], Delay) == pdTRUE) {
+        Received++;
+        while (Received < Count &&
+               xQueueReceive(DefaultQueue, &Buffer[Received], 0) == pdTRUE)
+            Received++;
+    }
+
+    return Received;
+}
+#endif
+
 // Test function declarations
 void TestSimple();
 void TestFastSlow();
 void TestSlowFast();
 void TestSendToBackFromISR();
 void TestReceiveFromISR();
+void TestBatch();
+void TestSPSC();
+void TestZeroCopy();
+void TestStatic();
+void TestISRBench();
+void TestQueueSet();
+void TestVariable();
+void TestZeroCopyShared();
 
 void main_my_queue(void) {
     printf("Using %s\n", QUEUE_NAME);
@@ -101,6 +194,30 @@ void main_my_queue(void) {
     #elif RUNNING_TEST == RECEIVE_ISR
         printf("Running ReceiveFromISR test\n");
         TestReceiveFromISR();
+    #elif RUNNING_TEST == BATCH
+        printf("Running batch send and receive test\n");
+        TestBatch();
+    #elif RUNNING_TEST == SPSC
+        printf("Running single producer single consumer test\n");
+        TestSPSC();
+    #elif RUNNING_TEST == ZERO_COPY
+        printf("Running zero copy reserve and peek test\n");
+        TestZeroCopy();
+    #elif RUNNING_TEST == STATIC
+        printf("Running statically allocated queue test\n");
+        TestStatic();
+    #elif RUNNING_TEST == ISR_BENCH
+        printf("Running FromISR cost benchmark\n");
+        TestISRBench();
+    #elif RUNNING_TEST == QUEUE_SET
+        printf("Running queue set test\n");
+        TestQueueSet();
+    #elif RUNNING_TEST == VARIABLE
+        printf("Running variable length message test\n");
+        TestVariable();
+    #elif RUNNING_TEST == ZERO_COPY_SHARED
+        printf("Running shared zero copy reserve test\n");
+        TestZeroCopyShared();
     #else
         printf("Invalid test selection\n");
     #endif
@@ -209,7 +326,17 @@ void TestSlowFast() {
 BaseType_t ExpectedSendFromISRReturn, ExpectedSendFromISRWoken;
 int SendItem;
 
+// set while TestISRBench wants SEND_IRQN to run the benchmark instead
+volatile int ISRBenchRunning = 0;
+void ISRBench();
+
 void QueueSendFromISRHandler() {
+    if (ISRBenchRunning) {
+        ISRBench();
+        ISRBenchRunning = 0;
+        return;
+    }
+
     printf("SendToBackFromISR\n");
     BaseType_t HigherPriorityTaskWoken = pdFALSE;
 
@@ -379,3 +506,559 @@ void TestReceiveFromISR() {
 
     vTaskStartScheduler();
 }
+
+// *****************************************************************************
+// TestBatch
+// *****************************************************************************
+static void BatchProducerTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    // send bursts of 4, queue only fits 6 so the second burst has to wait
+    // for the consumer to drain the queue
+    int Items[4];
+    for (int burst = 0; burst < 5; ++burst) {
+        for (int i = 0; i < 4; ++i)
+            Items[i] = burst * 4 + i;
+
+        // only the consumer prints since when a blocked burst gets through
+        // depends on the queue implementation
+        configASSERT(QUEUE_SEND_BACK_BATCH(Items, 4, pdMS_TO_TICKS(100)) == 4);
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void BatchConsumerTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    int Buffer[3];
+    for (int received = 0; received < 20;) {
+        size_t Count = QUEUE_RECEIVE_BATCH(Buffer, 3, portMAX_DELAY);
+        configASSERT(Count >= 1);
+
+        for (size_t i = 0; i < Count; ++i) {
+            configASSERT(Buffer[i] == received);
+            printf("Received %d\n", Buffer[i]);
+            received++;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    vTaskDelete(NULL);
+}
+
+void TestBatch() {
+    InitializeQueue(6, sizeof(int));
+
+    xTaskCreate(BatchProducerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+    xTaskCreate(BatchConsumerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestSPSC
+// *****************************************************************************
+void TestSPSC() {
+    // one producer and one consumer on a lock free queue, consumer is slower
+    // so the producer has to block on a full queue
+    // should see values 0, 1, ..., 9 in order
+    InitializeSPSCQueue(3, sizeof(int));
+
+    xTaskCreate(ProducerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                (void*) 5,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+    xTaskCreate(ConsumerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                (void*) 25,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestZeroCopy
+// *****************************************************************************
+static void ZeroCopyProducerTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    for (int i = 0; i < 10; ++i) {
+        #if USE_MY_QUEUE == 1
+            // build the item directly in the queue
+            int* Slot = pvMyQueueReserve(MyQueue, portMAX_DELAY);
+            configASSERT(Slot);
+            *Slot = i * i;
+            vMyQueueCommit(MyQueue, Slot);
+        #else
+            // default queue has no zero copy API so copy the item in
+            int Item = i * i;
+            configASSERT(QUEUE_SEND_BACK(&Item, portMAX_DELAY) == pdTRUE);
+        #endif
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void ZeroCopyConsumerTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    for (int i = 0; i < 10; ++i) {
+        #if USE_MY_QUEUE == 1
+            // read the item where it sits in the queue
+            int* Slot = pvMyQueuePeekSlot(MyQueue, portMAX_DELAY);
+            configASSERT(Slot);
+            printf("Received %d\n", *Slot);
+            vMyQueueRelease(MyQueue, Slot);
+        #else
+            int Item;
+            configASSERT(QUEUE_RECEIVE(&Item, portMAX_DELAY) == pdTRUE);
+            printf("Received %d\n", Item);
+        #endif
+
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    vTaskDelete(NULL);
+}
+
+void TestZeroCopy() {
+    // producer is faster so it has to wait for the consumer to release slots
+    // should see values 0, 1, 4, ..., 81 in order
+    InitializeQueue(3, sizeof(int));
+
+    xTaskCreate(ZeroCopyProducerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+    xTaskCreate(ZeroCopyConsumerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestStatic
+// *****************************************************************************
+void TestStatic() {
+    // same as TestFastSlow but without allocating the queue from the heap
+    // should see values 0, 1, ..., 9 in order
+    static uint8_t Storage[3 * sizeof(int)];
+    InitializeStaticQueue(3, sizeof(int), Storage);
+
+    xTaskCreate(ProducerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                (void*) 5,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+    xTaskCreate(ConsumerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                (void*) 25,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestISRBench
+// *****************************************************************************
+// Not run by TestMyQueue.sh since the numbers differ between the queues. The
+// cycles come from the SysTick counter, so run QEMU with "-icount shift=0" to
+// get numbers that do not depend on the host
+#define ISR_BENCH_ITERATIONS (1000)
+
+uint32_t ISRBenchSendCycles = 0;
+uint32_t ISRBenchReceiveCycles = 0;
+
+static uint32_t CyclesSince(uint32_t Start) {
+    // SysTick counts down from LOAD and wraps at most once in between
+    uint32_t Now = SysTick->VAL;
+    return (Start >= Now) ? Start - Now : Start + (SysTick->LOAD + 1) - Now;
+}
+
+// runs in SEND_IRQN so every call is made from a real interrupt
+void ISRBench() {
+    int Item = 0;
+    BaseType_t HigherPriorityTaskWoken = pdFALSE;
+
+    for (int i = 0; i < ISR_BENCH_ITERATIONS; ++i) {
+        // keep the calls out of configASSERT so they still run when it is compiled out
+        uint32_t Start = SysTick->VAL;
+        BaseType_t Sent = QUEUE_SEND_BACK_ISR(&Item, &HigherPriorityTaskWoken);
+        ISRBenchSendCycles += CyclesSince(Start);
+        configASSERT(Sent == pdTRUE);
+
+        Start = SysTick->VAL;
+        BaseType_t Received = QUEUE_RECEIVE_ISR(&Item, &HigherPriorityTaskWoken);
+        ISRBenchReceiveCycles += CyclesSince(Start);
+        configASSERT(Received == pdTRUE);
+    }
+
+    // nobody was waiting so no task could have been woken
+    configASSERT(HigherPriorityTaskWoken == pdFALSE);
+}
+
+static void ISRBenchTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    ISRBenchRunning = 1;
+    CallIRQN(SEND_IRQN, 1);
+    while (ISRBenchRunning) {
+    }
+
+    printf("SendToBackFromISR %u cycles\n",
+           (unsigned) (ISRBenchSendCycles / ISR_BENCH_ITERATIONS));
+    printf("ReceiveFromISR %u cycles\n",
+           (unsigned) (ISRBenchReceiveCycles / ISR_BENCH_ITERATIONS));
+
+    vTaskDelete(NULL);
+}
+
+void TestISRBench() {
+    // average cost of one send and one receive made from an interrupt, which
+    // is roughly how long each keeps interrupts masked
+    InitializeQueue(8, sizeof(int));
+
+    xTaskCreate(ISRBenchTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestQueueSet
+// *****************************************************************************
+#define SET_QUEUES (3)
+#define SET_QUEUE_LENGTH (2)
+#define SET_ITEMS (5)
+
+#if USE_MY_QUEUE == 1
+    MyQueueHandle_t SetQueues[SET_QUEUES];
+    MySemaphoreHandle_t SetSemaphore;
+    MyQueueSetHandle_t QueueSet;
+#else
+    QueueHandle_t SetQueues[SET_QUEUES];
+    SemaphoreHandle_t SetSemaphore;
+    QueueSetHandle_t QueueSet;
+#endif
+
+static void SetProducerTaskFunc(void* Parameters) {
+    int Index = (int) Parameters;
+
+    for (int i = 0; i < SET_ITEMS; ++i) {
+        vTaskDelay(pdMS_TO_TICKS(7 * (Index + 1)));
+
+        int Item = Index * 100 + i;
+        #if USE_MY_QUEUE == 1
+            configASSERT(xMyQueueSendToBack(SetQueues[Index], &Item, portMAX_DELAY) == pdTRUE);
+        #else
+            configASSERT(xQueueSendToBack(SetQueues[Index], &Item, portMAX_DELAY) == pdTRUE);
+        #endif
+    }
+
+    // tell the gateway this producer is done
+    #if USE_MY_QUEUE == 1
+        configASSERT(xMySemaphoreGive(SetSemaphore, portMAX_DELAY) == pdTRUE);
+    #else
+        configASSERT(xSemaphoreGive(SetSemaphore) == pdTRUE);
+    #endif
+
+    vTaskDelete(NULL);
+}
+
+static void SetGatewayTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    int Done = 0;
+
+    while (Done < SET_QUEUES) {
+        // one blocking call no matter which member has something
+        #if USE_MY_QUEUE == 1
+            MyQueueSetMemberHandle_t Member = xMyQueueSelectFromSet(QueueSet, portMAX_DELAY);
+        #else
+            QueueSetMemberHandle_t Member = xQueueSelectFromSet(QueueSet, portMAX_DELAY);
+        #endif
+        configASSERT(Member);
+
+        if (Member == (void*) SetSemaphore) {
+            #if USE_MY_QUEUE == 1
+                configASSERT(xMySemaphoreTake(SetSemaphore, 0) == pdTRUE);
+            #else
+                configASSERT(xSemaphoreTake(SetSemaphore, 0) == pdTRUE);
+            #endif
+            Done++;
+            printf("Producer done\n");
+            continue;
+        }
+
+        for (int i = 0; i < SET_QUEUES; ++i) {
+            if (Member == (void*) SetQueues[i]) {
+                // the set said this queue has an item so do not wait
+                int Item;
+                #if USE_MY_QUEUE == 1
+                    configASSERT(xMyQueueReceive(SetQueues[i], &Item, 0) == pdTRUE);
+                #else
+                    configASSERT(xQueueReceive(SetQueues[i], &Item, 0) == pdTRUE);
+                #endif
+                printf("Received %d from queue %d\n", Item, i);
+            }
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
+void TestQueueSet() {
+    // gateway blocks on three queues and a semaphore at once, producers send
+    // at different rates so items arrive interleaved
+    // should see each queue's values in order and three producers finish
+    #if USE_MY_QUEUE == 1
+        // one entry for every item or unit any member can hold
+        QueueSet = pxMyQueueCreateSet(SET_QUEUES * SET_QUEUE_LENGTH + SET_QUEUES);
+        configASSERT(QueueSet);
+
+        for (int i = 0; i < SET_QUEUES; ++i) {
+            SetQueues[i] = pxMyQueueCreate(SET_QUEUE_LENGTH, sizeof(int));
+            configASSERT(SetQueues[i]);
+            configASSERT(xMyQueueAddToSet(SetQueues[i], QueueSet) == pdTRUE);
+        }
+
+        SetSemaphore = pxMySemaphoreCreate(SET_QUEUES, 0);
+        configASSERT(SetSemaphore);
+        configASSERT(xMyQueueAddSemaphoreToSet(SetSemaphore, QueueSet) == pdTRUE);
+    #else
+        QueueSet = xQueueCreateSet(SET_QUEUES * SET_QUEUE_LENGTH + SET_QUEUES);
+        configASSERT(QueueSet);
+
+        for (int i = 0; i < SET_QUEUES; ++i) {
+            SetQueues[i] = xQueueCreate(SET_QUEUE_LENGTH, sizeof(int));
+            configASSERT(SetQueues[i]);
+            configASSERT(xQueueAddToSet(SetQueues[i], QueueSet) == pdPASS);
+        }
+
+        SetSemaphore = xSemaphoreCreateCounting(SET_QUEUES, 0);
+        configASSERT(SetSemaphore);
+        configASSERT(xQueueAddToSet(SetSemaphore, QueueSet) == pdPASS);
+    #endif
+
+    // producers outrank the gateway so items sent in the same tick are
+    // queued in priority order before it runs
+    for (int i = 0; i < SET_QUEUES; ++i) {
+        xTaskCreate(SetProducerTaskFunc,
+                    NULL,
+                    STACK_SIZE,
+                    (void*) i,
+                    tskIDLE_PRIORITY + 2 + i,
+                    NULL);
+    }
+    xTaskCreate(SetGatewayTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestVariable
+// *****************************************************************************
+#define VARIABLE_BUFFER_SIZE (64)
+#define VARIABLE_MESSAGES (8)
+
+#if USE_MY_QUEUE == 1
+    MyQueueHandle_t VariableQueue;
+#else
+    MessageBufferHandle_t VariableQueue;
+#endif
+
+static const char* const VariableMessages[VARIABLE_MESSAGES] = {
+    "a",
+    "short",
+    "a somewhat longer message",
+    "mid length",
+    "the longest message of them all, it nearly fills the ring",
+    "xy",
+    "another fairly long one",
+    "end",
+};
+
+static void VariableProducerTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    for (int i = 0; i < VARIABLE_MESSAGES; ++i) {
+        // send without the terminator, the length travels with the message
+        size_t Length = strlen(VariableMessages[i]);
+        #if USE_MY_QUEUE == 1
+            configASSERT(xMyQueueSendMessage(VariableQueue, VariableMessages[i],
+                                             Length, portMAX_DELAY) == pdTRUE);
+        #else
+            configASSERT(xMessageBufferSend(VariableQueue, VariableMessages[i],
+                                            Length, portMAX_DELAY) == Length);
+        #endif
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void VariableConsumerTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    char Buffer[VARIABLE_BUFFER_SIZE];
+
+    for (int i = 0; i < VARIABLE_MESSAGES; ++i) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+
+        #if USE_MY_QUEUE == 1
+            size_t Length = xMyQueueReceiveMessage(VariableQueue, Buffer,
+                                                   sizeof(Buffer) - 1, portMAX_DELAY);
+        #else
+            size_t Length = xMessageBufferReceive(VariableQueue, Buffer,
+                                                  sizeof(Buffer) - 1, portMAX_DELAY);
+        #endif
+        configASSERT(Length > 0);
+
+        Buffer[Length] = '\0';
+        printf("Received %u bytes: %s\n", (unsigned) Length, Buffer);
+    }
+
+    vTaskDelete(NULL);
+}
+
+void TestVariable() {
+    // producer outruns a slow consumer so it blocks on a full ring and the
+    // messages wrap around the end of the buffer
+    // should see every message whole and in order
+    #if USE_MY_QUEUE == 1
+        VariableQueue = pxMyQueueCreateVariable(2 * VARIABLE_BUFFER_SIZE);
+    #else
+        VariableQueue = xMessageBufferCreate(2 * VARIABLE_BUFFER_SIZE);
+    #endif
+    configASSERT(VariableQueue);
+
+    xTaskCreate(VariableProducerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+    xTaskCreate(VariableConsumerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestZeroCopyShared
+// *****************************************************************************
+static void SharedReserveTaskFunc(void* Parameters) {
+    int Base = (int) Parameters;
+
+    for (int i = 0; i < 5;) {
+        #if USE_MY_QUEUE == 1
+            // only one slot can be reserved at a time, so back off while the
+            // other producer holds it
+            int* Slot = pvMyQueueReserve(MyQueue, portMAX_DELAY);
+            if (Slot == NULL) {
+                vTaskDelay(1);
+                continue;
+            }
+
+            // hold the slot long enough for the other producer to run
+            *Slot = Base + i;
+            vTaskDelay(pdMS_TO_TICKS(5));
+            vMyQueueCommit(MyQueue, Slot);
+        #else
+            int Item = Base + i;
+            vTaskDelay(pdMS_TO_TICKS(5));
+            configASSERT(QUEUE_SEND_BACK(&Item, portMAX_DELAY) == pdTRUE);
+        #endif
+        i++;
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void SharedPeekTaskFunc(void* Parameters) {
+    (void) Parameters;
+
+    // which producer gets in first depends on the queue, so only the total
+    // is printed
+    int Total = 0;
+    for (int i = 0; i < 10; ++i) {
+        #if USE_MY_QUEUE == 1
+            int* Slot = pvMyQueuePeekSlot(MyQueue, portMAX_DELAY);
+            configASSERT(Slot);
+            Total += *Slot;
+            vMyQueueRelease(MyQueue, Slot);
+        #else
+            int Item;
+            configASSERT(QUEUE_RECEIVE(&Item, portMAX_DELAY) == pdTRUE);
+            Total += Item;
+        #endif
+    }
+
+    printf("Received total %d\n", Total);
+
+    vTaskDelete(NULL);
+}
+
+void TestZeroCopyShared() {
+    // two producers reserve slots in the same queue
+    // should see a total of 0 + ... + 4 + 100 + ... + 104 = 520
+    InitializeQueue(3, sizeof(int));
+
+    xTaskCreate(SharedReserveTaskFunc,
+                NULL,
+                STACK_SIZE,
+                (void*) 0,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+    xTaskCreate(SharedReserveTaskFunc,
+                NULL,
+                STACK_SIZE,
+                (void*) 100,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+    xTaskCreate(SharedPeekTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
@@ -28,6 +28,10 @@
 #define GIVE_DIFF_PRIORITY (5)
 #define TAKE_FROM_ISR (6)
 #define GIVE_FROM_ISR (7)
+#define TAKE_N (8)
+#define MUTEX_INHERIT (9)
+#define TAKE_N_FROM_ISR (10)
+#define GIVE_UP_TO_FROM_ISR (11)
 
 // Set this to 1 to use MySemaphore, else use default
 #define USE_MY_SEM (0)
@@ -90,6 +94,10 @@ void TestGiveSamePriority();
 void TestGiveDiffPriority();
 void TestTakeFromISR();
 void TestGiveFromISR();
+void TestTakeN();
+void TestMutexInherit();
+void TestTakeNFromISR();
+void TestGiveUpToFromISR();
 
 // util functions
 extern void CallIRQN(IRQn_Type irqn, uint32_t Priority);
@@ -121,6 +129,18 @@ void main_my_sem(void) {
     #elif RUNNING_TEST == GIVE_FROM_ISR
         printf("Running give from ISR test\n");
         TestGiveFromISR();
+    #elif RUNNING_TEST == TAKE_N
+        printf("Running multi-unit take test\n");
+        TestTakeN();
+    #elif RUNNING_TEST == MUTEX_INHERIT
+        printf("Running mutex priority inheritance test\n");
+        TestMutexInherit();
+    #elif RUNNING_TEST == TAKE_N_FROM_ISR
+        printf("Running take from ISR behind a multi-unit taker test\n");
+        TestTakeNFromISR();
+    #elif RUNNING_TEST == GIVE_UP_TO_FROM_ISR
+        printf("Running partial give from ISR test\n");
+        TestGiveUpToFromISR();
     #else
         printf("Invalid RUNNING_TEST\n");
     #endif
@@ -330,8 +350,15 @@ void TestGiveDiffPriority() {
 // *****************************************************************************
 int TakeFromISRTestCalls = 0;
 
+void TakeNFromISRHandler();
+
 // handler for TAKE_FROM_ISR_IRQN
 void SemTakeFromISRHandler() {
+    if (RUNNING_TEST == TAKE_N_FROM_ISR) {
+        TakeNFromISRHandler();
+        return;
+    }
+
     printf("TakeFromISR\n");
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     BaseType_t taken = SEM_TAKE_ISR(&xHigherPriorityTaskWoken);
@@ -434,8 +461,15 @@ void TestTakeFromISR() {
 // ******************************************************************************
 int GiveFromISRTestCalls = 0;
 
+void GiveUpToFromISRHandler();
+
 // handler for GIVE_FROM_ISR_IRQN
 void SemGiveFromISRHandler() {
+    if (RUNNING_TEST == GIVE_UP_TO_FROM_ISR) {
+        GiveUpToFromISRHandler();
+        return;
+    }
+
     printf("GiveFromISR\n");
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     BaseType_t given = SEM_GIVE_ISR(&xHigherPriorityTaskWoken);
@@ -527,3 +561,336 @@ void TestGiveFromISR() {
 
     vTaskStartScheduler();
 }
+
+// *****************************************************************************
+// TestTakeN
+// *****************************************************************************
+#define TAKE_N_UNITS (3)
+
+static void TakeNGiverTaskFunc(void* pvParamaters) {
+    (void) pvParamaters;
+
+    // hand out one unit at a time
+    for (int i = 0; i < TAKE_N_UNITS * ITERATIONS; ++i) {
+        vTaskDelay(BLOCK_TICKS);
+        printf("Task 0 GIVE\n");
+        #if (USE_MY_SEM == 1)
+            configASSERT(xMySemaphoreGive(MySemaphore, 0) == pdTRUE);
+        #else
+            configASSERT(xSemaphoreGive(xSemaphore) == pdTRUE);
+        #endif
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void TakeNTakerTaskFunc(void* pvParamaters) {
+    (void) pvParamaters;
+
+    for (int i = 0; i < ITERATIONS; ++i) {
+        #if (USE_MY_SEM == 1)
+            configASSERT(xMySemaphoreTakeN(MySemaphore, TAKE_N_UNITS, portMAX_DELAY) == pdTRUE);
+        #else
+            // default semaphore can only take one unit at a time
+            for (int j = 0; j < TAKE_N_UNITS; ++j) {
+                configASSERT(xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE);
+            }
+        #endif
+        printf("Task 1 TAKE %d\n", TAKE_N_UNITS);
+    }
+
+    vTaskDelete(NULL);
+}
+
+void TestTakeN() {
+    // task 1 should only wake up once task 0 has given 3 units
+    #if (USE_MY_SEM == 1)
+        MySemaphore = pxMySemaphoreCreate(TAKE_N_UNITS, 0);
+        configASSERT(MySemaphore);
+    #else
+        xSemaphore = xSemaphoreCreateCounting(TAKE_N_UNITS, 0);
+        configASSERT(xSemaphore);
+    #endif
+
+    xTaskCreate(TakeNGiverTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+    xTaskCreate(TakeNTakerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestMutexInherit
+// *****************************************************************************
+#define MUTEX_LOW_PRIORITY (tskIDLE_PRIORITY + 1)
+#define MUTEX_HIGH_PRIORITY (tskIDLE_PRIORITY + 3)
+
+#if (USE_MY_SEM == 1)
+    #define MUTEX_TAKE(TICKS) xMySemaphoreTake(MySemaphore, (TICKS))
+    #define MUTEX_GIVE() xMySemaphoreGive(MySemaphore, 0)
+#else
+    #define MUTEX_TAKE(TICKS) xSemaphoreTake(xSemaphore, (TICKS))
+    #define MUTEX_GIVE() xSemaphoreGive(xSemaphore)
+#endif
+
+static void MutexHighTaskFunc(void* pvParamaters) {
+    TickType_t ticks = (TickType_t) pvParamaters;
+
+    // blocks behind the low priority holder
+    if (MUTEX_TAKE(ticks) == pdTRUE) {
+        printf("Task 1 TAKE\n");
+        configASSERT(MUTEX_GIVE() == pdTRUE);
+    } else {
+        printf("Task 1 TIMEOUT\n");
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void MutexLowTaskFunc(void* pvParamaters) {
+    (void) pvParamaters;
+
+    // holder is lent the waiter's priority until it gives
+    configASSERT(MUTEX_TAKE(0) == pdTRUE);
+    xTaskCreate(MutexHighTaskFunc,
+                NULL,
+                STACK_SIZE,
+                (void*) portMAX_DELAY,
+                MUTEX_HIGH_PRIORITY,
+                NULL);
+    printf("Task 0 priority %d\n", (int) uxTaskPriorityGet(NULL));
+    configASSERT(MUTEX_GIVE() == pdTRUE);
+    printf("Task 0 priority %d\n", (int) uxTaskPriorityGet(NULL));
+
+    // the lent priority is returned once the waiter times out
+    configASSERT(MUTEX_TAKE(0) == pdTRUE);
+    xTaskCreate(MutexHighTaskFunc,
+                NULL,
+                STACK_SIZE,
+                (void*) BLOCK_TICKS,
+                MUTEX_HIGH_PRIORITY,
+                NULL);
+    printf("Task 0 priority %d\n", (int) uxTaskPriorityGet(NULL));
+    TickType_t start = xTaskGetTickCount();
+    while (xTaskGetTickCount() - start < 2 * BLOCK_TICKS) {
+    }
+    printf("Task 0 priority %d\n", (int) uxTaskPriorityGet(NULL));
+    configASSERT(MUTEX_GIVE() == pdTRUE);
+
+    vTaskDelete(NULL);
+}
+
+void TestMutexInherit() {
+    #if (USE_MY_SEM == 1)
+        MySemaphore = pxMySemaphoreCreateMutex();
+        configASSERT(MySemaphore);
+    #else
+        xSemaphore = xSemaphoreCreateMutex();
+        configASSERT(xSemaphore);
+    #endif
+
+    xTaskCreate(MutexLowTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                MUTEX_LOW_PRIORITY,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestTakeNFromISR
+// *****************************************************************************
+// handler for TAKE_FROM_ISR_IRQN while TestTakeNFromISR runs
+void TakeNFromISRHandler() {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // a unit is free but the blocked task 1 is waiting for more than that, so
+    // the interrupt must not take it from under it, even though the task it
+    // interrupted has a higher priority than task 1
+    #if (USE_MY_SEM == 1)
+        BaseType_t taken = xMySemaphoreTakeNFromISR(MySemaphore, 1, &xHigherPriorityTaskWoken);
+    #else
+        BaseType_t taken = pdFALSE;
+    #endif
+    printf("TakeFromISR %s\n", (taken == pdTRUE) ? "taken" : "refused");
+    configASSERT(taken == pdFALSE);
+    configASSERT(xHigherPriorityTaskWoken == pdFALSE);
+}
+
+static void TakeNFromISRGiverTaskFunc(void* pvParamaters) {
+    (void) pvParamaters;
+
+    // let task 1 block first
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    // give one unit at a time and let an interrupt try to take it each time
+    for (int i = 0; i < TAKE_N_UNITS; ++i) {
+        printf("Task 0 GIVE\n");
+        #if (USE_MY_SEM == 1)
+            configASSERT(xMySemaphoreGive(MySemaphore, 0) == pdTRUE);
+        #endif
+        if (i < TAKE_N_UNITS - 1) {
+            CallIRQN(TAKE_FROM_ISR_IRQN, 1);
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void TakeNFromISRTakerTaskFunc(void* pvParamaters) {
+    (void) pvParamaters;
+
+    #if (USE_MY_SEM == 1)
+        configASSERT(xMySemaphoreTakeN(MySemaphore, TAKE_N_UNITS, portMAX_DELAY) == pdTRUE);
+    #endif
+    printf("Task 1 TAKE %d\n", TAKE_N_UNITS);
+
+    vTaskDelete(NULL);
+}
+
+void TestTakeNFromISR() {
+    // task 1 blocks for 3 units before the higher priority task 0 gives them
+    // one at a time, interrupts trying to take single units in between must
+    // not starve it whichever task they interrupt.
+    // Only makes sense for MySemaphore since default semaphore cannot take
+    // several units at once
+    configASSERT(USE_MY_SEM == 1);
+
+    #if (USE_MY_SEM == 1)
+        MySemaphore = pxMySemaphoreCreate(TAKE_N_UNITS, 0);
+        configASSERT(MySemaphore);
+    #endif
+
+    xTaskCreate(TakeNFromISRGiverTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+    xTaskCreate(TakeNFromISRTakerTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
+
+// *****************************************************************************
+// TestGiveUpToFromISR
+// *****************************************************************************
+#define GIVE_UP_TO_MAX_COUNT (3)
+#define GIVE_UP_TO_UNITS (5)
+
+int GiveUpToFromISRTestCalls = 0;
+
+// handler for GIVE_FROM_ISR_IRQN while TestGiveUpToFromISR runs
+void GiveUpToFromISRHandler() {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // always offers more units than the semaphore has room for
+    #if (USE_MY_SEM == 1)
+        UBaseType_t given = uxMySemaphoreGiveUpToFromISR(MySemaphore,
+                                                         GIVE_UP_TO_UNITS,
+                                                         &xHigherPriorityTaskWoken);
+    #else
+        UBaseType_t given = 0;
+    #endif
+    printf("GiveUpToFromISR gave %d\n", (int) given);
+
+    if (GiveUpToFromISRTestCalls == 0) {
+        // count was 1, so only 2 fit
+        configASSERT(given == 2);
+        configASSERT(xHigherPriorityTaskWoken == pdFALSE);
+    } else if (GiveUpToFromISRTestCalls == 1) {
+        // count was 3, so nothing fits
+        configASSERT(given == 0);
+        configASSERT(xHigherPriorityTaskWoken == pdFALSE);
+    } else if (GiveUpToFromISRTestCalls == 2) {
+        // count was 0 and the high priority task is waiting for all 3
+        configASSERT(given == GIVE_UP_TO_MAX_COUNT);
+        configASSERT(xHigherPriorityTaskWoken == pdTRUE);
+    }
+
+    ++GiveUpToFromISRTestCalls;
+}
+
+// indicates if low priority task should call GiveUpToFromISR
+int CallInterruptGiveUpToFromISR = 0;
+
+static void GiveUpToFromISRHighPriorityTaskFunc(void* pvParamaters) {
+    (void) pvParamaters;
+
+    // semaphore has initial count of 1 and max count of 3, the first give
+    // is clamped at the max count and the second gives nothing
+    CallIRQN(GIVE_FROM_ISR_IRQN, 1);
+    CallIRQN(GIVE_FROM_ISR_IRQN, 1);
+
+    #if (USE_MY_SEM == 1)
+        configASSERT(xMySemaphoreTakeN(MySemaphore, GIVE_UP_TO_MAX_COUNT, 0) == pdTRUE);
+    #endif
+    printf("TAKE %d\n", GIVE_UP_TO_MAX_COUNT);
+
+    // semaphore is now empty so wait for the interrupt to refill it
+    CallInterruptGiveUpToFromISR = 1;
+    printf("Waiting to TAKE %d\n", GIVE_UP_TO_MAX_COUNT);
+    #if (USE_MY_SEM == 1)
+        configASSERT(xMySemaphoreTakeN(MySemaphore, GIVE_UP_TO_MAX_COUNT, SEM_WAIT_TICKS) == pdTRUE);
+    #endif
+    printf("Done TAKE %d\n", GIVE_UP_TO_MAX_COUNT);
+
+    vTaskDelete(NULL);
+}
+
+static void GiveUpToFromISRLowPriorityTaskFunc(void* pvParamaters) {
+    (void) pvParamaters;
+
+    for (;;) {
+        if (CallInterruptGiveUpToFromISR) {
+            CallIRQN(GIVE_FROM_ISR_IRQN, 1);
+            vTaskDelete(NULL);
+        }
+    }
+}
+
+void TestGiveUpToFromISR() {
+    // Test the following
+    // 1) Units that do not fit are dropped and the count stops at max_count
+    // 2) The number of units actually given is returned
+    // 3) xHigherPriorityTaskWoken is set when the units wake a waiter
+    // Only makes sense for MySemaphore since default semaphore cannot give
+    // several units at once
+    configASSERT(USE_MY_SEM == 1);
+
+    #if (USE_MY_SEM == 1)
+        MySemaphore = pxMySemaphoreCreate(GIVE_UP_TO_MAX_COUNT, 1);
+        configASSERT(MySemaphore);
+    #endif
+
+    xTaskCreate(GiveUpToFromISRHighPriorityTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 2,
+                NULL);
+    xTaskCreate(GiveUpToFromISRLowPriorityTaskFunc,
+                NULL,
+                STACK_SIZE,
+                NULL,
+                tskIDLE_PRIORITY + 1,
+                NULL);
+
+    vTaskStartScheduler();
+}
@@ -0,0 +1,194 @@
+/*
+ * Per operation cost of copying items into and out of the kernel queue on the
+ * Posix simulator port.
+ *
+ * A single task sends an item to a queue and receives it straight back, so
+ * the queue never blocks and the time measured is the send and receive path
+ * itself. Word sized items are sent both through the generic API and through
+ * the typed functions from queueDEFINE_TYPED_QUEUE(). One CSV line is printed
+ * per case:
+ *
+ *   api,item_size,round_trips,ns_per_round_trip
+ *
+ * Build once with the default and once with -DQUEUE_INLINE_ITEM_COPY=1 to see
+ * what configQUEUE_INLINE_ITEM_COPY saves. The typed and generic cases of one
+ * build only differ in how the item reaches the queue, not in how it is
+ * copied.
+ *
+ * Usage: queue_copy_benchmark [round_trips_per_case]
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#define benchDEFAULT_ROUND_TRIPS    ( 2000000U )
+#define benchQUEUE_DEPTH            ( 4U )
+#define benchCONTROL_PRIORITY       ( tskIDLE_PRIORITY + 1 )
+#define benchSTACK_SIZE             ( configMINIMAL_STACK_SIZE * 2 )
+
+queueDEFINE_TYPED_QUEUE( WordQueue, uint32_t );
+queueDEFINE_TYPED_QUEUE( DoubleWordQueue, uint64_t );
+
+/* Not a word size, so always copied with memcpy() */
+typedef struct BenchTriple
+{
+    uint32_t ulValues[ 3 ];
+} BenchTriple_t;
+
+static unsigned long ulRoundTrips = benchDEFAULT_ROUND_TRIPS;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char * pcApi,
+                       size_t uxItemSize,
+                       uint64_t ullStart )
+{
+    uint64_t ullElapsed = prvNowNs() - ullStart;
+
+    printf( "%s,%lu,%lu,%.1f\n",
+            pcApi,
+            ( unsigned long ) uxItemSize,
+            ulRoundTrips,
+            ( double ) ullElapsed / ( double ) ulRoundTrips );
+    fflush( stdout );
+}
+/*-----------------------------------------------------------*/
+
+static void prvGenericCase( size_t uxItemSize )
+{
+    BenchTriple_t xItem = { { 0 } };
+    QueueHandle_t xQueue = xQueueCreate( benchQUEUE_DEPTH, ( UBaseType_t ) uxItemSize );
+
+    configASSERT( xQueue != NULL );
+    configASSERT( uxItemSize <= sizeof( xItem ) );
+
+    uint64_t ullStart = prvNowNs();
+
+    for( unsigned long i = 0; i < ulRoundTrips; i++ )
+    {
+        xItem.ulValues[ 0 ] = ( uint32_t ) i;
+        configASSERT( xQueueSend( xQueue, &xItem, 0 ) == pdTRUE );
+        configASSERT( xQueueReceive( xQueue, &xItem, 0 ) == pdTRUE );
+    }
+
+    prvReport( "generic", uxItemSize, ullStart );
+    vQueueDelete( xQueue );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTypedCases( void )
+{
+    QueueHandle_t xQueue;
+    uint32_t ulItem = 0;
+    uint64_t ullItem = 0;
+    uint64_t ullStart;
+
+    xQueue = xQueueCreateForType( benchQUEUE_DEPTH, uint32_t );
+    configASSERT( xQueue != NULL );
+    ullStart = prvNowNs();
+
+    for( unsigned long i = 0; i < ulRoundTrips; i++ )
+    {
+        configASSERT( xWordQueueSend( xQueue, ulItem + 1U, 0 ) == pdTRUE );
+        configASSERT( xWordQueueReceive( xQueue, &ulItem, 0 ) == pdTRUE );
+    }
+
+    prvReport( "typed", sizeof( ulItem ), ullStart );
+    vQueueDelete( xQueue );
+
+    xQueue = xQueueCreateForType( benchQUEUE_DEPTH, uint64_t );
+    configASSERT( xQueue != NULL );
+    ullStart = prvNowNs();
+
+    for( unsigned long i = 0; i < ulRoundTrips; i++ )
+    {
+        configASSERT( xDoubleWordQueueSend( xQueue, ullItem + 1U, 0 ) == pdTRUE );
+        configASSERT( xDoubleWordQueueReceive( xQueue, &ullItem, 0 ) == pdTRUE );
+    }
+
+    prvReport( "typed", sizeof( ullItem ), ullStart );
+    vQueueDelete( xQueue );
+
+    configASSERT( ulItem == ( uint32_t ) ulRoundTrips );
+    configASSERT( ullItem == ( uint64_t ) ulRoundTrips );
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    printf( "api,item_size,round_trips,ns_per_round_trip\n" );
+
+    prvGenericCase( sizeof( uint32_t ) );
+    prvGenericCase( sizeof( uint64_t ) );
+    prvGenericCase( sizeof( BenchTriple_t ) );
+    prvTypedCases();
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    if( argc > 1 )
+    {
+        ulRoundTrips = strtoul( argv[ 1 ], NULL, 0 );
+    }
+
+    if( ulRoundTrips == 0 )
+    {
+        fprintf( stderr, "round_trips_per_case must be at least 1\n" );
+        return 1;
+    }
+
+    xTaskCreate( prvControlTask, "Control", benchSTACK_SIZE, NULL, benchCONTROL_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationGetIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                    StackType_t ** ppxIdleTaskStackBuffer,
+                                    uint32_t * pulIdleTaskStackSize )
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
+                                     StackType_t ** ppxTimerTaskStackBuffer,
+                                     uint32_t * pulTimerTaskStackSize )
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
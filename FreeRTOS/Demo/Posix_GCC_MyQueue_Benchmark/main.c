@@ -0,0 +1,339 @@
+/*
+ * Throughput and latency benchmark for MyQueue and the kernel queue on the
+ * Posix simulator port.
+ *
+ * Every case moves the same number of items from a set of producer tasks to a
+ * set of consumer tasks through one queue. Producers stamp each item with the
+ * time it was sent and consumers record how long it took to arrive. One CSV
+ * line is printed per case:
+ *
+ *   queue,item_size,depth,producers,consumers,items,items_per_sec,p50_ns,p99_ns,p999_ns
+ *
+ * Usage: myqueue_benchmark [items_per_case]
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "my_queue.h"
+
+#define benchDEFAULT_ITEMS_PER_CASE    ( 8192U )
+#define benchMAX_ITEMS_PER_CASE        ( 1U << 20 )
+#define benchMAX_ITEM_SIZE             ( 256U )
+#define benchWORKER_PRIORITY           ( tskIDLE_PRIORITY + 1 )
+#define benchCONTROL_PRIORITY          ( tskIDLE_PRIORITY + 2 )
+#define benchSTACK_SIZE                ( configMINIMAL_STACK_SIZE * 2 )
+
+/* Items must be large enough to carry the send time stamp */
+static const size_t uxItemSizes[] = { sizeof( uint64_t ), 64, benchMAX_ITEM_SIZE };
+static const UBaseType_t uxDepths[] = { 1, 16, 128 };
+
+/* 1:1, N:1, 1:N and N:N */
+static const UBaseType_t uxTopologies[][ 2 ] =
+{
+    { 1, 1 },
+    { 4, 1 },
+    { 1, 4 },
+    { 4, 4 }
+};
+
+#define benchARRAY_SIZE( x )    ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* The two queue implementations behind one interface */
+typedef struct BenchQueueOps
+{
+    const char * pcName;
+    void * ( *pvCreate )( UBaseType_t uxDepth, size_t uxItemSize );
+    BaseType_t ( *xSend )( void * pvQueue, const void * pvItem );
+    BaseType_t ( *xReceive )( void * pvQueue, void * pvBuffer );
+    void ( *vDelete )( void * pvQueue );
+} BenchQueueOps_t;
+
+static void * prvMyQueueCreate( UBaseType_t uxDepth, size_t uxItemSize )
+{
+    return pxMyQueueCreate( uxDepth, ( UBaseType_t ) uxItemSize );
+}
+
+static BaseType_t prvMyQueueSend( void * pvQueue, const void * pvItem )
+{
+    return xMyQueueSendToBack( ( MyQueueHandle_t ) pvQueue, pvItem, portMAX_DELAY );
+}
+
+static BaseType_t prvMyQueueReceive( void * pvQueue, void * pvBuffer )
+{
+    return xMyQueueReceive( ( MyQueueHandle_t ) pvQueue, pvBuffer, portMAX_DELAY );
+}
+
+static void prvMyQueueDelete( void * pvQueue )
+{
+    vMyQueueDelete( ( MyQueueHandle_t ) pvQueue );
+}
+
+static void * prvKernelQueueCreate( UBaseType_t uxDepth, size_t uxItemSize )
+{
+    return xQueueCreate( uxDepth, ( UBaseType_t ) uxItemSize );
+}
+
+static BaseType_t prvKernelQueueSend( void * pvQueue, const void * pvItem )
+{
+    return xQueueSendToBack( ( QueueHandle_t ) pvQueue, pvItem, portMAX_DELAY );
+}
+
+static BaseType_t prvKernelQueueReceive( void * pvQueue, void * pvBuffer )
+{
+    return xQueueReceive( ( QueueHandle_t ) pvQueue, pvBuffer, portMAX_DELAY );
+}
+
+static void prvKernelQueueDelete( void * pvQueue )
+{
+    vQueueDelete( ( QueueHandle_t ) pvQueue );
+}
+
+static const BenchQueueOps_t xQueueOps[] =
+{
+    { "MyQueue", prvMyQueueCreate, prvMyQueueSend, prvMyQueueReceive, prvMyQueueDelete },
+    { "xQueue",  prvKernelQueueCreate, prvKernelQueueSend, prvKernelQueueReceive, prvKernelQueueDelete }
+};
+
+/*-----------------------------------------------------------*/
+
+/* State shared by the tasks of the case being run */
+typedef struct BenchCase
+{
+    const BenchQueueOps_t * pxOps;
+    void * pvQueue;
+    UBaseType_t uxItemsPerProducer;
+    UBaseType_t uxItemsPerConsumer;
+    /* Given once by every producer and consumer when it is done */
+    SemaphoreHandle_t xDone;
+} BenchCase_t;
+
+static BenchCase_t xCase;
+
+/* Send to receive latency of every item. Consumer n fills the slice starting
+ * at n * uxItemsPerConsumer so no locking is needed */
+static uint64_t ullLatencies[ benchMAX_ITEMS_PER_CASE ];
+
+static UBaseType_t uxItemsPerCase = benchDEFAULT_ITEMS_PER_CASE;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    uint8_t ucItem[ benchMAX_ITEM_SIZE ];
+
+    ( void ) pvParameters;
+    memset( ucItem, 0xA5, sizeof( ucItem ) );
+
+    for( UBaseType_t i = 0; i < xCase.uxItemsPerProducer; i++ )
+    {
+        uint64_t ullSent = prvNowNs();
+
+        memcpy( ucItem, &ullSent, sizeof( ullSent ) );
+        configASSERT( xCase.pxOps->xSend( xCase.pvQueue, ucItem ) == pdTRUE );
+    }
+
+    xSemaphoreGive( xCase.xDone );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    uint8_t ucItem[ benchMAX_ITEM_SIZE ];
+    uint64_t * pullLatencies = &( ullLatencies[ ( UBaseType_t ) pvParameters * xCase.uxItemsPerConsumer ] );
+
+    for( UBaseType_t i = 0; i < xCase.uxItemsPerConsumer; i++ )
+    {
+        uint64_t ullSent;
+
+        configASSERT( xCase.pxOps->xReceive( xCase.pvQueue, ucItem ) == pdTRUE );
+
+        memcpy( &ullSent, ucItem, sizeof( ullSent ) );
+        pullLatencies[ i ] = prvNowNs() - ullSent;
+    }
+
+    xSemaphoreGive( xCase.xDone );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareLatency( const void * pvA,
+                              const void * pvB )
+{
+    uint64_t ullA = *( const uint64_t * ) pvA;
+    uint64_t ullB = *( const uint64_t * ) pvB;
+
+    return ( ullA > ullB ) - ( ullA < ullB );
+}
+/*-----------------------------------------------------------*/
+
+/* Latency at the given fraction of the sorted samples, in per mille */
+static uint64_t prvPercentile( UBaseType_t uxPerMille )
+{
+    UBaseType_t uxIndex = ( uxItemsPerCase * uxPerMille ) / 1000;
+
+    if( uxIndex >= uxItemsPerCase )
+    {
+        uxIndex = uxItemsPerCase - 1;
+    }
+
+    return ullLatencies[ uxIndex ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunCase( const BenchQueueOps_t * pxOps,
+                        size_t uxItemSize,
+                        UBaseType_t uxDepth,
+                        UBaseType_t uxProducers,
+                        UBaseType_t uxConsumers )
+{
+    xCase.pxOps = pxOps;
+    xCase.pvQueue = pxOps->pvCreate( uxDepth, uxItemSize );
+    xCase.uxItemsPerProducer = uxItemsPerCase / uxProducers;
+    xCase.uxItemsPerConsumer = uxItemsPerCase / uxConsumers;
+    configASSERT( xCase.pvQueue != NULL );
+
+    uint64_t ullStart = prvNowNs();
+
+    /* Workers run below this task so none of them starts until all exist */
+    for( UBaseType_t i = 0; i < uxConsumers; i++ )
+    {
+        configASSERT( xTaskCreate( prvConsumerTask, "Cons", benchSTACK_SIZE, ( void * ) i,
+                                   benchWORKER_PRIORITY, NULL ) == pdPASS );
+    }
+
+    for( UBaseType_t i = 0; i < uxProducers; i++ )
+    {
+        configASSERT( xTaskCreate( prvProducerTask, "Prod", benchSTACK_SIZE, NULL,
+                                   benchWORKER_PRIORITY, NULL ) == pdPASS );
+    }
+
+    for( UBaseType_t i = 0; i < uxProducers + uxConsumers; i++ )
+    {
+        configASSERT( xSemaphoreTake( xCase.xDone, portMAX_DELAY ) == pdTRUE );
+    }
+
+    uint64_t ullElapsed = prvNowNs() - ullStart;
+
+    /* Let the idle task free the deleted workers before the next case */
+    vTaskDelay( 2 );
+    pxOps->vDelete( xCase.pvQueue );
+
+    qsort( ullLatencies, uxItemsPerCase, sizeof( ullLatencies[ 0 ] ), prvCompareLatency );
+
+    printf( "%s,%lu,%lu,%lu,%lu,%lu,%.0f,%llu,%llu,%llu\n",
+            pxOps->pcName,
+            ( unsigned long ) uxItemSize,
+            ( unsigned long ) uxDepth,
+            ( unsigned long ) uxProducers,
+            ( unsigned long ) uxConsumers,
+            ( unsigned long ) uxItemsPerCase,
+            ( double ) uxItemsPerCase * 1e9 / ( double ) ullElapsed,
+            ( unsigned long long ) prvPercentile( 500 ),
+            ( unsigned long long ) prvPercentile( 990 ),
+            ( unsigned long long ) prvPercentile( 999 ) );
+    fflush( stdout );
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    xCase.xDone = xSemaphoreCreateCounting( 8, 0 );
+    configASSERT( xCase.xDone != NULL );
+
+    printf( "queue,item_size,depth,producers,consumers,items,items_per_sec,p50_ns,p99_ns,p999_ns\n" );
+
+    for( size_t uxOps = 0; uxOps < benchARRAY_SIZE( xQueueOps ); uxOps++ )
+    {
+        for( size_t uxSize = 0; uxSize < benchARRAY_SIZE( uxItemSizes ); uxSize++ )
+        {
+            for( size_t uxDepth = 0; uxDepth < benchARRAY_SIZE( uxDepths ); uxDepth++ )
+            {
+                for( size_t uxTopology = 0; uxTopology < benchARRAY_SIZE( uxTopologies ); uxTopology++ )
+                {
+                    prvRunCase( &( xQueueOps[ uxOps ] ),
+                                uxItemSizes[ uxSize ],
+                                uxDepths[ uxDepth ],
+                                uxTopologies[ uxTopology ][ 0 ],
+                                uxTopologies[ uxTopology ][ 1 ] );
+                }
+            }
+        }
+    }
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    if( argc > 1 )
+    {
+        uxItemsPerCase = ( UBaseType_t ) strtoul( argv[ 1 ], NULL, 0 );
+    }
+
+    /* Every topology must split the items evenly */
+    uxItemsPerCase -= uxItemsPerCase % 4;
+
+    if( uxItemsPerCase == 0 || uxItemsPerCase > benchMAX_ITEMS_PER_CASE )
+    {
+        fprintf( stderr, "items_per_case must be between 4 and %u\n", benchMAX_ITEMS_PER_CASE );
+        return 1;
+    }
+
+    xTaskCreate( prvControlTask, "Control", benchSTACK_SIZE, NULL, benchCONTROL_PRIORITY, NULL );
+    vTaskStartScheduler();
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationGetIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                    StackType_t ** ppxIdleTaskStackBuffer,
+                                    uint32_t * pulIdleTaskStackSize )
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
+                                     StackType_t ** ppxTimerTaskStackBuffer,
+                                     uint32_t * pulTimerTaskStackSize )
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
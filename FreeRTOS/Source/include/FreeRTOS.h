@@ -1019,6 +1019,26 @@
     #define configUSE_QUEUE_SETS    0
 #endif
 
+#ifndef configUSE_QUEUE_ZERO_COPY
+    #define configUSE_QUEUE_ZERO_COPY    0
+#endif
+
+#ifndef configQUEUE_INLINE_ITEM_COPY
+    #define configQUEUE_INLINE_ITEM_COPY    0
+#endif
+
+#ifndef configUSE_MUTEX_FAST_PATH
+    #define configUSE_MUTEX_FAST_PATH    0
+#endif
+
+#ifndef configUSE_MUTEX_PRIORITY_CEILING
+    #define configUSE_MUTEX_PRIORITY_CEILING    0
+#endif
+
+#ifndef configUSE_READ_WRITE_LOCKS
+    #define configUSE_READ_WRITE_LOCKS    0
+#endif
+
 #ifndef portTASK_USES_FLOATING_POINT
     #define portTASK_USES_FLOATING_POINT()
 #endif
@@ -1149,6 +1169,22 @@
     #error configUSE_MUTEXES must be set to 1 to use recursive mutexes
 #endif
 
+#if ( ( configUSE_MUTEX_FAST_PATH == 1 ) && ( configUSE_MUTEXES != 1 ) )
+    #error configUSE_MUTEXES must be set to 1 to use the mutex fast path
+#endif
+
+#if ( ( configUSE_MUTEX_FAST_PATH == 1 ) && ( configNUMBER_OF_CORES > 1 ) )
+    #error configUSE_MUTEX_FAST_PATH relies on atomic.h, which only masks interrupts on the calling core, so cannot be used with configNUMBER_OF_CORES > 1
+#endif
+
+#if ( ( configUSE_MUTEX_PRIORITY_CEILING == 1 ) && ( configUSE_MUTEXES != 1 ) )
+    #error configUSE_MUTEXES must be set to 1 to use priority ceiling mutexes
+#endif
+
+#if ( ( configUSE_READ_WRITE_LOCKS == 1 ) && ( configUSE_MUTEXES != 1 ) )
+    #error configUSE_MUTEXES must be set to 1 to use read write locks
+#endif
+
 #if ( ( configRUN_MULTIPLE_PRIORITIES == 0 ) && ( configUSE_TASK_PREEMPTION_DISABLE != 0 ) )
     #error configRUN_MULTIPLE_PRIORITIES must be set to 1 to use task preemption disable
 #endif
@@ -1419,8 +1455,7 @@ typedef struct xSTATIC_TCB
     #if ( configUSE_CORE_AFFINITY == 1 ) && ( configNUMBER_OF_CORES > 1 )
         UBaseType_t uxDummy26;
     #endif
-    /* For state, event, semaphore waiting list item */
-    StaticListItem_t xDummy3[ 3 ];
+    StaticListItem_t xDummy3[ 2 ];
     UBaseType_t uxDummy5;
     void * pxDummy6;
     #if ( configNUMBER_OF_CORES > 1 )
@@ -1511,6 +1546,15 @@ typedef struct xSTATIC_QUEUE
         UBaseType_t uxDummy8;
         uint8_t ucDummy9;
     #endif
+
+    #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+        void * pvDummy10[ 2 ];
+        UBaseType_t uxDummy11[ 2 ];
+    #endif
+
+    #if ( configUSE_MUTEX_PRIORITY_CEILING == 1 )
+        UBaseType_t uxDummy12;
+    #endif
 } StaticQueue_t;
 typedef StaticQueue_t StaticSemaphore_t;
 
@@ -6,14 +6,111 @@
            "include my_queue.h"
 #endif
 
+#include "my_semaphore.h"
+
 // Opague struct definition
 typedef struct MyQueueDefinition MyQueue_t;
 typedef MyQueue_t* MyQueueHandle_t;
 
+/* Set to the cache line size, a power of two, to lay queues out for SMP.
+ * Producer and consumer state then sit on separate cache lines, and queues
+ * made by pxMyQueueCreate or pxMyQueueCreateSPSC give every item its own
+ * cache line aligned slot in a ring of a power of two slots. That can take
+ * several times the memory of the packed layout used when this is 0 */
+#ifndef configMYQUEUE_CACHE_LINE_SIZE
+    #define configMYQUEUE_CACHE_LINE_SIZE    0
+#endif
+
+/* Same size and alignment as MyQueue_t, for callers that want to provide the
+ * memory for a queue themselves. Its members must not be used */
+typedef struct MyStaticQueue
+{
+    void* pvDummy1[ 2 ];
+    StaticMySemaphore_t xDummy2[ 2 ];
+    UBaseType_t uxDummy3;
+    size_t xDummy4[ 2 ];
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+        size_t xDummy5;
+    #endif
+    BaseType_t xDummy6[ 2 ];
+    void* pvDummy7[ 3 ];
+    #if ( configMYQUEUE_STATS == 1 )
+        UBaseType_t uxDummy8[ 7 ];
+        TickType_t xDummy9[ 2 ];
+    #endif
+    uint8_t ucDummy10;
+    #if ( configNUMBER_OF_CORES > 1 )
+        struct
+        {
+            uint32_t ulDummy18;
+            UBaseType_t uxDummy19;
+        } xDummy17;
+    #endif
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+        uint8_t ucDummy11[ configMYQUEUE_CACHE_LINE_SIZE ];
+    #endif
+    void* pvDummy12[ 3 ];
+    UBaseType_t uxDummy13[ 2 ];
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+        uint8_t ucDummy14[ configMYQUEUE_CACHE_LINE_SIZE ];
+    #endif
+    void* pvDummy15[ 3 ];
+    UBaseType_t uxDummy16[ 2 ];
+} StaticMyQueue_t;
+
+#if ( configMYQUEUE_STATS == 1 )
+
+    /* Counters are totals since the queue was created and wrap silently */
+    typedef struct MyQueueStats
+    {
+        UBaseType_t uxSends;           /* Items sent */
+        UBaseType_t uxReceives;        /* Items received */
+        UBaseType_t uxSendTimeouts;    /* Sends that failed, waiting or not */
+        UBaseType_t uxReceiveTimeouts; /* Receives that failed, waiting or not */
+        UBaseType_t uxBlockedSends;    /* Sends that had to wait for space */
+        UBaseType_t uxBlockedReceives; /* Receives that had to wait for an item */
+        UBaseType_t uxHighWaterMark;   /* Most slots ever in use at once */
+        TickType_t xTotalBlockedTicks; /* Summed over all waits */
+        TickType_t xMaxBlockedTicks;   /* Longest single wait */
+    } MyQueueStats_t;
+
+#endif /* configMYQUEUE_STATS */
+
+/* The queue structure and its storage area are allocated as a single block */
 MyQueueHandle_t pxMyQueueCreate( UBaseType_t xQueueLength, UBaseType_t xItemSize );
 
+/* Builds the queue inside pxStaticQueue, using pucQueueStorage (at least
+ * xQueueLength * xItemSize bytes) for the items. Nothing is allocated from
+ * the heap and vMyQueueDelete does not free either buffer */
+MyQueueHandle_t xMyQueueCreateStatic( UBaseType_t xQueueLength,
+                                      UBaseType_t xItemSize,
+                                      uint8_t* pucQueueStorage,
+                                      StaticMyQueue_t* pxStaticQueue );
+
+/* Creates a queue for exactly one producer (task or ISR) and one consumer
+ * (task or ISR). Sends and receives that do not have to block run without
+ * any critical section; the kernel is only entered to block or to wake the
+ * other side. Using more than one producer or consumer corrupts the queue. */
+MyQueueHandle_t pxMyQueueCreateSPSC( UBaseType_t xQueueLength, UBaseType_t xItemSize );
+
+/* Creates a queue of variable length messages kept in a ring of
+ * xBufferSizeBytes bytes. Each message takes its length rounded up to a
+ * multiple of sizeof( size_t ), plus a sizeof( size_t ) header. Only the
+ * message functions below can be used on it (and sets). */
+MyQueueHandle_t pxMyQueueCreateVariable( size_t xBufferSizeBytes );
+
 void vMyQueueDelete( MyQueueHandle_t pxMyQueue );
 
+#if ( configMYQUEUE_STATS == 1 )
+
+    /* Copies the counters into *pxStats. Only masks interrupts for the copy,
+     * so it is safe to call while the scheduler is running. A batch counts
+     * once as a timeout or a wait but adds every item it moves */
+    void vMyQueueGetStats( MyQueueHandle_t pxMyQueue,
+                           MyQueueStats_t* pxStats );
+
+#endif /* configMYQUEUE_STATS */
+
 BaseType_t xMyQueueSendToBack( MyQueueHandle_t pxMyQueue,
                                const void* pvItemToQueue,
                                TickType_t xTicksToWait );
@@ -30,4 +127,135 @@ BaseType_t xMyQueueReceiveFromISR( MyQueueHandle_t pxMyQueue,
                                    void* pvBuffer,
                                    BaseType_t* pxHigherPriorityTaskWoken );
 
+/* Batched variants move up to xItemCount contiguous items in one call and
+ * return how many were moved. With xWaitForAll set to pdFALSE they return as
+ * soon as at least one item has been moved. With xWaitForAll set to pdTRUE
+ * they move exactly xItemCount items, or none if xTicksToWait expires first.
+ * The FromISR variants never wait and move as many items as they can. */
+size_t xMyQueueSendToBackBatch( MyQueueHandle_t pxMyQueue,
+                                const void* pvItemsToQueue,
+                                size_t xItemCount,
+                                BaseType_t xWaitForAll,
+                                TickType_t xTicksToWait );
+
+size_t xMyQueueReceiveBatch( MyQueueHandle_t pxMyQueue,
+                             void* pvBuffer,
+                             size_t xItemCount,
+                             BaseType_t xWaitForAll,
+                             TickType_t xTicksToWait );
+
+size_t xMyQueueSendToBackBatchFromISR( MyQueueHandle_t pxMyQueue,
+                                       const void* pvItemsToQueue,
+                                       size_t xItemCount,
+                                       BaseType_t* pxHigherPriorityTaskWoken );
+
+size_t xMyQueueReceiveBatchFromISR( MyQueueHandle_t pxMyQueue,
+                                    void* pvBuffer,
+                                    size_t xItemCount,
+                                    BaseType_t* pxHigherPriorityTaskWoken );
+
+/* Zero-copy variants. pvMyQueueReserve claims the next free slot and returns a
+ * pointer to it, waiting up to xTicksToWait like xMyQueueSendToBack, or NULL
+ * if the queue stayed full. The item is built in place and becomes visible to
+ * receivers once vMyQueueCommit is called. pvMyQueuePeekSlot and
+ * vMyQueueRelease do the same for the oldest item on the receiving side.
+ * Only one slot can be reserved and one peeked at a time per queue. While
+ * another task holds it, pvMyQueueReserve (pvMyQueuePeekSlot) returns NULL
+ * without waiting, so callers sharing a queue must be ready to retry. Items
+ * other tasks send (receive) meanwhile are held back until the outstanding
+ * slot is committed (released), so FIFO order is kept. */
+void* pvMyQueueReserve( MyQueueHandle_t pxMyQueue, TickType_t xTicksToWait );
+
+void vMyQueueCommit( MyQueueHandle_t pxMyQueue, void* pvSlot );
+
+void* pvMyQueuePeekSlot( MyQueueHandle_t pxMyQueue, TickType_t xTicksToWait );
+
+void vMyQueueRelease( MyQueueHandle_t pxMyQueue, void* pvSlot );
+
+/* Message variants for queues made by pxMyQueueCreateVariable. A message is
+ * stored in one contiguous piece and xLength must be greater than 0.
+ * xMyQueueSendMessage waits up to xTicksToWait for enough room and returns
+ * pdTRUE or errQUEUE_FULL. xMyQueueReceiveMessage returns the length of the
+ * message copied into pvBuffer, or 0 if none arrived in time or the oldest
+ * one is longer than xBufferLength (it is then left in the queue). Several
+ * tasks may send and receive at once, as with xMyQueueSendToBack. */
+BaseType_t xMyQueueSendMessage( MyQueueHandle_t pxMyQueue,
+                                const void* pvMessage,
+                                size_t xLength,
+                                TickType_t xTicksToWait );
+
+size_t xMyQueueReceiveMessage( MyQueueHandle_t pxMyQueue,
+                               void* pvBuffer,
+                               size_t xBufferLength,
+                               TickType_t xTicksToWait );
+
+BaseType_t xMyQueueSendMessageFromISR( MyQueueHandle_t pxMyQueue,
+                                       const void* pvMessage,
+                                       size_t xLength,
+                                       BaseType_t* pxHigherPriorityTaskWoken );
+
+size_t xMyQueueReceiveMessageFromISR( MyQueueHandle_t pxMyQueue,
+                                      void* pvBuffer,
+                                      size_t xBufferLength,
+                                      BaseType_t* pxHigherPriorityTaskWoken );
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+    typedef MyQueue_t* MyQueueSetHandle_t;
+
+    /* Handle of a set member, either a MyQueueHandle_t or a MySemaphoreHandle_t */
+    typedef void* MyQueueSetMemberHandle_t;
+
+    /* A set lets one task block on several MyQueues and MySemaphores at once.
+     * Every item sent to a member queue and every unit given to a member
+     * semaphore adds the member's handle to the set, so uxEventQueueLength must
+     * be at least the sum of the members' lengths (maximum counts). Delete a set
+     * with vMyQueueDelete once it has no members.
+     *
+     * Members must be empty when they are added or removed, and SPSC queues and
+     * mutexes cannot be members. xMyQueueSelectFromSet returns the handle of the
+     * member that became ready first, or NULL if xTicksToWait expires. Each
+     * handle returned allows exactly one receive (take) from that member with a
+     * zero timeout. A member must not be read in any other way while it is in a
+     * set, or the set goes out of step with it. */
+    MyQueueSetHandle_t pxMyQueueCreateSet( UBaseType_t uxEventQueueLength );
+
+    BaseType_t xMyQueueAddToSet( MyQueueHandle_t pxMyQueue,
+                                 MyQueueSetHandle_t pxQueueSet );
+
+    BaseType_t xMyQueueRemoveFromSet( MyQueueHandle_t pxMyQueue,
+                                      MyQueueSetHandle_t pxQueueSet );
+
+    BaseType_t xMyQueueAddSemaphoreToSet( MySemaphoreHandle_t pxMySemaphore,
+                                          MyQueueSetHandle_t pxQueueSet );
+
+    BaseType_t xMyQueueRemoveSemaphoreFromSet( MySemaphoreHandle_t pxMySemaphore,
+                                               MyQueueSetHandle_t pxQueueSet );
+
+    MyQueueSetMemberHandle_t xMyQueueSelectFromSet( MyQueueSetHandle_t pxQueueSet,
+                                                    TickType_t xTicksToWait );
+
+    MyQueueSetMemberHandle_t xMyQueueSelectFromSetFromISR( MyQueueSetHandle_t pxQueueSet );
+
+#endif /* configUSE_QUEUE_SETS */
+
+/* MUST NOT BE USED FROM APPLICATION CODE. Sends without blocking and with
+ * interrupts already masked, so MySemaphore can report to a set from inside
+ * its own critical section. Same calling rules as the FromCritical functions
+ * in my_semaphore.h */
+BaseType_t xMyQueueSendToBackFromCritical( MyQueueHandle_t pxMyQueue,
+                                           const void* pvItemToQueue,
+                                           BaseType_t* pxHigherPriorityTaskWoken );
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+    /* MUST NOT BE USED FROM APPLICATION CODE. As above, for a member of
+     * pxQueueSet reporting to it. On SMP the member's lock is held and this
+     * takes the set's lock too, so locks are always taken member first */
+    BaseType_t xMyQueueSendToSetFromCritical( MyQueueSetHandle_t pxQueueSet,
+                                              const void* pvItemToQueue,
+                                              BaseType_t* pxHigherPriorityTaskWoken );
+
+#endif /* configUSE_QUEUE_SETS */
+
 #endif // MYQUEUE_H
@@ -5,28 +5,303 @@
      #error "include FreeRTOS.h" must appear in source files before "include queue.h"
  #endif
 
+#include "task.h"
+
+/* Notification index a task blocked in MySemaphore or MyQueue waits on. Keeping
+ * it apart from the index the application uses means only the semaphore
+ * itself can wake the task. Defaults to the last index, so
+ * configTASK_NOTIFICATION_ARRAY_ENTRIES must be at least 2 */
+#ifndef configMYSEMAPHORE_NOTIFICATION_INDEX
+    #define configMYSEMAPHORE_NOTIFICATION_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+/* Index 0 is the one xTaskNotify and the other non-indexed calls use, so an
+ * application notification would cut a wait short and eat the wake that ends
+ * it. Set to 1 only if no task that uses MySemaphore or MyQueue is ever sent
+ * one */
+#ifndef configMYSEMAPHORE_SHARE_NOTIFICATION_INDEX_0
+    #define configMYSEMAPHORE_SHARE_NOTIFICATION_INDEX_0    0
+#endif
+
+#if ( configMYSEMAPHORE_NOTIFICATION_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES )
+    #error configMYSEMAPHORE_NOTIFICATION_INDEX must be less than configTASK_NOTIFICATION_ARRAY_ENTRIES
+#endif
+
+#if ( ( configMYSEMAPHORE_NOTIFICATION_INDEX == 0 ) && ( configMYSEMAPHORE_SHARE_NOTIFICATION_INDEX_0 == 0 ) )
+    #error configMYSEMAPHORE_NOTIFICATION_INDEX is 0, which the application shares. Set configTASK_NOTIFICATION_ARRAY_ENTRIES to 2 or more, or set configMYSEMAPHORE_SHARE_NOTIFICATION_INDEX_0 to 1
+#endif
+
+/* Set to 1 to keep per-instance counters in every MySemaphore and MyQueue,
+ * read with vMySemaphoreGetStats and vMyQueueGetStats */
+#ifndef configMYQUEUE_STATS
+    #define configMYQUEUE_STATS    0
+#endif
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+    /* Takes (releases) the spinlock word *pulLock. The defaults use the GCC
+     * atomic builtins. Ports whose cores have no atomic read-modify-write, such
+     * as the RP2040, define both in FreeRTOSConfig.h */
+    #ifndef configMYSEMAPHORE_SPIN_LOCK
+        #define configMYSEMAPHORE_SPIN_LOCK( pulLock )                                  \
+    do {                                                                                \
+        while( __atomic_exchange_n( ( pulLock ), 1U, __ATOMIC_ACQUIRE ) != 0U )         \
+        {                                                                               \
+        }                                                                               \
+    } while( 0 )
+    #endif
+
+    #ifndef configMYSEMAPHORE_SPIN_UNLOCK
+        #define configMYSEMAPHORE_SPIN_UNLOCK( pulLock )    __atomic_store_n( ( pulLock ), 0U, __ATOMIC_RELEASE )
+    #endif
+
+    /* Guards one MySemaphore, or one MyQueue together with its semaphores, so
+     * that cores working on different objects never wait for each other. The
+     * interrupt mask saved on entry is kept in the lock as only its holder
+     * uses it */
+    typedef struct MySemaphoreLock
+    {
+        volatile uint32_t ulLocked;
+        UBaseType_t uxSavedInterruptStatus;
+    } MySemaphoreLock_t;
+
+#endif /* configNUMBER_OF_CORES */
+
 typedef struct MySemaphoreDefinition MySemaphore_t;
 typedef MySemaphore_t* MySemaphoreHandle_t;
 
+#if ( configMYQUEUE_STATS == 1 )
+
+    /* Counters are totals since the semaphore was created and wrap silently */
+    typedef struct MySemaphoreStats
+    {
+        UBaseType_t uxTakes;           /* Units taken */
+        UBaseType_t uxGives;           /* Units given */
+        UBaseType_t uxTakeTimeouts;    /* Takes that failed, waiting or not */
+        UBaseType_t uxGiveTimeouts;    /* Gives that failed, waiting or not */
+        UBaseType_t uxBlockedTakes;    /* Takes that had to wait */
+        UBaseType_t uxBlockedGives;    /* Gives that had to wait */
+        UBaseType_t uxContended;       /* Held back only by a higher priority waiter */
+        TickType_t xTotalBlockedTicks; /* Summed over all waits */
+        TickType_t xMaxBlockedTicks;   /* Longest single wait */
+    } MySemaphoreStats_t;
+
+#endif /* configMYQUEUE_STATS */
+
+/* Same size and alignment as MySemaphore_t, for callers that want to provide
+ * the memory for a semaphore themselves. Its members must not be used */
+typedef struct MyStaticSemaphore
+{
+    UBaseType_t uxDummy1[ 2 ];
+    struct
+    {
+        uint32_t ulDummy4;
+        void* pvDummy5[ configMAX_PRIORITIES ];
+    } xDummy2[ 2 ];
+    void* pvDummy6;
+    #if ( configUSE_QUEUE_SETS == 1 )
+        void* pvDummy7[ 2 ];
+    #endif
+    #if ( configMYQUEUE_STATS == 1 )
+        UBaseType_t uxDummy8[ 7 ];
+        TickType_t xDummy9[ 2 ];
+    #endif
+    uint8_t ucDummy3[ 2 ];
+    #if ( configNUMBER_OF_CORES > 1 )
+        struct
+        {
+            uint32_t ulDummy11;
+            UBaseType_t uxDummy12;
+        } xDummy10;
+        void* pvDummy13;
+    #endif
+} StaticMySemaphore_t;
+
 MySemaphoreHandle_t pxMySemaphoreCreate( const UBaseType_t uxMaxCount,
                                          const UBaseType_t uxInitialCount );
 
+/* Builds the semaphore inside pxSemaphoreBuffer instead of allocating it.
+ * vMySemaphoreDelete does not free a semaphore created this way */
+MySemaphoreHandle_t pxMySemaphoreCreateStatic( const UBaseType_t uxMaxCount,
+                                               const UBaseType_t uxInitialCount,
+                                               StaticMySemaphore_t* pxSemaphoreBuffer );
+
+/* A binary semaphore that starts available and records which task holds it.
+ * While a task waits for it the holder runs at the waiting task's priority
+ * if that is higher. Only the holder may give it back, one unit at a time,
+ * and it must not be used from an ISR. Needs configUSE_MUTEXES set to 1 */
+MySemaphoreHandle_t pxMySemaphoreCreateMutex( void );
+
+MySemaphoreHandle_t pxMySemaphoreCreateMutexStatic( StaticMySemaphore_t* pxSemaphoreBuffer );
+
+/* Task holding a semaphore created as a mutex, or NULL if it is free */
+TaskHandle_t xMySemaphoreGetMutexHolder( MySemaphoreHandle_t pxMySemaphore );
+
 void vMySemaphoreDelete( MySemaphoreHandle_t pxMySemaphore );
 
+#if ( configMYQUEUE_STATS == 1 )
+
+    /* Copies the counters into *pxStats. Only masks interrupts for the copy,
+     * so it is safe to call while the scheduler is running */
+    void vMySemaphoreGetStats( MySemaphoreHandle_t pxMySemaphore,
+                               MySemaphoreStats_t* pxStats );
+
+#endif /* configMYQUEUE_STATS */
+
 BaseType_t xMySemaphoreTake( MySemaphoreHandle_t pxMySemaphore,
                              TickType_t xTicksToWait );
 
 BaseType_t xMySemaphoreGive( MySemaphoreHandle_t pxMySemaphore,
                              TickType_t xTicksToWait );
 
+/* Take (give) uxUnits at once, or nothing if xTicksToWait expires first. Waiters
+ * are served in priority order, each as soon as its whole request fits, and
+ * never hold part of a request while waiting for the rest */
+BaseType_t xMySemaphoreTakeN( MySemaphoreHandle_t pxMySemaphore,
+                              UBaseType_t uxUnits,
+                              TickType_t xTicksToWait );
+
+BaseType_t xMySemaphoreGiveN( MySemaphoreHandle_t pxMySemaphore,
+                              UBaseType_t uxUnits,
+                              TickType_t xTicksToWait );
+
+/* Same as above but wait against a deadline the caller started with
+ * vTaskSetTimeOutState. *pxTicksToWait is updated to the time left, so
+ * several waits that make up one operation can share a single deadline */
+BaseType_t xMySemaphoreTakeWithTimeOut( MySemaphoreHandle_t pxMySemaphore,
+                                        TimeOut_t* const pxTimeOut,
+                                        TickType_t* const pxTicksToWait );
+
+BaseType_t xMySemaphoreGiveWithTimeOut( MySemaphoreHandle_t pxMySemaphore,
+                                        TimeOut_t* const pxTimeOut,
+                                        TickType_t* const pxTicksToWait );
+
+BaseType_t xMySemaphoreTakeNWithTimeOut( MySemaphoreHandle_t pxMySemaphore,
+                                         UBaseType_t uxUnits,
+                                         TimeOut_t* const pxTimeOut,
+                                         TickType_t* const pxTicksToWait );
+
+BaseType_t xMySemaphoreGiveNWithTimeOut( MySemaphoreHandle_t pxMySemaphore,
+                                         UBaseType_t uxUnits,
+                                         TimeOut_t* const pxTimeOut,
+                                         TickType_t* const pxTicksToWait );
+
+/* An ISR has no priority to weigh against the waiting tasks, so the FromISR
+ * takes fail while any task is waiting to take, even if enough units are
+ * free. Tasks only go ahead of waiters of lower priority */
 BaseType_t xMySemaphoreTakeFromISR( MySemaphoreHandle_t pxMySemaphore,
                                     BaseType_t* pxHigherPriorityTaskWoken );
 
 BaseType_t xMySemaphoreGiveFromISR( MySemaphoreHandle_t pxMySemaphore,
                                     BaseType_t* pxHigherPriorityTaskWoken );
 
+BaseType_t xMySemaphoreTakeNFromISR( MySemaphoreHandle_t pxMySemaphore,
+                                     UBaseType_t uxUnits,
+                                     BaseType_t* pxHigherPriorityTaskWoken );
+
+/* An ISR that produces several units in one go, for example while draining
+ * a hardware FIFO, should count them and give them in one call rather than
+ * one at a time. The count then changes once and every waiter that now fits
+ * is woken in a single pass under one critical section, with
+ * *pxHigherPriorityTaskWoken asking for at most one switch on exit */
+BaseType_t xMySemaphoreGiveNFromISR( MySemaphoreHandle_t pxMySemaphore,
+                                     UBaseType_t uxUnits,
+                                     BaseType_t* pxHigherPriorityTaskWoken );
+
+/* Same as xMySemaphoreGiveNFromISR but gives as many of uxUnits as there is
+ * room for instead of all or nothing, and returns how many it gave */
+UBaseType_t uxMySemaphoreGiveUpToFromISR( MySemaphoreHandle_t pxMySemaphore,
+                                          UBaseType_t uxUnits,
+                                          BaseType_t* pxHigherPriorityTaskWoken );
+
+/* Whether one unit could be taken (given) right now. Only a hint, as a
+ * nested interrupt or another core may change the count before the caller
+ * acts on it. Use the FromISR take and give, which check and move the units
+ * under one lock, to actually move them */
 BaseType_t xMySemaphoreTakeAvailableFromISR( MySemaphoreHandle_t pxMySemaphore );
 
 BaseType_t xMySemaphoreGiveAvailableFromISR( MySemaphoreHandle_t pxMySemaphore );
 
+/*
+ * THESE FUNCTIONS MUST NOT BE USED FROM APPLICATION CODE. They let MyQueue
+ * combine several semaphore operations with its own buffer update inside a
+ * single critical section. The N variants move all of uxUnits or nothing. The
+ * UpTo variants move as many of uxUnits as the count allows and return how
+ * many they moved. As they may be called from an ISR, the takes move nothing
+ * while any task is waiting to take, whatever its priority, the same as the
+ * FromISR takes. A waiter for more units than are left over is then not
+ * starved by smaller takes. MyQueue calls that may block fall back to
+ * xMySemaphoreTakeN, which only gives way to waiters of at least the calling
+ * task's priority. The gives do not give way to waiting givers.
+ *
+ * They must be called with interrupts already masked, either from inside
+ * taskENTER_CRITICAL() or taskENTER_CRITICAL_FROM_ISR(), and never block. With
+ * configNUMBER_OF_CORES > 1 the caller must hold the semaphore's lock instead,
+ * see vMySemaphoreLock. A waiter handed a unit is woken with the ISR safe
+ * notification, so *pxHigherPriorityTaskWoken is set to pdTRUE (and never
+ * cleared) if the caller should yield once it leaves the critical section.
+ */
+BaseType_t xMySemaphoreTakeFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                         BaseType_t* pxHigherPriorityTaskWoken );
+
+BaseType_t xMySemaphoreGiveFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                         BaseType_t* pxHigherPriorityTaskWoken );
+
+BaseType_t xMySemaphoreTakeNFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                          UBaseType_t uxUnits,
+                                          BaseType_t* pxHigherPriorityTaskWoken );
+
+BaseType_t xMySemaphoreGiveNFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                          UBaseType_t uxUnits,
+                                          BaseType_t* pxHigherPriorityTaskWoken );
+
+UBaseType_t uxMySemaphoreTakeUpToFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                               UBaseType_t uxUnits,
+                                               BaseType_t* pxHigherPriorityTaskWoken );
+
+UBaseType_t uxMySemaphoreGiveUpToFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                               UBaseType_t uxUnits,
+                                               BaseType_t* pxHigherPriorityTaskWoken );
+
+/* Task the next give will hand its unit to, or NULL if no task is waiting to
+ * take. Same calling rules as the functions above */
+TaskHandle_t xMySemaphoreGetNextTakerFromCritical( MySemaphoreHandle_t pxMySemaphore );
+
+/* Units currently available. Same calling rules as the functions above */
+UBaseType_t uxMySemaphoreGetCountFromCritical( MySemaphoreHandle_t pxMySemaphore );
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+    /* Mask interrupts on the calling core and spin until pxLock is ours, from
+     * a task or an ISR. Locks may nest as long as every core takes them in the
+     * same order: a MyQueue's before its set's */
+    void vMySemaphoreLock( MySemaphoreLock_t* pxLock );
+
+    void vMySemaphoreUnlock( MySemaphoreLock_t* pxLock );
+
+    /* Guard pxMySemaphore with pxLock instead of its own lock, so MyQueue can
+     * cover both of its semaphores and its buffer with one lock. Must be
+     * called before the semaphore is used */
+    void vMySemaphoreShareLock( MySemaphoreHandle_t pxMySemaphore,
+                                MySemaphoreLock_t* pxLock );
+
+#endif /* configNUMBER_OF_CORES */
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+    struct MyQueueDefinition;
+
+    /* Used by the MyQueueSet functions in my_queue.h. Once linked, every unit
+     * given to pxMySemaphore sends pvSetMember to pxQueueSet. Linking fails if
+     * the semaphore is already in a set or has units available, unlinking fails
+     * if it is not in pxQueueSet or has units available */
+    BaseType_t xMySemaphoreLinkToSet( MySemaphoreHandle_t pxMySemaphore,
+                                      struct MyQueueDefinition* pxQueueSet,
+                                      void* pvSetMember );
+
+    BaseType_t xMySemaphoreUnlinkFromSet( MySemaphoreHandle_t pxMySemaphore,
+                                          struct MyQueueDefinition* pxQueueSet );
+
+#endif /* configUSE_QUEUE_SETS */
+
 #endif // MYSEMAPHORE_H
@@ -76,6 +76,7 @@ typedef struct QueueDefinition   * QueueSetMemberHandle_t;
 #define queueQUEUE_TYPE_COUNTING_SEMAPHORE    ( ( uint8_t ) 2U )
 #define queueQUEUE_TYPE_BINARY_SEMAPHORE      ( ( uint8_t ) 3U )
 #define queueQUEUE_TYPE_RECURSIVE_MUTEX       ( ( uint8_t ) 4U )
+#define queueQUEUE_TYPE_READ_WRITE_LOCK       ( ( uint8_t ) 5U )
 
 /**
  * queue. h
@@ -914,6 +915,333 @@ BaseType_t xQueueReceive( QueueHandle_t xQueue,
                           void * const pvBuffer,
                           TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * @code{c}
+ * size_t xQueueSendMultiple(
+ *                            QueueHandle_t xQueue,
+ *                            const void * const pvItemsToQueue,
+ *                            const size_t xItemCount,
+ *                            TickType_t xTicksToWait
+ *                          );
+ * @endcode
+ *
+ * Post up to xItemCount items to the back of a queue in a single critical
+ * section.  The items are copied from a contiguous array, using at most two
+ * copies however many items are sent, so this is cheaper than calling
+ * xQueueSend() once per item when producing data in bursts.
+ *
+ * As many items as there is space for are sent.  If the queue is full the
+ * calling task blocks for up to xTicksToWait ticks until there is space for at
+ * least one item, so a return value less than xItemCount is not an error - the
+ * caller should resend the remaining items.  One task waiting to receive from
+ * the queue is unblocked for each item sent.
+ *
+ * This function must not be used on a semaphore or mutex, nor from an
+ * interrupt service routine.  See xQueueSendMultipleFromISR() for an
+ * alternative which may be used in an ISR.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItemsToQueue A pointer to an array of xItemCount items.  Each item
+ * is the size defined when the queue was created.
+ *
+ * @param xItemCount The number of items in pvItemsToQueue.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue, should it already
+ * be full.  The call will return immediately if this is set to 0 and the
+ * queue is full.
+ *
+ * @return The number of items posted, from 0 to xItemCount.
+ *
+ * Example usage:
+ * @code{c}
+ * void vAProducerTask( void *pvParameters )
+ * {
+ * uint16_t usSamples[ 16 ];
+ * size_t xSent, xTotal;
+ *
+ *  // Fill usSamples, then send them all, blocking while the queue is full.
+ *  for( xTotal = 0; xTotal < 16; xTotal += xSent )
+ *  {
+ *      xSent = xQueueSendMultiple( xQueue, &( usSamples[ xTotal ] ), 16 - xTotal, portMAX_DELAY );
+ *  }
+ * }
+ * @endcode
+ * \defgroup xQueueSendMultiple xQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+size_t xQueueSendMultiple( QueueHandle_t xQueue,
+                           const void * const pvItemsToQueue,
+                           const size_t xItemCount,
+                           TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * size_t xQueueSendMultipleFromISR(
+ *                                   QueueHandle_t xQueue,
+ *                                   const void * const pvItemsToQueue,
+ *                                   const size_t xItemCount,
+ *                                   BaseType_t *pxHigherPriorityTaskWoken
+ *                                 );
+ * @endcode
+ *
+ * A version of xQueueSendMultiple() that can be called from an interrupt
+ * service routine.  As many items as there is space for are posted and the
+ * function never blocks.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItemsToQueue A pointer to an array of xItemCount items.
+ *
+ * @param xItemCount The number of items in pvItemsToQueue.
+ *
+ * @param pxHigherPriorityTaskWoken xQueueSendMultipleFromISR() will set
+ * *pxHigherPriorityTaskWoken to pdTRUE if sending the items caused a task
+ * to unblock, and the unblocked task has a priority higher than the currently
+ * running task.  If xQueueSendMultipleFromISR() sets this value to pdTRUE then
+ * a context switch should be requested before the interrupt is exited.
+ *
+ * @return The number of items posted, from 0 to xItemCount.
+ *
+ * \defgroup xQueueSendMultipleFromISR xQueueSendMultipleFromISR
+ * \ingroup QueueManagement
+ */
+size_t xQueueSendMultipleFromISR( QueueHandle_t xQueue,
+                                  const void * const pvItemsToQueue,
+                                  const size_t xItemCount,
+                                  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * size_t xQueueReceiveMultiple(
+ *                               QueueHandle_t xQueue,
+ *                               void * const pvBuffer,
+ *                               const size_t xBufferLengthItems,
+ *                               TickType_t xTicksToWait
+ *                             );
+ * @endcode
+ *
+ * Receive up to xBufferLengthItems items from a queue in a single critical
+ * section, using at most two copies.  As many items as are available, up to
+ * the size of the buffer, are removed from the queue.  If the queue is empty
+ * the calling task blocks for up to xTicksToWait ticks until at least one item
+ * is available.  One task waiting to send to the queue is unblocked for each
+ * item received.
+ *
+ * This function must not be used on a semaphore or mutex, nor from an
+ * interrupt service routine.  See xQueueReceiveMultipleFromISR() for an
+ * alternative that can.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to the buffer into which the received items will be
+ * copied, in the order they were sent.
+ *
+ * @param xBufferLengthItems The number of items pvBuffer can hold.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item to receive should the queue be empty at the time
+ * of the call.
+ *
+ * @return The number of items received, from 0 to xBufferLengthItems.
+ *
+ * \defgroup xQueueReceiveMultiple xQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+size_t xQueueReceiveMultiple( QueueHandle_t xQueue,
+                              void * const pvBuffer,
+                              const size_t xBufferLengthItems,
+                              TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * size_t xQueueReceiveMultipleFromISR(
+ *                                      QueueHandle_t xQueue,
+ *                                      void * const pvBuffer,
+ *                                      const size_t xBufferLengthItems,
+ *                                      BaseType_t *pxHigherPriorityTaskWoken
+ *                                    );
+ * @endcode
+ *
+ * A version of xQueueReceiveMultiple() that can be called from an interrupt
+ * service routine.  The function never blocks.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to the buffer into which the received items will be
+ * copied.
+ *
+ * @param xBufferLengthItems The number of items pvBuffer can hold.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if receiving the items
+ * caused a task that was blocked waiting for space on the queue to unblock,
+ * and that task has a priority higher than the currently running task.
+ *
+ * @return The number of items received, from 0 to xBufferLengthItems.
+ *
+ * \defgroup xQueueReceiveMultipleFromISR xQueueReceiveMultipleFromISR
+ * \ingroup QueueManagement
+ */
+size_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue,
+                                     void * const pvBuffer,
+                                     const size_t xBufferLengthItems,
+                                     BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * BaseType_t xQueueReserve(
+ *                           QueueHandle_t xQueue,
+ *                           void ** const ppvSlot,
+ *                           TickType_t xTicksToWait
+ *                         );
+ * @endcode
+ *
+ * Reserve the next slot at the back of a queue so an item can be written
+ * directly into the queue storage area, instead of being built in a buffer
+ * and copied in by xQueueSend().  The item is not visible to receivers until
+ * xQueueCommit() is called.  Items sent to the back of the queue while the
+ * slot is reserved are placed behind it, and are only received after it.
+ *
+ * Only one slot of a queue can be reserved at a time.  xQueueReserve() fails
+ * at once while another slot is reserved, whatever the value of
+ * xTicksToWait.  While the queue is full it blocks on the queue in the same
+ * way as xQueueSend().
+ *
+ * configUSE_QUEUE_ZERO_COPY must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.  It must not be used on a queue that is a member
+ * of a queue set, or together with xQueueOverwrite().  It must not be called
+ * from an interrupt service routine.
+ *
+ * @param xQueue The handle to the queue in which to reserve a slot.
+ *
+ * @param ppvSlot Set to the address of the reserved slot, which is the size
+ * of an item as defined when the queue was created.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for a slot to become available.
+ *
+ * @return pdPASS if a slot was reserved, otherwise errQUEUE_FULL, including
+ * when another slot is already reserved.
+ *
+ * Example usage:
+ * @code{c}
+ * void vAFrameTask( void *pvParameters )
+ * {
+ * void *pvFrame;
+ *
+ *  for( ;; )
+ *  {
+ *      if( xQueueReserve( xFrameQueue, &pvFrame, portMAX_DELAY ) == pdPASS )
+ *      {
+ *          // Fill the frame in place, then pass it on.
+ *          vReadFrame( pvFrame );
+ *          xQueueCommit( xFrameQueue, pvFrame );
+ *      }
+ *  }
+ * }
+ * @endcode
+ * \defgroup xQueueReserve xQueueReserve
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueReserve( QueueHandle_t xQueue,
+                          void ** const ppvSlot,
+                          TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * BaseType_t xQueueCommit( QueueHandle_t xQueue, void * const pvSlot );
+ * @endcode
+ *
+ * Post the item written into a slot obtained from xQueueReserve(), along with
+ * any items sent behind it while it was reserved.  Tasks waiting to receive
+ * from the queue are unblocked as for xQueueSend().
+ *
+ * @param xQueue The handle to the queue the slot was reserved in.
+ *
+ * @param pvSlot The slot returned by xQueueReserve().
+ *
+ * @return pdPASS.
+ *
+ * \defgroup xQueueCommit xQueueCommit
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueCommit( QueueHandle_t xQueue,
+                         void * const pvSlot ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * BaseType_t xQueueAcquire(
+ *                           QueueHandle_t xQueue,
+ *                           void ** const ppvSlot,
+ *                           TickType_t xTicksToWait
+ *                         );
+ * @endcode
+ *
+ * Remove the item at the front of a queue without copying it out.  The item
+ * is read in place from the queue storage area, and its slot is not reused
+ * until xQueueRelease() is called.  Other tasks can receive the items behind
+ * it meanwhile, but the slots those items occupied are also only freed when
+ * the acquired slot is released.
+ *
+ * Only one slot of a queue can be acquired at a time.  xQueueAcquire() fails
+ * at once while another slot is acquired, whatever the value of
+ * xTicksToWait.  While the queue is empty it blocks on the queue in the same
+ * way as xQueueReceive().
+ *
+ * configUSE_QUEUE_ZERO_COPY must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.  Items must not be sent to the front of the
+ * queue while a slot is acquired.  It must not be called from an interrupt
+ * service routine.
+ *
+ * @param xQueue The handle to the queue from which to acquire an item.
+ *
+ * @param ppvSlot Set to the address of the slot holding the item.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item should the queue be empty.
+ *
+ * @return pdPASS if an item was acquired, otherwise errQUEUE_EMPTY, including
+ * when another slot is already acquired.
+ *
+ * \defgroup xQueueAcquire xQueueAcquire
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueAcquire( QueueHandle_t xQueue,
+                          void ** const ppvSlot,
+                          TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * BaseType_t xQueueRelease( QueueHandle_t xQueue, void * const pvSlot );
+ * @endcode
+ *
+ * Return a slot obtained from xQueueAcquire() to the queue once the item in
+ * it is no longer needed.  Tasks waiting to send to the queue are unblocked
+ * as for xQueueReceive().
+ *
+ * @param xQueue The handle to the queue the item was acquired from.
+ *
+ * @param pvSlot The slot returned by xQueueAcquire().
+ *
+ * @return pdPASS.
+ *
+ * \defgroup xQueueRelease xQueueRelease
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueRelease( QueueHandle_t xQueue,
+                          void * const pvSlot ) PRIVILEGED_FUNCTION;
+
 /**
  * queue. h
  * @code{c}
@@ -1485,6 +1813,9 @@ BaseType_t xQueueCRReceive( QueueHandle_t xQueue,
 QueueHandle_t xQueueCreateMutex( const uint8_t ucQueueType ) PRIVILEGED_FUNCTION;
 QueueHandle_t xQueueCreateMutexStatic( const uint8_t ucQueueType,
                                        StaticQueue_t * pxStaticQueue ) PRIVILEGED_FUNCTION;
+QueueHandle_t xQueueCreateMutexWithCeiling( const UBaseType_t uxCeilingPriority ) PRIVILEGED_FUNCTION;
+QueueHandle_t xQueueCreateMutexWithCeilingStatic( const UBaseType_t uxCeilingPriority,
+                                                  StaticQueue_t * pxStaticQueue ) PRIVILEGED_FUNCTION;
 QueueHandle_t xQueueCreateCountingSemaphore( const UBaseType_t uxMaxCount,
                                              const UBaseType_t uxInitialCount ) PRIVILEGED_FUNCTION;
 QueueHandle_t xQueueCreateCountingSemaphoreStatic( const UBaseType_t uxMaxCount,
@@ -1503,6 +1834,22 @@ BaseType_t xQueueTakeMutexRecursive( QueueHandle_t xMutex,
                                      TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 BaseType_t xQueueGiveMutexRecursive( QueueHandle_t xMutex ) PRIVILEGED_FUNCTION;
 
+/*
+ * For internal use only.  Use xSemaphoreCreateReadWriteLock(),
+ * xSemaphoreTakeRead(), xSemaphoreGiveRead(), xSemaphoreTakeWrite(),
+ * xSemaphoreGiveWrite() or xSemaphoreGetWriteLockHolder() instead of calling
+ * these functions directly.
+ */
+QueueHandle_t xQueueCreateReadWriteLock( void ) PRIVILEGED_FUNCTION;
+QueueHandle_t xQueueCreateReadWriteLockStatic( StaticQueue_t * pxStaticQueue ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueTakeReadLock( QueueHandle_t xLock,
+                               TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueGiveReadLock( QueueHandle_t xLock ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueTakeWriteLock( QueueHandle_t xLock,
+                                TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueGiveWriteLock( QueueHandle_t xLock ) PRIVILEGED_FUNCTION;
+TaskHandle_t xQueueGetWriteLockHolder( QueueHandle_t xLock ) PRIVILEGED_FUNCTION;
+
 /*
  * Reset a queue back to its original empty state.  The return value is now
  * obsolete and is always set to pdPASS.
@@ -1742,6 +2089,109 @@ QueueSetMemberHandle_t xQueueSelectFromSet( QueueSetHandle_t xQueueSet,
  */
 QueueSetMemberHandle_t xQueueSelectFromSetFromISR( QueueSetHandle_t xQueueSet ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * @code{c}
+ * QueueHandle_t xQueueCreateForType( UBaseType_t uxQueueLength, type );
+ * QueueHandle_t xQueueCreateStaticForType( UBaseType_t uxQueueLength, type,
+ *                                          uint8_t *pucQueueStorage,
+ *                                          StaticQueue_t *pxQueueBuffer );
+ * queueDEFINE_TYPED_QUEUE( Name, type );
+ * @endcode
+ *
+ * Typed queues.  xQueueCreateForType() and xQueueCreateStaticForType() create
+ * a queue whose item size is sizeof( type ).  queueDEFINE_TYPED_QUEUE() then
+ * defines inline functions that send and receive items of that type, so the
+ * compiler checks the type of every item and pointer or handle items can be
+ * passed by value:
+ *
+ * BaseType_t xNameSend( QueueHandle_t xQueue, type xItem, TickType_t xTicksToWait );
+ * BaseType_t xNameSendFromISR( QueueHandle_t xQueue, type xItem, BaseType_t *pxHigherPriorityTaskWoken );
+ * BaseType_t xNameReceive( QueueHandle_t xQueue, type *pxItem, TickType_t xTicksToWait );
+ * BaseType_t xNameReceiveFromISR( QueueHandle_t xQueue, type *pxItem, BaseType_t *pxHigherPriorityTaskWoken );
+ *
+ * Items the size of a 32-bit or 64-bit word are copied into and out of the
+ * queue without a call to memcpy() when configQUEUE_INLINE_ITEM_COPY is set
+ * to 1.  It is 0 by default, as the two extra size compares on every copy are
+ * only worth it where a call to memcpy() costs more than they do.
+ *
+ * The functions are defined with portFORCE_INLINE if the port provides it,
+ * otherwise with the C99 inline keyword.  Use queueDEFINE_TYPED_QUEUE() at
+ * file scope, once per type in each file that uses it.
+ *
+ * Example usage:
+ * @code{c}
+ * queueDEFINE_TYPED_QUEUE( FrameQueue, Frame_t * );
+ *
+ * void vATask( void *pvParameters )
+ * {
+ * QueueHandle_t xQueue = xQueueCreateForType( 8, Frame_t * );
+ * static Frame_t xFrame;
+ * Frame_t *pxFrame;
+ *
+ *  // The pointer itself is queued, not the frame it points to.
+ *  xFrameQueueSend( xQueue, &xFrame, portMAX_DELAY );
+ *  xFrameQueueReceive( xQueue, &pxFrame, portMAX_DELAY );
+ * }
+ * @endcode
+ * \defgroup queueDEFINE_TYPED_QUEUE queueDEFINE_TYPED_QUEUE
+ * \ingroup QueueManagement
+ */
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+    #define xQueueCreateForType( uxQueueLength, type )    xQueueCreate( ( uxQueueLength ), ( UBaseType_t ) sizeof( type ) )
+#endif
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    #define xQueueCreateStaticForType( uxQueueLength, type, pucQueueStorage, pxQueueBuffer ) \
+    xQueueCreateStatic( ( uxQueueLength ), ( UBaseType_t ) sizeof( type ), ( pucQueueStorage ), ( pxQueueBuffer ) )
+#endif
+
+#ifdef portFORCE_INLINE
+    #define queueTYPED_INLINE    portFORCE_INLINE
+#else
+    #define queueTYPED_INLINE    inline
+#endif
+
+/* The inline copy reads and writes exactly sizeof( type ) bytes, so check the
+ * queue was created for the type.  uxQueueGetQueueItemSize() is privileged, so
+ * the check is left out when the MPU wrappers are used. */
+#if ( portUSING_MPU_WRAPPERS == 1 )
+    #define queueASSERT_TYPED_ITEM_SIZE( xQueue, type )
+#else
+    #define queueASSERT_TYPED_ITEM_SIZE( xQueue, type )    configASSERT( uxQueueGetQueueItemSize( xQueue ) == ( UBaseType_t ) sizeof( type ) )
+#endif
+
+#define queueDEFINE_TYPED_QUEUE( Name, type )                                                        \
+    static queueTYPED_INLINE BaseType_t x ## Name ## Send( QueueHandle_t xQueue,                     \
+                                                           type xItem,                               \
+                                                           TickType_t xTicksToWait )                 \
+    {                                                                                                \
+        queueASSERT_TYPED_ITEM_SIZE( xQueue, type );                                                 \
+        return xQueueGenericSend( xQueue, &xItem, xTicksToWait, queueSEND_TO_BACK );                 \
+    }                                                                                                \
+    static queueTYPED_INLINE BaseType_t x ## Name ## SendFromISR( QueueHandle_t xQueue,              \
+                                                                  type xItem,                        \
+                                                                  BaseType_t * pxHigherPriorityTaskWoken ) \
+    {                                                                                                \
+        queueASSERT_TYPED_ITEM_SIZE( xQueue, type );                                                 \
+        return xQueueGenericSendFromISR( xQueue, &xItem, pxHigherPriorityTaskWoken, queueSEND_TO_BACK ); \
+    }                                                                                                \
+    static queueTYPED_INLINE BaseType_t x ## Name ## Receive( QueueHandle_t xQueue,                  \
+                                                              type * pxItem,                         \
+                                                              TickType_t xTicksToWait )              \
+    {                                                                                                \
+        queueASSERT_TYPED_ITEM_SIZE( xQueue, type );                                                 \
+        return xQueueReceive( xQueue, pxItem, xTicksToWait );                                        \
+    }                                                                                                \
+    static queueTYPED_INLINE BaseType_t x ## Name ## ReceiveFromISR( QueueHandle_t xQueue,           \
+                                                                     type * pxItem,                  \
+                                                                     BaseType_t * pxHigherPriorityTaskWoken ) \
+    {                                                                                                \
+        queueASSERT_TYPED_ITEM_SIZE( xQueue, type );                                                 \
+        return xQueueReceiveFromISR( xQueue, pxItem, pxHigherPriorityTaskWoken );                    \
+    }                                                                                                \
+    typedef int queueTYPED_QUEUE_ ## Name ## _DEFINED
+
 /* Not public API functions. */
 void vQueueWaitForMessageRestricted( QueueHandle_t xQueue,
                                      TickType_t xTicksToWait,
@@ -702,6 +702,10 @@ typedef QueueHandle_t SemaphoreHandle_t;
  *
  * Mutex type semaphores cannot be used from within interrupt service routines.
  *
+ * If configUSE_MUTEX_FAST_PATH is set to 1 in FreeRTOSConfig.h then taking a
+ * free mutex, and giving back a mutex that no other task has tried to take, is
+ * done with an atomic compare-and-swap rather than a critical section.
+ *
  * See xSemaphoreCreateBinary() for an alternative implementation that can be
  * used for pure synchronisation (where one task or interrupt always 'gives' the
  * semaphore and another always 'takes' the semaphore) and from within interrupt
@@ -763,6 +767,10 @@ typedef QueueHandle_t SemaphoreHandle_t;
  *
  * Mutex type semaphores cannot be used from within interrupt service routines.
  *
+ * If configUSE_MUTEX_FAST_PATH is set to 1 in FreeRTOSConfig.h then taking a
+ * free mutex, and giving back a mutex that no other task has tried to take, is
+ * done with an atomic compare-and-swap rather than a critical section.
+ *
  * See xSemaphoreCreateBinary() for an alternative implementation that can be
  * used for pure synchronisation (where one task or interrupt always 'gives' the
  * semaphore and another always 'takes' the semaphore) and from within interrupt
@@ -798,6 +806,350 @@ typedef QueueHandle_t SemaphoreHandle_t;
     #define xSemaphoreCreateMutexStatic( pxMutexBuffer )    xQueueCreateMutexStatic( queueQUEUE_TYPE_MUTEX, ( pxMutexBuffer ) )
 #endif
 
+/**
+ * semphr. h
+ * @code{c}
+ * SemaphoreHandle_t xSemaphoreCreateMutexWithCeiling( UBaseType_t uxCeilingPriority );
+ * @endcode
+ *
+ * Creates a new mutex type semaphore that uses the immediate priority ceiling
+ * protocol instead of priority inheritance, and returns a handle by which the
+ * new mutex can be referenced.  configUSE_MUTEX_PRIORITY_CEILING must be set to
+ * 1 in FreeRTOSConfig.h for xSemaphoreCreateMutexWithCeiling() to be available.
+ *
+ * A task that takes the mutex has its priority raised to uxCeilingPriority
+ * straight away, so no other task that uses the mutex can preempt it while it
+ * holds the mutex, and a task that does have to wait for the mutex does not
+ * change the priority of the holder.  The raised priority is dropped when the
+ * task gives the mutex back, or, if the task holds other mutexes, when it has
+ * given all of them back - in the same way as an inherited priority.
+ *
+ * uxCeilingPriority must be at least the priority of the highest priority task
+ * that takes the mutex.  Taking the mutex from a task with a higher priority
+ * fails a configASSERT().
+ *
+ * Mutexes created using this function can be accessed using the xSemaphoreTake()
+ * and xSemaphoreGive() macros.  The xSemaphoreTakeRecursive() and
+ * xSemaphoreGiveRecursive() macros must not be used.  They are never taken
+ * through the configUSE_MUTEX_FAST_PATH fast path, as the holder's priority has
+ * to be changed.
+ *
+ * Mutex type semaphores cannot be used from within interrupt service routines.
+ *
+ * @param uxCeilingPriority The priority given to a task while it holds the
+ * mutex.  Must be above tskIDLE_PRIORITY and below configMAX_PRIORITIES.
+ *
+ * @return If the mutex was successfully created then a handle to the created
+ * mutex is returned.  If there was not enough heap to allocate the mutex data
+ * structures then NULL is returned.
+ *
+ * Example usage:
+ * @code{c}
+ * #define mainCONTROL_TASK_PRIORITY    ( tskIDLE_PRIORITY + 3 )
+ *
+ * SemaphoreHandle_t xSemaphore;
+ *
+ * void vATask( void * pvParameters )
+ * {
+ *  // No task with a priority above mainCONTROL_TASK_PRIORITY takes the mutex.
+ *  xSemaphore = xSemaphoreCreateMutexWithCeiling( mainCONTROL_TASK_PRIORITY );
+ *
+ *  if( xSemaphore != NULL )
+ *  {
+ *      // The semaphore was created successfully.
+ *      // The semaphore can now be used.
+ *  }
+ * }
+ * @endcode
+ * \defgroup xSemaphoreCreateMutexWithCeiling xSemaphoreCreateMutexWithCeiling
+ * \ingroup Semaphores
+ */
+#if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_MUTEX_PRIORITY_CEILING == 1 ) )
+    #define xSemaphoreCreateMutexWithCeiling( uxCeilingPriority )    xQueueCreateMutexWithCeiling( ( uxCeilingPriority ) )
+#endif
+
+/**
+ * semphr. h
+ * @code{c}
+ * SemaphoreHandle_t xSemaphoreCreateMutexWithCeilingStatic( UBaseType_t uxCeilingPriority,
+ *                                                           StaticSemaphore_t *pxMutexBuffer );
+ * @endcode
+ *
+ * As xSemaphoreCreateMutexWithCeiling(), but the application writer provides
+ * the memory that holds the mutex structure, so no dynamic memory allocation
+ * is performed.
+ *
+ * @param uxCeilingPriority The priority given to a task while it holds the
+ * mutex.  Must be above tskIDLE_PRIORITY and below configMAX_PRIORITIES.
+ *
+ * @param pxMutexBuffer Must point to a variable of type StaticSemaphore_t,
+ * which will be used to hold the mutex's data structure.
+ *
+ * @return If the mutex was successfully created then a handle to the created
+ * mutex is returned.  If pxMutexBuffer was NULL then NULL is returned.
+ *
+ * Example usage:
+ * @code{c}
+ * SemaphoreHandle_t xSemaphore;
+ * StaticSemaphore_t xMutexBuffer;
+ *
+ * void vATask( void * pvParameters )
+ * {
+ *  xSemaphore = xSemaphoreCreateMutexWithCeilingStatic( tskIDLE_PRIORITY + 3, &xMutexBuffer );
+ * }
+ * @endcode
+ * \defgroup xSemaphoreCreateMutexWithCeilingStatic xSemaphoreCreateMutexWithCeilingStatic
+ * \ingroup Semaphores
+ */
+#if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configUSE_MUTEX_PRIORITY_CEILING == 1 ) )
+    #define xSemaphoreCreateMutexWithCeilingStatic( uxCeilingPriority, pxMutexBuffer )    xQueueCreateMutexWithCeilingStatic( ( uxCeilingPriority ), ( pxMutexBuffer ) )
+#endif
+
+/**
+ * semphr. h
+ * @code{c}
+ * SemaphoreHandle_t xSemaphoreCreateReadWriteLock( void );
+ * @endcode
+ *
+ * Creates a new read write lock, and returns a handle by which the new lock
+ * can be referenced.  configUSE_READ_WRITE_LOCKS must be set to 1 in
+ * FreeRTOSConfig.h for xSemaphoreCreateReadWriteLock() to be available.
+ *
+ * Any number of tasks can hold a read write lock for reading at the same
+ * time, using xSemaphoreTakeRead() and xSemaphoreGiveRead(), while only one
+ * task at a time can hold it for writing, using xSemaphoreTakeWrite() and
+ * xSemaphoreGiveWrite(), and only when no task holds it for reading.
+ *
+ * Writers are preferred.  Once a task is waiting to write, tasks that try to
+ * take the lock for reading wait until the writer has taken and given back the
+ * lock, so a writer waits for no longer than the readers that already hold the
+ * lock take to give it back.
+ *
+ * A task that holds the lock for writing inherits the priority of any higher
+ * priority task that waits for the lock, in the same way as the holder of a
+ * mutex.  The tasks that hold the lock for reading are not recorded, so do not
+ * inherit priorities.  A low priority reader that is preempted by medium
+ * priority tasks therefore delays a high priority writer for as long as those
+ * tasks run, without bound.  Where that matters, give readers a priority at
+ * least as high as the writers', or use a mutex instead.
+ *
+ * Read write locks cannot be used from within interrupt service routines, and
+ * must not be used with xSemaphoreTake(), xSemaphoreGive(), xQueueReset() or
+ * any other queue API, which configASSERT() catches.  A task must not
+ * try to take a lock it already holds.  uxSemaphoreGetCount() returns the
+ * number of tasks that hold the lock for reading.
+ *
+ * @return If the lock was successfully created then a handle to the created
+ * lock is returned.  If there was not enough heap to allocate the lock data
+ * structures then NULL is returned.
+ *
+ * Example usage:
+ * @code{c}
+ * SemaphoreHandle_t xTableLock;
+ *
+ * void vATask( void * pvParameters )
+ * {
+ *  xTableLock = xSemaphoreCreateReadWriteLock();
+ *
+ *  if( xTableLock != NULL )
+ *  {
+ *      // The lock was created successfully and can now be used.
+ *  }
+ * }
+ * @endcode
+ * \defgroup xSemaphoreCreateReadWriteLock xSemaphoreCreateReadWriteLock
+ * \ingroup Semaphores
+ */
+#if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_READ_WRITE_LOCKS == 1 ) )
+    #define xSemaphoreCreateReadWriteLock()    xQueueCreateReadWriteLock()
+#endif
+
+/**
+ * semphr. h
+ * @code{c}
+ * SemaphoreHandle_t xSemaphoreCreateReadWriteLockStatic( StaticSemaphore_t *pxLockBuffer );
+ * @endcode
+ *
+ * As xSemaphoreCreateReadWriteLock(), but the application writer provides the
+ * memory that holds the lock structure, so no dynamic memory allocation is
+ * performed.
+ *
+ * @param pxLockBuffer Must point to a variable of type StaticSemaphore_t,
+ * which will be used to hold the lock's data structure.
+ *
+ * @return If the lock was successfully created then a handle to the created
+ * lock is returned.  If pxLockBuffer was NULL then NULL is returned.
+ *
+ * Example usage:
+ * @code{c}
+ * SemaphoreHandle_t xTableLock;
+ * StaticSemaphore_t xTableLockBuffer;
+ *
+ * void vATask( void * pvParameters )
+ * {
+ *  xTableLock = xSemaphoreCreateReadWriteLockStatic( &xTableLockBuffer );
+ * }
+ * @endcode
+ * \defgroup xSemaphoreCreateReadWriteLockStatic xSemaphoreCreateReadWriteLockStatic
+ * \ingroup Semaphores
+ */
+#if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configUSE_READ_WRITE_LOCKS == 1 ) )
+    #define xSemaphoreCreateReadWriteLockStatic( pxLockBuffer )    xQueueCreateReadWriteLockStatic( ( pxLockBuffer ) )
+#endif
+
+/**
+ * semphr. h
+ * @code{c}
+ * xSemaphoreTakeRead(
+ *                     SemaphoreHandle_t xLock,
+ *                     TickType_t xBlockTime
+ *                   );
+ * @endcode
+ *
+ * <i>Macro</i> to take a read write lock for reading.  The lock must have
+ * previously been created using xSemaphoreCreateReadWriteLock() or
+ * xSemaphoreCreateReadWriteLockStatic().
+ *
+ * @param xLock A handle to the lock being taken.
+ *
+ * @param xBlockTime The time in ticks to wait for the lock to become available
+ * for reading.  The lock is not available while a task holds it for writing or
+ * is waiting to write.  A block time of zero can be used to poll the lock.
+ *
+ * @return pdTRUE if the lock was taken.  pdFALSE if xBlockTime expired without
+ * the lock becoming available.
+ *
+ * Example usage:
+ * @code{c}
+ * void vAReaderTask( void * pvParameters )
+ * {
+ *  for( ;; )
+ *  {
+ *      if( xSemaphoreTakeRead( xTableLock, ( TickType_t ) 10 ) == pdTRUE )
+ *      {
+ *          // Other readers can read the table at the same time, but no task
+ *          // can change it until the lock is given back.
+ *
+ *          xSemaphoreGiveRead( xTableLock );
+ *      }
+ *  }
+ * }
+ * @endcode
+ * \defgroup xSemaphoreTakeRead xSemaphoreTakeRead
+ * \ingroup Semaphores
+ */
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+    #define xSemaphoreTakeRead( xLock, xBlockTime )    xQueueTakeReadLock( ( xLock ), ( xBlockTime ) )
+#endif
+
+/**
+ * semphr. h
+ * @code{c}
+ * xSemaphoreGiveRead( SemaphoreHandle_t xLock );
+ * @endcode
+ *
+ * <i>Macro</i> to give back a read write lock that was taken using
+ * xSemaphoreTakeRead().  When the last reader gives the lock back a task that
+ * is waiting to write is unblocked.
+ *
+ * @param xLock A handle to the lock being given.
+ *
+ * @return pdTRUE if the lock was given.  pdFALSE if no task held the lock for
+ * reading.
+ * \defgroup xSemaphoreGiveRead xSemaphoreGiveRead
+ * \ingroup Semaphores
+ */
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+    #define xSemaphoreGiveRead( xLock )    xQueueGiveReadLock( ( xLock ) )
+#endif
+
+/**
+ * semphr. h
+ * @code{c}
+ * xSemaphoreTakeWrite(
+ *                      SemaphoreHandle_t xLock,
+ *                      TickType_t xBlockTime
+ *                    );
+ * @endcode
+ *
+ * <i>Macro</i> to take a read write lock for writing.  The lock must have
+ * previously been created using xSemaphoreCreateReadWriteLock() or
+ * xSemaphoreCreateReadWriteLockStatic().
+ *
+ * @param xLock A handle to the lock being taken.
+ *
+ * @param xBlockTime The time in ticks to wait for every other task to give
+ * the lock back.  Tasks that try to take the lock for reading while the
+ * calling task waits are held off.  A block time of zero can be used to poll
+ * the lock.  The calling task's priority is not lent to tasks that hold the
+ * lock for reading, see xSemaphoreCreateReadWriteLock().
+ *
+ * @return pdTRUE if the lock was taken.  pdFALSE if xBlockTime expired without
+ * the lock becoming available.
+ *
+ * Example usage:
+ * @code{c}
+ * void vAWriterTask( void * pvParameters )
+ * {
+ *  for( ;; )
+ *  {
+ *      vTaskDelay( pdMS_TO_TICKS( 60000 ) );
+ *
+ *      if( xSemaphoreTakeWrite( xTableLock, pdMS_TO_TICKS( 100 ) ) == pdTRUE )
+ *      {
+ *          // No other task holds the lock, so the table can be changed.
+ *
+ *          xSemaphoreGiveWrite( xTableLock );
+ *      }
+ *  }
+ * }
+ * @endcode
+ * \defgroup xSemaphoreTakeWrite xSemaphoreTakeWrite
+ * \ingroup Semaphores
+ */
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+    #define xSemaphoreTakeWrite( xLock, xBlockTime )    xQueueTakeWriteLock( ( xLock ), ( xBlockTime ) )
+#endif
+
+/**
+ * semphr. h
+ * @code{c}
+ * xSemaphoreGiveWrite( SemaphoreHandle_t xLock );
+ * @endcode
+ *
+ * <i>Macro</i> to give back a read write lock that was taken using
+ * xSemaphoreTakeWrite().  Any priority the writer inherited is dropped.  If
+ * another task is waiting to write it is unblocked, otherwise all the tasks
+ * waiting to read are unblocked.
+ *
+ * @param xLock A handle to the lock being given.
+ *
+ * @return pdTRUE if the lock was given.  pdFALSE if the calling task did not
+ * hold the lock for writing.
+ * \defgroup xSemaphoreGiveWrite xSemaphoreGiveWrite
+ * \ingroup Semaphores
+ */
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+    #define xSemaphoreGiveWrite( xLock )    xQueueGiveWriteLock( ( xLock ) )
+#endif
+
+/**
+ * semphr. h
+ * @code{c}
+ * TaskHandle_t xSemaphoreGetWriteLockHolder( SemaphoreHandle_t xLock );
+ * @endcode
+ *
+ * If xLock is a read write lock that a task holds for writing then that task's
+ * handle is returned, otherwise NULL is returned.  As with
+ * xSemaphoreGetMutexHolder(), the writer can change as soon as the function
+ * returns.
+ * \defgroup xSemaphoreGetWriteLockHolder xSemaphoreGetWriteLockHolder
+ * \ingroup Semaphores
+ */
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+    #define xSemaphoreGetWriteLockHolder( xLock )    xQueueGetWriteLockHolder( ( xLock ) )
+#endif
+
 
 /**
  * semphr. h
@@ -836,6 +1188,10 @@ typedef QueueHandle_t SemaphoreHandle_t;
  *
  * Mutex type semaphores cannot be used from within interrupt service routines.
  *
+ * If configUSE_MUTEX_FAST_PATH is set to 1 in FreeRTOSConfig.h then taking a
+ * free mutex, and giving back a mutex that no other task has tried to take, is
+ * done with an atomic compare-and-swap rather than a critical section.
+ *
  * See xSemaphoreCreateBinary() for an alternative implementation that can be
  * used for pure synchronisation (where one task or interrupt always 'gives' the
  * semaphore and another always 'takes' the semaphore) and from within interrupt
@@ -905,6 +1261,10 @@ typedef QueueHandle_t SemaphoreHandle_t;
  *
  * Mutex type semaphores cannot be used from within interrupt service routines.
  *
+ * If configUSE_MUTEX_FAST_PATH is set to 1 in FreeRTOSConfig.h then taking a
+ * free mutex, and giving back a mutex that no other task has tried to take, is
+ * done with an atomic compare-and-swap rather than a critical section.
+ *
  * See xSemaphoreCreateBinary() for an alternative implementation that can be
  * used for pure synchronisation (where one task or interrupt always 'gives' the
  * semaphore and another always 'takes' the semaphore) and from within interrupt
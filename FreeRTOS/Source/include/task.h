@@ -3263,7 +3263,6 @@ void vTaskPlaceOnEventList( List_t * const pxEventList,
 void vTaskPlaceOnUnorderedEventList( List_t * pxEventList,
                                      const TickType_t xItemValue,
                                      const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
-void vTaskPlaceOnSemaphoreList( List_t * const pxSemaphoreList ) PRIVILEGED_FUNCTION;
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -3306,9 +3305,6 @@ void vTaskPlaceOnEventListRestricted( List_t * const pxEventList,
 BaseType_t xTaskRemoveFromEventList( const List_t * const pxEventList ) PRIVILEGED_FUNCTION;
 void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem,
                                         const TickType_t xItemValue ) PRIVILEGED_FUNCTION;
-void vTaskRemoveFromSemaphoreList( const List_t * const pxSemaphoreList ) PRIVILEGED_FUNCTION;
-void vTaskPopFromSemaphoreList( const List_t * const pxSemaphoreList ) PRIVILEGED_FUNCTION;
-BaseType_t xTaskPopFromSemaphoreListFromISR ( const List_t * const pxSemaphoreList ) PRIVILEGED_FUNCTION;
 
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
@@ -3419,6 +3415,20 @@ eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
  */
 TaskHandle_t pvTaskIncrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * For internal use only.  Increment the mutex held count of a task that took
+ * a mutex through the uncontended fast path, which does not count it, once
+ * another task has to wait for that mutex.
+ */
+void vTaskIncrementMutexHeldCountOf( TaskHandle_t xMutexHolder ) PRIVILEGED_FUNCTION;
+
+/*
+ * For internal use only.  Raise the priority of the calling task to the
+ * ceiling priority of a mutex it has just taken.  The priority is restored by
+ * xTaskPriorityDisinherit() once the task holds no more mutexes.
+ */
+void vTaskPriorityRaiseToCeiling( UBaseType_t uxCeilingPriority ) PRIVILEGED_FUNCTION;
+
 /*
  * For internal use only.  Same as vTaskSetTimeOutState(), but without a critical
  * section.
@@ -1,291 +1,2077 @@
 #include "FreeRTOS.h"
 
+#include "atomic.h"
 #include "my_queue.h"
 #include "my_semaphore.h"
+#include "task.h"
 
 #include <string.h>
 
+/* Receiver blocked in xMyQueueReceive. Lives on the receiver's stack while it
+ * waits so a sender can copy an item straight into pvBuffer */
+typedef struct MyQueueReceiver
+{
+    TaskHandle_t xTask;
+    void* pvBuffer;
+    /* Set by the sender once the item is in pvBuffer */
+    volatile BaseType_t xDelivered;
+    struct MyQueueReceiver* pxNext;
+} MyQueueReceiver_t;
+
 struct MyQueueDefinition
 {
     /* Counting semaphore representing how many spots in the queue are empty */
     MySemaphoreHandle_t pxEmptySemaphore;
     /* Counting semaphore representing how many spots in the queue are full */
     MySemaphoreHandle_t pxFullSemaphore;
-    /* Binary semaphore that provides mutual exclusivity while reading / writing */
-    MySemaphoreHandle_t pxModifySemaphore;
 
+    /* Memory for the two semaphores above so a queue is a single block */
+    StaticMySemaphore_t xEmptySemaphoreBuffer;
+    StaticMySemaphore_t xFullSemaphoreBuffer;
+
+    UBaseType_t uxLength;
     size_t xItemSize;
 
-    /* Circular buffer. We read from ucHead and write to ucTail */
-    int8_t* ucHead;
-    int8_t* ucTail;
+    /* Distance between slots in the ring. Larger than xItemSize when slots
+     * are padded to whole cache lines */
+    size_t xSlotSize;
+
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+        /* Size of the ring in bytes minus one if that is a power of two, so
+         * wrapping is a mask rather than a compare, otherwise 0 */
+        size_t xRingMask;
+    #endif
+
+    /* Set for queues made by pxMyQueueCreateSPSC. Those have no semaphores
+     * and track occupancy with the counters below instead */
+    BaseType_t xIsSPSC;
+
+    /* Set for queues made by pxMyQueueCreateVariable. Their ring holds
+     * length prefixed messages, uxLength is its size in bytes and
+     * pxEmptySemaphore counts free bytes rather than free slots */
+    BaseType_t xIsVariableLength;
 
     /* Optimization */
     int8_t* ucBufferBegin;
     int8_t* ucBufferEnd;
+
+    /* Receivers blocked in xMyQueueReceive that accept a direct hand-off */
+    MyQueueReceiver_t* pxHandoffReceivers;
+
+    #if ( configMYQUEUE_STATS == 1 )
+        MyQueueStats_t xStats;
+    #endif
+
+    /* Set if the memory was provided by xMyQueueCreateStatic so it must not
+     * be freed */
+    uint8_t ucStaticallyAllocated;
+
+    #if ( configNUMBER_OF_CORES > 1 )
+        /* Guards the queue and both of its semaphores */
+        MySemaphoreLock_t xLock;
+    #endif
+
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+        /* Keeps the sending side below off the cache lines of the fields
+         * above, which are mostly read */
+        uint8_t ucPadding1[ configMYQUEUE_CACHE_LINE_SIZE ];
+    #endif
+
+    /* Sending side. The circular buffer is written at ucTail */
+    int8_t* ucTail;
+
+    /* Task parked waiting for space, or NULL if there is none */
+    TaskHandle_t volatile xWaitingSender;
+
+    /* Slot handed out by pvMyQueueReserve and not yet committed, or NULL if
+     * there is none */
+    void* pvReservedSlot;
+
+    /* Number of items ever sent. Only the producer of an SPSC queue writes it
+     * so the consumer can read it without a critical section */
+    volatile UBaseType_t uxItemsSent;
+
+    /* Items sent behind the reserved slot while it is outstanding. They are
+     * published together with it so receivers never overtake the slot */
+    UBaseType_t uxUnpublishedItems;
+
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+        /* Keeps the two sides on separate cache lines */
+        uint8_t ucPadding2[ configMYQUEUE_CACHE_LINE_SIZE ];
+    #endif
+
+    /* Receiving side, the mirror of the above. The circular buffer is read
+     * at ucHead, and uxItemsSent - uxItemsReceived is the number of items in
+     * an SPSC queue */
+    int8_t* ucHead;
+    TaskHandle_t volatile xWaitingReceiver;
+    void* pvPeekedSlot;
+    volatile UBaseType_t uxItemsReceived;
+    UBaseType_t uxUnreleasedSlots;
 };
 /*-----------------------------------------------------------*/
 
-MyQueueHandle_t pxMyQueueCreate( UBaseType_t xQueueLength, UBaseType_t xItemSize )
-{
-    MyQueueHandle_t pxNewQueue = NULL;
+/* If the cooperative scheduler is being used then a yield should not be
+ * performed just because a higher priority task has been woken */
+#if ( configUSE_PREEMPTION == 0 )
+    #define myqueueYIELD_IF_REQUIRED( xYieldRequired )    ( void ) ( xYieldRequired )
+#else
+    #define myqueueYIELD_IF_REQUIRED( xYieldRequired ) \
+    do {                                               \
+        if( ( xYieldRequired ) != pdFALSE )            \
+        {                                              \
+            portYIELD_WITHIN_API();                    \
+        }                                              \
+    } while( 0 )
+#endif
+/*-----------------------------------------------------------*/
 
-    if( xQueueLength > 0 &&
-        /* Check for overflow */
-        ( SIZE_MAX / xQueueLength ) >= xItemSize &&
-        ( ( size_t ) ( SIZE_MAX - sizeof( MyQueue_t ) ) ) >= ( ( size_t ) (xQueueLength * xItemSize) ) )
+/* Critical sections guarding a queue. With more than one core, each queue
+ * has its own lock, which its semaphores share, so that cores working on
+ * different queues never wait for each other. Nothing that takes the kernel
+ * lock at task level may be called with it held */
+#if ( configNUMBER_OF_CORES > 1 )
+    #define myqueueENTER_CRITICAL( pxMyQueue )                           vMySemaphoreLock( &( ( pxMyQueue )->xLock ) )
+    #define myqueueEXIT_CRITICAL( pxMyQueue )                            vMySemaphoreUnlock( &( ( pxMyQueue )->xLock ) )
+    #define myqueueENTER_CRITICAL_FROM_ISR( pxMyQueue )                  ( vMySemaphoreLock( &( ( pxMyQueue )->xLock ) ), ( UBaseType_t ) 0 )
+    #define myqueueEXIT_CRITICAL_FROM_ISR( pxMyQueue, uxSavedStatus )    \
+    do {                                                                 \
+        ( void ) ( uxSavedStatus );                                      \
+        vMySemaphoreUnlock( &( ( pxMyQueue )->xLock ) );                 \
+    } while( 0 )
+
+    /* Orders the accesses an SPSC queue makes without a lock for the other
+     * cores too, which portMEMORY_BARRIER does not promise */
+    #define myqueueMEMORY_BARRIER()                                      __atomic_thread_fence( __ATOMIC_SEQ_CST )
+#else
+    #define myqueueENTER_CRITICAL( pxMyQueue )                           taskENTER_CRITICAL()
+    #define myqueueEXIT_CRITICAL( pxMyQueue )                            taskEXIT_CRITICAL()
+    #define myqueueENTER_CRITICAL_FROM_ISR( pxMyQueue )                  taskENTER_CRITICAL_FROM_ISR()
+    #define myqueueEXIT_CRITICAL_FROM_ISR( pxMyQueue, uxSavedStatus )    taskEXIT_CRITICAL_FROM_ISR( uxSavedStatus )
+    #define myqueueMEMORY_BARRIER()                                      portMEMORY_BARRIER()
+#endif
+/*-----------------------------------------------------------*/
+
+/* Every message in a variable length queue starts with its length. Records
+ * are whole multiples of the header so the ring never ends mid header */
+#define myqueueMESSAGE_HEADER_SIZE    ( sizeof( size_t ) )
+
+/* Length written where a message did not fit before the end of the ring. The
+ * rest of the ring is padding and the message starts at ucBufferBegin */
+#define myqueueMESSAGE_WRAP_MARKER    ( ( size_t ) -1 )
+/*-----------------------------------------------------------*/
+
+#if ( configMYQUEUE_STATS == 1 )
+
+    /* Count xCount items as sent and record how full the queue now is. Must
+     * be called inside a critical section, or by the producer of an SPSC
+     * queue */
+    static void prvStatsSent( MyQueueHandle_t pxMyQueue, size_t xCount )
     {
-        size_t xQueueSizeBytes = sizeof( MyQueue_t ) + xQueueLength + xItemSize;
-        pxNewQueue = pvPortMalloc( xQueueSizeBytes );
+        UBaseType_t uxInUse;
 
-        if( pxNewQueue == NULL )
+        pxMyQueue->xStats.uxSends += xCount;
+
+        if( pxMyQueue->xIsSPSC != pdFALSE )
         {
-            return NULL;
+            uxInUse = pxMyQueue->uxItemsSent - pxMyQueue->uxItemsReceived;
+        }
+        else
+        {
+            /* Includes slots that are reserved or still being read */
+            uxInUse = pxMyQueue->uxLength - uxMySemaphoreGetCountFromCritical( pxMyQueue->pxEmptySemaphore );
         }
 
-        /* Initialize semaphores */
-        pxNewQueue->pxEmptySemaphore = pxMySemaphoreCreate( xQueueLength, xQueueLength );
-        pxNewQueue->pxFullSemaphore = pxMySemaphoreCreate( xQueueLength, 0 );
-        pxNewQueue->pxModifySemaphore = pxMySemaphoreCreate( 1, 1 );
+        if( uxInUse > pxMyQueue->xStats.uxHighWaterMark )
+        {
+            pxMyQueue->xStats.uxHighWaterMark = uxInUse;
+        }
+    }
+/*-----------------------------------------------------------*/
 
-        /* If any initialization of semaphores fail, gracefully free and return */
-        if( pxNewQueue->pxEmptySemaphore == NULL ||
-            pxNewQueue->pxFullSemaphore == NULL ||
-            pxNewQueue->pxModifySemaphore == NULL )
+    /* Count a send (xForSpace set) or receive that failed without waiting.
+     * Same calling rules as prvStatsSent, with the consumer of an SPSC queue
+     * counting its own receives */
+    static void prvStatsGaveUp( MyQueueHandle_t pxMyQueue, BaseType_t xForSpace )
+    {
+        if( xForSpace != pdFALSE )
         {
-            if( pxNewQueue->pxEmptySemaphore != NULL )
-            {
-                vMySemaphoreDelete( pxNewQueue->pxFullSemaphore );
-            }
+            pxMyQueue->xStats.uxSendTimeouts++;
+        }
+        else
+        {
+            pxMyQueue->xStats.uxReceiveTimeouts++;
+        }
+    }
+/*-----------------------------------------------------------*/
 
-            if( pxNewQueue->pxEmptySemaphore != NULL )
-            {
-                vMySemaphoreDelete( pxNewQueue->pxEmptySemaphore );
-            }
+    /* Count a send (xForSpace set) or receive that had to wait xWaited ticks.
+     * Only called from tasks, outside any critical section */
+    static void prvStatsBlocked( MyQueueHandle_t pxMyQueue,
+                                 BaseType_t xForSpace,
+                                 TickType_t xWaited,
+                                 BaseType_t xSucceeded )
+    {
+        myqueueENTER_CRITICAL( pxMyQueue );
 
-            if( pxNewQueue->pxModifySemaphore != NULL )
-            {
-                vMySemaphoreDelete(pxNewQueue->pxEmptySemaphore);
-            }
+        if( xForSpace != pdFALSE )
+        {
+            pxMyQueue->xStats.uxBlockedSends++;
+        }
+        else
+        {
+            pxMyQueue->xStats.uxBlockedReceives++;
+        }
 
-            return NULL;
+        if( xSucceeded == pdFALSE )
+        {
+            prvStatsGaveUp( pxMyQueue, xForSpace );
         }
 
-        pxNewQueue->xItemSize = xItemSize;
+        pxMyQueue->xStats.xTotalBlockedTicks += xWaited;
 
-        pxNewQueue->ucBufferBegin = ( ( int8_t* ) pxNewQueue ) + sizeof( MyQueue_t );
-        pxNewQueue->ucBufferEnd = pxNewQueue->ucBufferBegin + xQueueLength * xItemSize;
+        if( xWaited > pxMyQueue->xStats.xMaxBlockedTicks )
+        {
+            pxMyQueue->xStats.xMaxBlockedTicks = xWaited;
+        }
 
-        pxNewQueue->ucHead = pxNewQueue->ucBufferBegin;
-        pxNewQueue->ucTail = pxNewQueue->ucBufferBegin;
+        myqueueEXIT_CRITICAL( pxMyQueue );
     }
 
-    return pxNewQueue;
-}
+    #define myqueueSTATS_SENT( pxMyQueue, xCount )          prvStatsSent( ( pxMyQueue ), ( xCount ) )
+    #define myqueueSTATS_RECEIVED( pxMyQueue, xCount )      ( ( pxMyQueue )->xStats.uxReceives += ( xCount ) )
+    #define myqueueSTATS_GAVE_UP( pxMyQueue, xForSpace )    prvStatsGaveUp( ( pxMyQueue ), ( xForSpace ) )
+#else
+    #define myqueueSTATS_SENT( pxMyQueue, xCount )
+    #define myqueueSTATS_RECEIVED( pxMyQueue, xCount )
+    #define myqueueSTATS_GAVE_UP( pxMyQueue, xForSpace )
+#endif /* configMYQUEUE_STATS */
 /*-----------------------------------------------------------*/
 
-void vMyQueueDelete( MyQueueHandle_t pxMyQueue ) {
-    configASSERT( pxMyQueue );
+/* Take xUnits of pxSemaphore, one of pxMyQueue's, waiting up to xTicksToWait.
+ * Must be called outside any critical section */
+static BaseType_t prvWaitOnSemaphore( MyQueueHandle_t pxMyQueue,
+                                      MySemaphoreHandle_t pxSemaphore,
+                                      size_t xUnits,
+                                      TickType_t xTicksToWait )
+{
+    #if ( configMYQUEUE_STATS == 1 )
+        TickType_t xWaitStart = xTaskGetTickCount();
+    #endif
 
-    configASSERT( pxMyQueue->pxEmptySemaphore );
-    configASSERT( pxMyQueue->pxFullSemaphore );
-    configASSERT( pxMyQueue->pxModifySemaphore );
+    BaseType_t xTaken = xMySemaphoreTakeN( pxSemaphore, xUnits, xTicksToWait );
 
-    vMySemaphoreDelete( pxMyQueue->pxEmptySemaphore );
-    vMySemaphoreDelete( pxMyQueue->pxFullSemaphore );
-    vMySemaphoreDelete( pxMyQueue->pxModifySemaphore );
+    #if ( configMYQUEUE_STATS == 1 )
+        prvStatsBlocked( pxMyQueue, ( pxSemaphore == pxMyQueue->pxEmptySemaphore ) ? pdTRUE : pdFALSE,
+                         xTaskGetTickCount() - xWaitStart, xTaken );
+    #else
+        ( void ) pxMyQueue;
+    #endif
+
+    return xTaken;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xMyQueueSendToBack( MyQueueHandle_t pxMyQueue,
-                               const void* pvItemToQueue,
-                               TickType_t xTicksToWait )
+/* Slot xSlots (no more than the ring holds) after pucSlot */
+static int8_t* prvNextSlot( MyQueueHandle_t pxMyQueue, int8_t* pucSlot, size_t xSlots )
 {
-    /* Get an empty slot to push an item */
-    if( xMySemaphoreTake( pxMyQueue->pxEmptySemaphore, xTicksToWait / 2 ) == pdTRUE )
+    size_t xOffset = ( size_t ) ( pucSlot - pxMyQueue->ucBufferBegin ) + xSlots * pxMyQueue->xSlotSize;
+
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
     {
-        /* Get mutually exclusive access */
-        if( xMySemaphoreTake( pxMyQueue->pxModifySemaphore, xTicksToWait / 2 ) == pdTRUE )
+        if( pxMyQueue->xRingMask != 0 )
         {
-            /* Write to ucTail and then increment ucTail */
-            memcpy( ( void* ) pxMyQueue->ucTail, pvItemToQueue, pxMyQueue->xItemSize );
+            return pxMyQueue->ucBufferBegin + ( xOffset & pxMyQueue->xRingMask );
+        }
+    }
+    #endif
 
-            pxMyQueue->ucTail += pxMyQueue->xItemSize;
-            if( pxMyQueue->ucTail == pxMyQueue->ucBufferEnd )
-            {
-                pxMyQueue->ucTail = pxMyQueue->ucBufferBegin;
-            }
+    size_t xRingSize = ( size_t ) ( pxMyQueue->ucBufferEnd - pxMyQueue->ucBufferBegin );
 
-            /* Done writing */
-            xMySemaphoreGive( pxMyQueue->pxModifySemaphore, portMAX_DELAY );
+    if( xOffset >= xRingSize )
+    {
+        xOffset -= xRingSize;
+    }
 
-            /* One more slot of the queue is now full */
-            xMySemaphoreGive( pxMyQueue->pxFullSemaphore, portMAX_DELAY );
+    return pxMyQueue->ucBufferBegin + xOffset;
+}
+/*-----------------------------------------------------------*/
 
-            return pdTRUE;
-        }
-        else
+/* Write to ucTail and then increment ucTail. Caller must hold a slot taken
+ * from pxEmptySemaphore and be inside a critical section */
+static void prvCopyToTail( MyQueueHandle_t pxMyQueue, const void* pvItemToQueue )
+{
+    memcpy( ( void* ) pxMyQueue->ucTail, pvItemToQueue, pxMyQueue->xItemSize );
+    pxMyQueue->ucTail = prvNextSlot( pxMyQueue, pxMyQueue->ucTail, 1 );
+}
+/*-----------------------------------------------------------*/
+
+/* Read from ucHead and then increment ucHead. Caller must hold a slot taken
+ * from pxFullSemaphore and be inside a critical section */
+static void prvCopyFromHead( MyQueueHandle_t pxMyQueue, void* pvBuffer )
+{
+    memcpy( pvBuffer, ( void* ) pxMyQueue->ucHead, pxMyQueue->xItemSize );
+    pxMyQueue->ucHead = prvNextSlot( pxMyQueue, pxMyQueue->ucHead, 1 );
+}
+/*-----------------------------------------------------------*/
+
+/* Write xItemCount items starting at ucTail, wrapping at most once. Caller
+ * must hold that many slots taken from pxEmptySemaphore and be inside a
+ * critical section */
+static void prvCopyBatchToTail( MyQueueHandle_t pxMyQueue,
+                                const void* pvItemsToQueue,
+                                size_t xItemCount )
+{
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+    {
+        if( pxMyQueue->xSlotSize != pxMyQueue->xItemSize )
         {
-            /* Take pxModifySemaphore failed so give back the empty slot we took */
-            xMySemaphoreGive( pxMyQueue->pxEmptySemaphore, portMAX_DELAY );
+            /* Padded slots are not contiguous, copy them one by one */
+            for( size_t x = 0; x < xItemCount; x++ )
+            {
+                prvCopyToTail( pxMyQueue, ( const int8_t* ) pvItemsToQueue + x * pxMyQueue->xItemSize );
+            }
+
+            return;
         }
     }
+    #endif
+
+    size_t xBytes = xItemCount * pxMyQueue->xItemSize;
+    size_t xFirst = ( size_t ) ( pxMyQueue->ucBufferEnd - pxMyQueue->ucTail );
+
+    if( xFirst > xBytes )
+    {
+        xFirst = xBytes;
+    }
+
+    memcpy( ( void* ) pxMyQueue->ucTail, pvItemsToQueue, xFirst );
+    pxMyQueue->ucTail += xFirst;
+
+    if( xFirst < xBytes )
+    {
+        memcpy( ( void* ) pxMyQueue->ucBufferBegin,
+                ( const int8_t* ) pvItemsToQueue + xFirst,
+                xBytes - xFirst );
+        pxMyQueue->ucTail = pxMyQueue->ucBufferBegin + ( xBytes - xFirst );
+    }
 
-    return errQUEUE_FULL;
+    if( pxMyQueue->ucTail == pxMyQueue->ucBufferEnd )
+    {
+        pxMyQueue->ucTail = pxMyQueue->ucBufferBegin;
+    }
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xMyQueueReceive( MyQueueHandle_t pxMyQueue,
-                            void* pvBuffer,
-                            TickType_t xTicksToWait )
+/* Read xItemCount items starting at ucHead, wrapping at most once. Caller
+ * must hold that many slots taken from pxFullSemaphore and be inside a
+ * critical section */
+static void prvCopyBatchFromHead( MyQueueHandle_t pxMyQueue,
+                                  void* pvBuffer,
+                                  size_t xItemCount )
 {
-    /* Get a full slot to pop an item */
-    if( xMySemaphoreTake( pxMyQueue->pxFullSemaphore, xTicksToWait / 2 ) == pdTRUE )
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
     {
-        /* Get mutual exclusive access */
-        if( xMySemaphoreTake( pxMyQueue->pxModifySemaphore, xTicksToWait / 2 ) == pdTRUE )
+        if( pxMyQueue->xSlotSize != pxMyQueue->xItemSize )
         {
-            /* Read from ucHead and then increment ucHead */
-            memcpy( pvBuffer, ( void* ) pxMyQueue->ucHead, pxMyQueue->xItemSize );
-
-            pxMyQueue->ucHead += pxMyQueue->xItemSize;
-            if( pxMyQueue->ucHead == pxMyQueue->ucBufferEnd )
+            for( size_t x = 0; x < xItemCount; x++ )
             {
-                pxMyQueue->ucHead = pxMyQueue->ucBufferBegin;
+                prvCopyFromHead( pxMyQueue, ( int8_t* ) pvBuffer + x * pxMyQueue->xItemSize );
             }
 
-            /* Done reading */
-            xMySemaphoreGive( pxMyQueue->pxModifySemaphore, portMAX_DELAY );
+            return;
+        }
+    }
+    #endif
 
-            /* One more slot of the queue is now empty */
-            xMySemaphoreGive( pxMyQueue->pxEmptySemaphore, portMAX_DELAY );
+    size_t xBytes = xItemCount * pxMyQueue->xItemSize;
+    size_t xFirst = ( size_t ) ( pxMyQueue->ucBufferEnd - pxMyQueue->ucHead );
 
-            return pdTRUE;
+    if( xFirst > xBytes )
+    {
+        xFirst = xBytes;
+    }
+
+    memcpy( pvBuffer, ( void* ) pxMyQueue->ucHead, xFirst );
+    pxMyQueue->ucHead += xFirst;
+
+    if( xFirst < xBytes )
+    {
+        memcpy( ( int8_t* ) pvBuffer + xFirst,
+                ( void* ) pxMyQueue->ucBufferBegin,
+                xBytes - xFirst );
+        pxMyQueue->ucHead = pxMyQueue->ucBufferBegin + ( xBytes - xFirst );
+    }
+
+    if( pxMyQueue->ucHead == pxMyQueue->ucBufferEnd )
+    {
+        pxMyQueue->ucHead = pxMyQueue->ucBufferBegin;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Take between one and xItemCount units of pxSemaphore, one of pxMyQueue's,
+ * for a batch, or exactly xItemCount if xWaitForAll is set. Must be called
+ * inside a critical section, which it leaves only while blocked. Returns
+ * either 0 or a count that satisfies the request */
+static size_t prvTakeBatch( MyQueueHandle_t pxMyQueue,
+                            MySemaphoreHandle_t pxSemaphore,
+                            size_t xItemCount,
+                            BaseType_t xWaitForAll,
+                            TickType_t xTicksToWait,
+                            BaseType_t* pxYieldRequired )
+{
+    if( xItemCount == 0 )
+    {
+        return 0;
+    }
+
+    if( xWaitForAll != pdFALSE )
+    {
+        if( xMySemaphoreTakeNFromCritical( pxSemaphore, xItemCount, pxYieldRequired ) == pdTRUE )
+        {
+            return xItemCount;
         }
-        else
+    }
+    else
+    {
+        size_t xTaken = uxMySemaphoreTakeUpToFromCritical( pxSemaphore, xItemCount, pxYieldRequired );
+
+        if( xTaken > 0 )
         {
-            /* Take pxModifySemaphore failed so give back the full slot we took */
-            xMySemaphoreGive( pxMyQueue->pxFullSemaphore, portMAX_DELAY );
+            return xTaken;
         }
     }
 
-    return errQUEUE_EMPTY;
+    if( xTicksToWait == 0 )
+    {
+        myqueueSTATS_GAVE_UP( pxMyQueue, ( pxSemaphore == pxMyQueue->pxEmptySemaphore ) ? pdTRUE : pdFALSE );
+        return 0;
+    }
+
+    /* Wait for everything we need in one request so two batches can never
+     * each hold part of what the other is waiting for */
+    size_t xNeeded = ( xWaitForAll != pdFALSE ) ? xItemCount : 1;
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    BaseType_t xTaken = prvWaitOnSemaphore( pxMyQueue, pxSemaphore, xNeeded, xTicksToWait );
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    if( xTaken == pdFALSE )
+    {
+        return 0;
+    }
+
+    /* Sweep up whatever else became available while we were waiting */
+    return xNeeded + uxMySemaphoreTakeUpToFromCritical( pxSemaphore, xItemCount - xNeeded, pxYieldRequired );
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xMyQueueSendToBackFromISR( MyQueueHandle_t pxMyQueue,
-                                      const void* pvItemToQueue,
-                                      BaseType_t* pxHigherPriorityTaskWoken )
+/* Make xItemCount freshly written items visible to receivers. Held back while
+ * a reserved slot ahead of them is still being filled. Must be called inside
+ * a critical section */
+static void prvPublishItems( MyQueueHandle_t pxMyQueue,
+                             size_t xItemCount,
+                             BaseType_t* pxYieldRequired )
 {
-    BaseType_t xStatus = errQUEUE_FULL;
+    if( pxMyQueue->pvReservedSlot != NULL )
+    {
+        pxMyQueue->uxUnpublishedItems += xItemCount;
+    }
+    else
+    {
+        ( void ) uxMySemaphoreGiveUpToFromCritical( pxMyQueue->pxFullSemaphore, xItemCount,
+                                                    pxYieldRequired );
+    }
+}
+/*-----------------------------------------------------------*/
 
-    /* Attempt to take pxModifySemaphore without waiting. Taking
-     * pxModifySemaphore should not awaken any givers since the giver of
-     * pxModifySemaphore is always the taker so it always succeeds and never
-     * waits so pxHigherPriorityTaskWoken parameter is irrelevant here */
-    if( xMySemaphoreTakeFromISR( pxMyQueue->pxModifySemaphore, NULL ) == pdTRUE )
+/* Hand xItemCount freshly read slots back to senders. Held back while a
+ * peeked slot behind them is still being read. Must be called inside a
+ * critical section */
+static void prvReleaseSlots( MyQueueHandle_t pxMyQueue,
+                             size_t xItemCount,
+                             BaseType_t* pxYieldRequired )
+{
+    if( pxMyQueue->pvPeekedSlot != NULL )
+    {
+        pxMyQueue->uxUnreleasedSlots += xItemCount;
+    }
+    else
     {
-        /* We can assume that what happens in this block occurs atomically
-         * since only other interrupts can interrupt this function but they
-         * would not be able to acquire pxModifySemaphore */
+        ( void ) uxMySemaphoreGiveUpToFromCritical( pxMyQueue->pxEmptySemaphore, xItemCount,
+                                                    pxYieldRequired );
+    }
+}
+/*-----------------------------------------------------------*/
 
-        /* Take and give functions may notify other tasks so we should not call
-         * take and give unless we are confident they will succeed */
-        if( xMySemaphoreTakeAvailableFromISR( pxMyQueue->pxEmptySemaphore ) == pdTRUE &&
-            xMySemaphoreGiveAvailableFromISR( pxMyQueue->pxFullSemaphore ) == pdTRUE )
-        {
-            BaseType_t EmptyWoken = pdFALSE;
-            BaseType_t FullWoken = pdFALSE;
+/* If the task the next item would be handed to is blocked in xMyQueueReceive,
+ * copy pvItemToQueue straight into its buffer and wake it, bypassing the
+ * ring. Must be called inside a critical section */
+static BaseType_t prvHandoffToReceiver( MyQueueHandle_t pxMyQueue,
+                                        const void* pvItemToQueue,
+                                        BaseType_t* pxYieldRequired )
+{
+    /* Items held back behind a reserved slot must be received first */
+    if( pxMyQueue->pxHandoffReceivers == NULL || pxMyQueue->pvReservedSlot != NULL )
+    {
+        return pdFALSE;
+    }
 
-            /* Take pxEmptySemaphore to push an item and ensure it succeeds */
-            configASSERT( xMySemaphoreTakeFromISR( pxMyQueue->pxEmptySemaphore, &EmptyWoken ) == pdTRUE );
+    /* A waiting taker means every item in the ring is already claimed, so
+     * handing this one over cannot overtake anything */
+    TaskHandle_t xNextTaker = xMySemaphoreGetNextTakerFromCritical( pxMyQueue->pxFullSemaphore );
+    MyQueueReceiver_t** ppxReceiver = &( pxMyQueue->pxHandoffReceivers );
 
-            /* Write to ucTail and then increment ucTail */
-            memcpy( ( void* ) pxMyQueue->ucTail, pvItemToQueue, pxMyQueue->xItemSize );
+    while( *ppxReceiver != NULL && ( *ppxReceiver )->xTask != xNextTaker )
+    {
+        ppxReceiver = &( ( *ppxReceiver )->pxNext );
+    }
 
-            pxMyQueue->ucTail += pxMyQueue->xItemSize;
-            if( pxMyQueue->ucTail == pxMyQueue->ucBufferEnd )
-            {
-                pxMyQueue->ucTail = pxMyQueue->ucBufferBegin;
-            }
+    /* Next taker is a batch receive or a peek, which need the ring */
+    if( xNextTaker == NULL || *ppxReceiver == NULL )
+    {
+        return pdFALSE;
+    }
 
-            /* Give pxEmptySemaphore to signal that an item has been pushed and
-             * ensure it succeeds */
-            configASSERT( xMySemaphoreGiveFromISR( pxMyQueue->pxFullSemaphore, &FullWoken ) == pdTRUE );
+    MyQueueReceiver_t* pxReceiver = *ppxReceiver;
+    *ppxReceiver = pxReceiver->pxNext;
 
-            /* Set pxHigherPriorityTaskWoken indicator if not NULL */
-            if( pxHigherPriorityTaskWoken != NULL )
-            {
-                *pxHigherPriorityTaskWoken =
-                    ( ( EmptyWoken == pdTRUE ) || ( FullWoken == pdTRUE ) ) ? pdTRUE : pdFALSE;
-            }
+    memcpy( pxReceiver->pvBuffer, pvItemToQueue, pxMyQueue->xItemSize );
+    pxReceiver->xDelivered = pdTRUE;
+    myqueueSTATS_RECEIVED( pxMyQueue, 1 );
 
-            /* Send was successful */
-            xStatus = pdTRUE;
-        }
+    /* Wakes xNextTaker. The unit it is handed stands for the item it already
+     * has, so neither semaphore count changes */
+    ( void ) xMySemaphoreGiveFromCritical( pxMyQueue->pxFullSemaphore, pxYieldRequired );
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Number of free slots (xForSpace set) or of queued items in an SPSC queue */
+static UBaseType_t prvSPSCAvailable( MyQueueHandle_t pxMyQueue, BaseType_t xForSpace )
+{
+    UBaseType_t uxItems = pxMyQueue->uxItemsSent - pxMyQueue->uxItemsReceived;
 
-        /* Done modifying. Should always succeed */
-        configASSERT( xMySemaphoreGiveFromISR( pxMyQueue->pxModifySemaphore, NULL ) == pdTRUE );
+    return ( xForSpace != pdFALSE ) ? pxMyQueue->uxLength - uxItems : uxItems;
+}
+/*-----------------------------------------------------------*/
+
+/* Write up to xItemCount items to an SPSC queue without waiting. Only the
+ * single producer may call this */
+static size_t prvSPSCPush( MyQueueHandle_t pxMyQueue,
+                           const void* pvItemsToQueue,
+                           size_t xItemCount )
+{
+    size_t xSpace = prvSPSCAvailable( pxMyQueue, pdTRUE );
+    size_t xPushed = ( xSpace < xItemCount ) ? xSpace : xItemCount;
+
+    if( xPushed > 0 )
+    {
+        /* Do not touch the slots until we have seen the consumer free them */
+        myqueueMEMORY_BARRIER();
+        prvCopyBatchToTail( pxMyQueue, pvItemsToQueue, xPushed );
+
+        /* Publish the items only once they are completely written */
+        myqueueMEMORY_BARRIER();
+        pxMyQueue->uxItemsSent += xPushed;
     }
 
-    return xStatus;
+    return xPushed;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xMyQueueReceiveFromISR( MyQueueHandle_t pxMyQueue,
-                                   void* pvBuffer,
-                                   BaseType_t* pxHigherPriorityTaskWoken )
+/* Read up to xItemCount items from an SPSC queue without waiting. Only the
+ * single consumer may call this */
+static size_t prvSPSCPop( MyQueueHandle_t pxMyQueue,
+                          void* pvBuffer,
+                          size_t xItemCount )
 {
-    BaseType_t xStatus = errQUEUE_EMPTY;
+    size_t xItems = prvSPSCAvailable( pxMyQueue, pdFALSE );
+    size_t xPopped = ( xItems < xItemCount ) ? xItems : xItemCount;
 
-    /* Attempt to take pxModifySemaphore without waiting. Taking
-     * pxModifySemaphore should not awaken any givers since the giver of
-     * pxModifySemaphore is always the taker so it always succeeds and never
-     * waits so pxHigherPriorityTaskWoken parameter is irrelevant here */
-    if( xMySemaphoreTakeFromISR( pxMyQueue->pxModifySemaphore, NULL ) == pdTRUE )
+    if( xPopped > 0 )
     {
-        /* We can assume that what happens in this block occurs atomically
-         * since only other interrupts can interrupt this function but they
-         * would not be able to acquire pxModifySemaphore */
+        /* Do not touch the slots until we have seen the producer fill them */
+        myqueueMEMORY_BARRIER();
+        prvCopyBatchFromHead( pxMyQueue, pvBuffer, xPopped );
 
-        /* Take and give functions may notify other tasks so we should not call
-         * take and give unless we are confident they will succeed */
-        if( xMySemaphoreTakeAvailableFromISR( pxMyQueue->pxFullSemaphore ) == pdTRUE &&
-            xMySemaphoreGiveAvailableFromISR( pxMyQueue->pxEmptySemaphore ) == pdTRUE )
-        {
-            BaseType_t FullWoken = pdFALSE;
-            BaseType_t EmptyWoken = pdFALSE;
+        /* Hand the slots back only once we are done reading them */
+        myqueueMEMORY_BARRIER();
+        pxMyQueue->uxItemsReceived += xPopped;
+    }
+
+    return xPopped;
+}
+/*-----------------------------------------------------------*/
 
-            /* Take pxFullSemaphore to push an item and ensure it succeeds */
-            configASSERT( xMySemaphoreTakeFromISR( pxMyQueue->pxFullSemaphore, &FullWoken ) == pdTRUE );
+/* Clear *pxWaiter and return the task that was parked in it, or NULL. The
+ * atomic.h swap only masks interrupts on the calling core, so with more than
+ * one core it is done under the queue's lock instead */
+static TaskHandle_t prvSPSCClaimWaiter( MyQueueHandle_t pxMyQueue,
+                                        TaskHandle_t volatile* pxWaiter )
+{
+    #if ( configNUMBER_OF_CORES > 1 )
+    {
+        vMySemaphoreLock( &( pxMyQueue->xLock ) );
+        TaskHandle_t xWaiter = *pxWaiter;
+        *pxWaiter = NULL;
+        vMySemaphoreUnlock( &( pxMyQueue->xLock ) );
 
-            /* Read from ucHead and then increment ucHead */
-            memcpy( pvBuffer, ( void* ) pxMyQueue->ucHead, pxMyQueue->xItemSize );
+        return xWaiter;
+    }
+    #else
+    {
+        ( void ) pxMyQueue;
 
-            pxMyQueue->ucHead += pxMyQueue->xItemSize;
-            if( pxMyQueue->ucHead == pxMyQueue->ucBufferEnd )
-            {
-                pxMyQueue->ucHead = pxMyQueue->ucBufferBegin;
-            }
+        return Atomic_SwapPointers_p32( ( void* volatile* ) pxWaiter, NULL );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+/* Park the calling task in *pxWaiter until the other side of an SPSC queue
+ * makes progress. Returns pdFALSE once the timeout has expired, otherwise the
+ * caller should re-check the queue and call again if it still cannot move */
+static BaseType_t prvSPSCWait( MyQueueHandle_t pxMyQueue,
+                               TaskHandle_t volatile* pxWaiter,
+                               BaseType_t xForSpace,
+                               size_t xNeeded,
+                               TimeOut_t* pxTimeOut,
+                               TickType_t* pxTicksToWait )
+{
+    if( xTaskCheckForTimeOut( pxTimeOut, pxTicksToWait ) != pdFALSE )
+    {
+        return pdFALSE;
+    }
 
-            /* Give pxEmptySemaphore to signal that an item has been pushed and
-             * ensure it succeeds */
-            configASSERT( xMySemaphoreGiveFromISR( pxMyQueue->pxEmptySemaphore, &EmptyWoken ) == pdTRUE );
+    TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+    BaseType_t xNotified = pdFALSE;
 
-            /* Set pxHigherPriorityTaskWoken indicator if not NULL */
-            if( pxHigherPriorityTaskWoken != NULL )
-            {
-                *pxHigherPriorityTaskWoken =
-                    ( ( FullWoken == pdTRUE ) || ( EmptyWoken == pdTRUE ) ) ? pdTRUE : pdFALSE;
-            }
+    *pxWaiter = xSelf;
 
-            /* Receive was successful */
-            xStatus = pdTRUE;
-        }
+    /* Re-check after announcing ourselves. Pairs with the barrier in
+     * prvSPSCWake, so either the other side sees us or we see its update */
+    myqueueMEMORY_BARRIER();
 
-        /* Done modifying. Should always succeed */
-        xMySemaphoreGiveFromISR( pxMyQueue->pxModifySemaphore, NULL );
+    if( prvSPSCAvailable( pxMyQueue, xForSpace ) < xNeeded )
+    {
+        xNotified = ( ulTaskNotifyTakeIndexed( configMYSEMAPHORE_NOTIFICATION_INDEX,
+                                               pdTRUE, *pxTicksToWait ) != 0 ) ? pdTRUE : pdFALSE;
     }
 
-    return xStatus;
+    /* Withdraw. If the other side already claimed us, its notification is
+     * pending or on its way and must be absorbed now so it cannot cut a later
+     * wait short */
+    if( prvSPSCClaimWaiter( pxMyQueue, pxWaiter ) == NULL && xNotified == pdFALSE )
+    {
+        ( void ) ulTaskNotifyTakeIndexed( configMYSEMAPHORE_NOTIFICATION_INDEX, pdTRUE, portMAX_DELAY );
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Wake the task parked in *pxWaiter, if any. The kernel is only entered when
+ * there actually is a waiter */
+static void prvSPSCWake( MyQueueHandle_t pxMyQueue,
+                         TaskHandle_t volatile* pxWaiter )
+{
+    myqueueMEMORY_BARRIER();
+
+    if( *pxWaiter != NULL )
+    {
+        TaskHandle_t xWaiter = prvSPSCClaimWaiter( pxMyQueue, pxWaiter );
+
+        if( xWaiter != NULL )
+        {
+            ( void ) xTaskNotifyGiveIndexed( xWaiter, configMYSEMAPHORE_NOTIFICATION_INDEX );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSPSCWakeFromISR( MyQueueHandle_t pxMyQueue,
+                                TaskHandle_t volatile* pxWaiter,
+                                BaseType_t* pxHigherPriorityTaskWoken )
+{
+    myqueueMEMORY_BARRIER();
+
+    if( *pxWaiter != NULL )
+    {
+        TaskHandle_t xWaiter = prvSPSCClaimWaiter( pxMyQueue, pxWaiter );
+
+        if( xWaiter != NULL )
+        {
+            vTaskNotifyGiveIndexedFromISR( xWaiter, configMYSEMAPHORE_NOTIFICATION_INDEX,
+                                           pxHigherPriorityTaskWoken );
+        }
+    }
 }
+/*-----------------------------------------------------------*/
+
+/* Wait until an SPSC queue has at least xNeeded free slots (xForSpace set)
+ * or queued items. Returns pdFALSE if xTicksToWait expires first */
+static BaseType_t prvSPSCWaitFor( MyQueueHandle_t pxMyQueue,
+                                  BaseType_t xForSpace,
+                                  size_t xNeeded,
+                                  TickType_t xTicksToWait )
+{
+    if( prvSPSCAvailable( pxMyQueue, xForSpace ) >= xNeeded )
+    {
+        return pdTRUE;
+    }
+
+    if( xTicksToWait == 0 )
+    {
+        myqueueSTATS_GAVE_UP( pxMyQueue, xForSpace );
+        return pdFALSE;
+    }
+
+    TaskHandle_t volatile* pxWaiter = ( xForSpace != pdFALSE ) ?
+                                      &( pxMyQueue->xWaitingSender ) :
+                                      &( pxMyQueue->xWaitingReceiver );
+    TimeOut_t xTimeOut;
+    BaseType_t xAvailable = pdTRUE;
+
+    #if ( configMYQUEUE_STATS == 1 )
+        TickType_t xWaitStart = xTaskGetTickCount();
+    #endif
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    do
+    {
+        if( prvSPSCWait( pxMyQueue, pxWaiter, xForSpace, xNeeded,
+                         &xTimeOut, &xTicksToWait ) == pdFALSE )
+        {
+            xAvailable = pdFALSE;
+            break;
+        }
+    } while( prvSPSCAvailable( pxMyQueue, xForSpace ) < xNeeded );
+
+    #if ( configMYQUEUE_STATS == 1 )
+        prvStatsBlocked( pxMyQueue, xForSpace, xTaskGetTickCount() - xWaitStart, xAvailable );
+    #endif
+
+    return xAvailable;
+}
+/*-----------------------------------------------------------*/
+
+/* Task level SPSC send. Same blocking semantics as xMyQueueSendToBackBatch */
+static size_t prvSPSCSend( MyQueueHandle_t pxMyQueue,
+                           const void* pvItemsToQueue,
+                           size_t xItemCount,
+                           BaseType_t xWaitForAll,
+                           TickType_t xTicksToWait )
+{
+    size_t xNeeded = ( xWaitForAll != pdFALSE ) ? xItemCount : 1;
+
+    if( xItemCount == 0 ||
+        prvSPSCWaitFor( pxMyQueue, pdTRUE, xNeeded, xTicksToWait ) == pdFALSE )
+    {
+        return 0;
+    }
+
+    size_t xSent = prvSPSCPush( pxMyQueue, pvItemsToQueue, xItemCount );
+    myqueueSTATS_SENT( pxMyQueue, xSent );
+    prvSPSCWake( pxMyQueue, &( pxMyQueue->xWaitingReceiver ) );
+
+    return xSent;
+}
+/*-----------------------------------------------------------*/
+
+/* Task level SPSC receive. Same blocking semantics as xMyQueueReceiveBatch */
+static size_t prvSPSCReceive( MyQueueHandle_t pxMyQueue,
+                              void* pvBuffer,
+                              size_t xItemCount,
+                              BaseType_t xWaitForAll,
+                              TickType_t xTicksToWait )
+{
+    size_t xNeeded = ( xWaitForAll != pdFALSE ) ? xItemCount : 1;
+
+    if( xItemCount == 0 ||
+        prvSPSCWaitFor( pxMyQueue, pdFALSE, xNeeded, xTicksToWait ) == pdFALSE )
+    {
+        return 0;
+    }
+
+    size_t xReceived = prvSPSCPop( pxMyQueue, pvBuffer, xItemCount );
+    myqueueSTATS_RECEIVED( pxMyQueue, xReceived );
+    prvSPSCWake( pxMyQueue, &( pxMyQueue->xWaitingSender ) );
+
+    return xReceived;
+}
+/*-----------------------------------------------------------*/
+
+/* Set up a queue whose storage area of uxSlotCount slots of xSlotSize bytes
+ * each starts at pucQueueStorage */
+static void prvInitialiseMyQueue( MyQueueHandle_t pxNewQueue,
+                                  UBaseType_t uxQueueLength,
+                                  UBaseType_t uxItemSize,
+                                  uint8_t* pucQueueStorage,
+                                  size_t xSlotSize,
+                                  size_t xSlotCount,
+                                  BaseType_t xIsSPSC,
+                                  BaseType_t xIsVariableLength )
+{
+    pxNewQueue->xIsSPSC = xIsSPSC;
+    pxNewQueue->xIsVariableLength = xIsVariableLength;
+    pxNewQueue->uxItemsSent = 0;
+    pxNewQueue->uxItemsReceived = 0;
+    pxNewQueue->xWaitingSender = NULL;
+    pxNewQueue->xWaitingReceiver = NULL;
+    pxNewQueue->pvReservedSlot = NULL;
+    pxNewQueue->pvPeekedSlot = NULL;
+    pxNewQueue->uxUnpublishedItems = 0;
+    pxNewQueue->uxUnreleasedSlots = 0;
+    pxNewQueue->pxHandoffReceivers = NULL;
+
+    #if ( configNUMBER_OF_CORES > 1 )
+    {
+        pxNewQueue->xLock.ulLocked = 0U;
+    }
+    #endif
+
+    #if ( configMYQUEUE_STATS == 1 )
+    {
+        ( void ) memset( &( pxNewQueue->xStats ), 0x00, sizeof( MyQueueStats_t ) );
+    }
+    #endif
+
+    /* Initialize semaphores in place. SPSC queues do not use any */
+    if( xIsSPSC == pdFALSE )
+    {
+        pxNewQueue->pxEmptySemaphore = pxMySemaphoreCreateStatic( uxQueueLength, uxQueueLength,
+                                                                  &( pxNewQueue->xEmptySemaphoreBuffer ) );
+        /* Every message takes at least its length header */
+        UBaseType_t uxMaxItems = ( xIsVariableLength != pdFALSE ) ?
+                                 uxQueueLength / myqueueMESSAGE_HEADER_SIZE :
+                                 uxQueueLength;
+
+        pxNewQueue->pxFullSemaphore = pxMySemaphoreCreateStatic( uxMaxItems, 0,
+                                                                 &( pxNewQueue->xFullSemaphoreBuffer ) );
+
+        #if ( configNUMBER_OF_CORES > 1 )
+        {
+            /* Queue operations move units of both under the queue's lock */
+            vMySemaphoreShareLock( pxNewQueue->pxEmptySemaphore, &( pxNewQueue->xLock ) );
+            vMySemaphoreShareLock( pxNewQueue->pxFullSemaphore, &( pxNewQueue->xLock ) );
+        }
+        #endif
+    }
+    else
+    {
+        pxNewQueue->pxEmptySemaphore = NULL;
+        pxNewQueue->pxFullSemaphore = NULL;
+    }
+
+    pxNewQueue->uxLength = uxQueueLength;
+    pxNewQueue->xItemSize = uxItemSize;
+    pxNewQueue->xSlotSize = xSlotSize;
+
+    pxNewQueue->ucBufferBegin = ( int8_t* ) pucQueueStorage;
+    pxNewQueue->ucBufferEnd = pxNewQueue->ucBufferBegin + xSlotCount * xSlotSize;
+
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+    {
+        size_t xRingSize = xSlotCount * xSlotSize;
+
+        pxNewQueue->xRingMask = ( xRingSize > 0 && ( xRingSize & ( xRingSize - 1 ) ) == 0 ) ?
+                                xRingSize - 1 : 0;
+    }
+    #endif
+
+    pxNewQueue->ucHead = pxNewQueue->ucBufferBegin;
+    pxNewQueue->ucTail = pxNewQueue->ucBufferBegin;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+
+    /* Smallest power of two not below x, or 0 if there is none */
+    static size_t prvRoundUpToPowerOfTwo( size_t x )
+    {
+        size_t xPower = 1;
+
+        while( xPower < x && xPower != 0 )
+        {
+            xPower <<= 1;
+        }
+
+        return xPower;
+    }
+
+#endif /* configMYQUEUE_CACHE_LINE_SIZE */
+/*-----------------------------------------------------------*/
+
+/* Allocate the queue and its storage area as one block */
+static MyQueueHandle_t prvMyQueueCreate( UBaseType_t xQueueLength,
+                                         UBaseType_t xItemSize,
+                                         BaseType_t xIsSPSC,
+                                         BaseType_t xIsVariableLength )
+{
+    MyQueueHandle_t pxNewQueue = NULL;
+    size_t xSlotSize = xItemSize;
+    size_t xSlotCount = xQueueLength;
+    size_t xAlignMask = 0;
+
+    #if ( configMYQUEUE_CACHE_LINE_SIZE > 0 )
+    {
+        /* Items get slots of whole cache lines in a ring of a power of two
+         * slots, so neighbouring items never share a line and wrapping is a
+         * mask. Messages are packed as their records already vary in size */
+        if( xIsVariableLength == pdFALSE && xItemSize > 0 )
+        {
+            xSlotSize = prvRoundUpToPowerOfTwo( ( xItemSize > configMYQUEUE_CACHE_LINE_SIZE ) ?
+                                                xItemSize : configMYQUEUE_CACHE_LINE_SIZE );
+            xSlotCount = prvRoundUpToPowerOfTwo( xQueueLength );
+            xAlignMask = configMYQUEUE_CACHE_LINE_SIZE - 1;
+        }
+    }
+    #endif
+
+    if( xQueueLength > 0 &&
+        /* Check for overflow */
+        xSlotSize >= xItemSize && xSlotCount >= xQueueLength &&
+        ( SIZE_MAX / xSlotCount ) >= xSlotSize &&
+        ( ( size_t ) ( SIZE_MAX - sizeof( MyQueue_t ) - xAlignMask ) ) >= ( xSlotCount * xSlotSize ) )
+    {
+        size_t xQueueSizeBytes = sizeof( MyQueue_t ) + xAlignMask + xSlotCount * xSlotSize;
+        pxNewQueue = pvPortMalloc( xQueueSizeBytes );
+
+        if( pxNewQueue == NULL )
+        {
+            return NULL;
+        }
+
+        /* Storage area starts right after the queue structure, on the next
+         * cache line if slots are padded */
+        uint8_t* pucQueueStorage = ( ( uint8_t* ) pxNewQueue ) + sizeof( MyQueue_t );
+        pucQueueStorage += ( ( size_t ) 0 - ( size_t ) ( portPOINTER_SIZE_TYPE ) pucQueueStorage ) & xAlignMask;
+
+        prvInitialiseMyQueue( pxNewQueue, xQueueLength, xItemSize, pucQueueStorage,
+                              xSlotSize, xSlotCount, xIsSPSC, xIsVariableLength );
+        pxNewQueue->ucStaticallyAllocated = pdFALSE;
+    }
+
+    return pxNewQueue;
+}
+/*-----------------------------------------------------------*/
+
+MyQueueHandle_t pxMyQueueCreate( UBaseType_t xQueueLength, UBaseType_t xItemSize )
+{
+    return prvMyQueueCreate( xQueueLength, xItemSize, pdFALSE, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+MyQueueHandle_t pxMyQueueCreateSPSC( UBaseType_t xQueueLength, UBaseType_t xItemSize )
+{
+    return prvMyQueueCreate( xQueueLength, xItemSize, pdTRUE, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+MyQueueHandle_t pxMyQueueCreateVariable( size_t xBufferSizeBytes )
+{
+    /* Whole headers only, so a header never straddles the end of the ring */
+    size_t xLength = xBufferSizeBytes - ( xBufferSizeBytes % myqueueMESSAGE_HEADER_SIZE );
+
+    /* Room for at least one header and one byte of message */
+    configASSERT( xLength >= 2 * myqueueMESSAGE_HEADER_SIZE );
+
+    return prvMyQueueCreate( ( UBaseType_t ) xLength, 1, pdFALSE, pdTRUE );
+}
+/*-----------------------------------------------------------*/
+
+MyQueueHandle_t xMyQueueCreateStatic( UBaseType_t xQueueLength,
+                                      UBaseType_t xItemSize,
+                                      uint8_t* pucQueueStorage,
+                                      StaticMyQueue_t* pxStaticQueue )
+{
+    configASSERT( pxStaticQueue );
+    /* A storage area is needed unless the items are empty */
+    configASSERT( pucQueueStorage != NULL || xItemSize == 0 );
+
+    #if ( configASSERT_DEFINED == 1 )
+    {
+        /* StaticMyQueue_t must stay in step with MyQueue_t */
+        volatile size_t xSize = sizeof( StaticMyQueue_t );
+        configASSERT( xSize == sizeof( MyQueue_t ) );
+        ( void ) xSize;
+    }
+    #endif
+
+    if( xQueueLength == 0 || pxStaticQueue == NULL ||
+        ( pucQueueStorage == NULL && xItemSize != 0 ) )
+    {
+        return NULL;
+    }
+
+    MyQueueHandle_t pxNewQueue = ( MyQueueHandle_t ) pxStaticQueue;
+
+    prvInitialiseMyQueue( pxNewQueue, xQueueLength, xItemSize, pucQueueStorage,
+                          xItemSize, xQueueLength, pdFALSE, pdFALSE );
+    pxNewQueue->ucStaticallyAllocated = pdTRUE;
+
+    return pxNewQueue;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configMYQUEUE_STATS == 1 )
+
+    void vMyQueueGetStats( MyQueueHandle_t pxMyQueue,
+                           MyQueueStats_t* pxStats )
+    {
+        configASSERT( pxMyQueue );
+        configASSERT( pxStats );
+
+        myqueueENTER_CRITICAL( pxMyQueue );
+        *pxStats = pxMyQueue->xStats;
+        myqueueEXIT_CRITICAL( pxMyQueue );
+    }
+
+#endif /* configMYQUEUE_STATS */
+/*-----------------------------------------------------------*/
+
+void vMyQueueDelete( MyQueueHandle_t pxMyQueue ) {
+    configASSERT( pxMyQueue );
+
+    /* The semaphores and the storage area live in the same block as the
+     * queue so there is nothing else to free */
+    if( pxMyQueue->ucStaticallyAllocated == pdFALSE )
+    {
+        vPortFree( pxMyQueue );
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMyQueueSendToBack( MyQueueHandle_t pxMyQueue,
+                               const void* pvItemToQueue,
+                               TickType_t xTicksToWait )
+{
+    configASSERT( pxMyQueue );
+    /* Variable length queues only take messages */
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        return ( prvSPSCSend( pxMyQueue, pvItemToQueue, 1, pdTRUE, xTicksToWait ) == 1 ) ?
+               pdTRUE : errQUEUE_FULL;
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    /* Fast path: hand the item to a blocked receiver, or claim an empty slot
+     * and write it, without ever leaving the critical section */
+    if( xMyQueueSendToBackFromCritical( pxMyQueue, pvItemToQueue, &xYieldRequired ) == errQUEUE_FULL )
+    {
+        if( xTicksToWait == 0 )
+        {
+            myqueueSTATS_GAVE_UP( pxMyQueue, pdTRUE );
+            myqueueEXIT_CRITICAL( pxMyQueue );
+            return errQUEUE_FULL;
+        }
+
+        myqueueEXIT_CRITICAL( pxMyQueue );
+
+        /* Queue is full so fall back to blocking on pxEmptySemaphore. A
+         * successful take reserves an empty slot for this task */
+        if( prvWaitOnSemaphore( pxMyQueue, pxMyQueue->pxEmptySemaphore, 1, xTicksToWait ) == pdFALSE )
+        {
+            return errQUEUE_FULL;
+        }
+
+        myqueueENTER_CRITICAL( pxMyQueue );
+
+        prvCopyToTail( pxMyQueue, pvItemToQueue );
+        prvPublishItems( pxMyQueue, 1, &xYieldRequired );
+        myqueueSTATS_SENT( pxMyQueue, 1 );
+    }
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMyQueueReceive( MyQueueHandle_t pxMyQueue,
+                            void* pvBuffer,
+                            TickType_t xTicksToWait )
+{
+    configASSERT( pxMyQueue );
+    /* Variable length queues only take messages */
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        return ( prvSPSCReceive( pxMyQueue, pvBuffer, 1, pdTRUE, xTicksToWait ) == 1 ) ?
+               pdTRUE : errQUEUE_EMPTY;
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+
+    /* Fast path: claim a full slot, read the item and hand the freed slot
+     * to any waiting sender without ever leaving the critical section */
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    if( xMySemaphoreTakeFromCritical( pxMyQueue->pxFullSemaphore, &xYieldRequired ) == pdFALSE )
+    {
+        if( xTicksToWait == 0 )
+        {
+            myqueueSTATS_GAVE_UP( pxMyQueue, pdFALSE );
+            myqueueEXIT_CRITICAL( pxMyQueue );
+            return errQUEUE_EMPTY;
+        }
+
+        /* Let senders deliver straight into pvBuffer while we are blocked */
+        MyQueueReceiver_t xReceiver;
+        xReceiver.xTask = xTaskGetCurrentTaskHandle();
+        xReceiver.pvBuffer = pvBuffer;
+        xReceiver.xDelivered = pdFALSE;
+        xReceiver.pxNext = pxMyQueue->pxHandoffReceivers;
+        pxMyQueue->pxHandoffReceivers = &xReceiver;
+
+        myqueueEXIT_CRITICAL( pxMyQueue );
+
+        /* Queue is empty so fall back to blocking on pxFullSemaphore. A
+         * successful take reserves a full slot for this task */
+        BaseType_t xTaken = prvWaitOnSemaphore( pxMyQueue, pxMyQueue->pxFullSemaphore, 1, xTicksToWait );
+
+        /* The sender already unlinked us and copied the item, so there is
+         * nothing left to do */
+        if( xReceiver.xDelivered != pdFALSE )
+        {
+            return pdTRUE;
+        }
+
+        myqueueENTER_CRITICAL( pxMyQueue );
+
+        if( xReceiver.xDelivered == pdFALSE )
+        {
+            MyQueueReceiver_t** ppxReceiver = &( pxMyQueue->pxHandoffReceivers );
+
+            while( *ppxReceiver != &xReceiver )
+            {
+                ppxReceiver = &( ( *ppxReceiver )->pxNext );
+            }
+
+            *ppxReceiver = xReceiver.pxNext;
+        }
+
+        if( xReceiver.xDelivered != pdFALSE || xTaken == pdFALSE )
+        {
+            myqueueEXIT_CRITICAL( pxMyQueue );
+            return ( xReceiver.xDelivered != pdFALSE ) ? pdTRUE : errQUEUE_EMPTY;
+        }
+    }
+
+    prvCopyFromHead( pxMyQueue, pvBuffer );
+    prvReleaseSlots( pxMyQueue, 1, &xYieldRequired );
+    myqueueSTATS_RECEIVED( pxMyQueue, 1 );
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMyQueueSendToBackFromISR( MyQueueHandle_t pxMyQueue,
+                                      const void* pvItemToQueue,
+                                      BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMyQueue );
+    /* Variable length queues only take messages */
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        if( prvSPSCPush( pxMyQueue, pvItemToQueue, 1 ) == 0 )
+        {
+            myqueueSTATS_GAVE_UP( pxMyQueue, pdTRUE );
+            return errQUEUE_FULL;
+        }
+
+        myqueueSTATS_SENT( pxMyQueue, 1 );
+        prvSPSCWakeFromISR( pxMyQueue, &( pxMyQueue->xWaitingReceiver ), pxHigherPriorityTaskWoken );
+        return pdTRUE;
+    }
+
+    /* Check for room, copy the item and wake a waiting receiver all with
+     * interrupts masked once, so a nested ISR can never see the queue half
+     * updated */
+    UBaseType_t uxSavedInterruptStatus = myqueueENTER_CRITICAL_FROM_ISR( pxMyQueue );
+    BaseType_t xStatus = xMyQueueSendToBackFromCritical( pxMyQueue, pvItemToQueue,
+                                                         pxHigherPriorityTaskWoken );
+
+    if( xStatus == errQUEUE_FULL )
+    {
+        myqueueSTATS_GAVE_UP( pxMyQueue, pdTRUE );
+    }
+
+    myqueueEXIT_CRITICAL_FROM_ISR( pxMyQueue, uxSavedInterruptStatus );
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMyQueueSendToBackFromCritical( MyQueueHandle_t pxMyQueue,
+                                           const void* pvItemToQueue,
+                                           BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pxMyQueue->xIsSPSC == pdFALSE );
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    /* Fastest path: a receiver is already blocked waiting, so give it the
+     * item directly without going through the ring */
+    if( prvHandoffToReceiver( pxMyQueue, pvItemToQueue, pxHigherPriorityTaskWoken ) == pdFALSE )
+    {
+        if( xMySemaphoreTakeFromCritical( pxMyQueue->pxEmptySemaphore,
+                                          pxHigherPriorityTaskWoken ) == pdFALSE )
+        {
+            return errQUEUE_FULL;
+        }
+
+        prvCopyToTail( pxMyQueue, pvItemToQueue );
+        prvPublishItems( pxMyQueue, 1, pxHigherPriorityTaskWoken );
+    }
+
+    myqueueSTATS_SENT( pxMyQueue, 1 );
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMyQueueReceiveFromISR( MyQueueHandle_t pxMyQueue,
+                                   void* pvBuffer,
+                                   BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMyQueue );
+    /* Variable length queues only take messages */
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        if( prvSPSCPop( pxMyQueue, pvBuffer, 1 ) == 0 )
+        {
+            myqueueSTATS_GAVE_UP( pxMyQueue, pdFALSE );
+            return errQUEUE_EMPTY;
+        }
+
+        myqueueSTATS_RECEIVED( pxMyQueue, 1 );
+        prvSPSCWakeFromISR( pxMyQueue, &( pxMyQueue->xWaitingSender ), pxHigherPriorityTaskWoken );
+        return pdTRUE;
+    }
+
+    BaseType_t xStatus = pdTRUE;
+
+    /* Same as the send, one interrupt masked section for the whole receive */
+    UBaseType_t uxSavedInterruptStatus = myqueueENTER_CRITICAL_FROM_ISR( pxMyQueue );
+
+    if( xMySemaphoreTakeFromCritical( pxMyQueue->pxFullSemaphore,
+                                      pxHigherPriorityTaskWoken ) == pdFALSE )
+    {
+        xStatus = errQUEUE_EMPTY;
+        myqueueSTATS_GAVE_UP( pxMyQueue, pdFALSE );
+    }
+    else
+    {
+        prvCopyFromHead( pxMyQueue, pvBuffer );
+        prvReleaseSlots( pxMyQueue, 1, pxHigherPriorityTaskWoken );
+        myqueueSTATS_RECEIVED( pxMyQueue, 1 );
+    }
+
+    myqueueEXIT_CRITICAL_FROM_ISR( pxMyQueue, uxSavedInterruptStatus );
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMyQueueSendToBackBatch( MyQueueHandle_t pxMyQueue,
+                                const void* pvItemsToQueue,
+                                size_t xItemCount,
+                                BaseType_t xWaitForAll,
+                                TickType_t xTicksToWait )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pvItemsToQueue != NULL || xItemCount == 0 );
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+    /* A batch larger than the queue could never be moved all at once */
+    configASSERT( xWaitForAll == pdFALSE || xItemCount <= pxMyQueue->uxLength );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        return prvSPSCSend( pxMyQueue, pvItemsToQueue, xItemCount, xWaitForAll, xTicksToWait );
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    size_t xSent = prvTakeBatch( pxMyQueue, pxMyQueue->pxEmptySemaphore, xItemCount,
+                                 xWaitForAll, xTicksToWait, &xYieldRequired );
+
+    if( xSent > 0 )
+    {
+        prvCopyBatchToTail( pxMyQueue, pvItemsToQueue, xSent );
+        prvPublishItems( pxMyQueue, xSent, &xYieldRequired );
+        myqueueSTATS_SENT( pxMyQueue, xSent );
+    }
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+    return xSent;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMyQueueReceiveBatch( MyQueueHandle_t pxMyQueue,
+                             void* pvBuffer,
+                             size_t xItemCount,
+                             BaseType_t xWaitForAll,
+                             TickType_t xTicksToWait )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pvBuffer != NULL || xItemCount == 0 );
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+    /* A batch larger than the queue could never be moved all at once */
+    configASSERT( xWaitForAll == pdFALSE || xItemCount <= pxMyQueue->uxLength );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        return prvSPSCReceive( pxMyQueue, pvBuffer, xItemCount, xWaitForAll, xTicksToWait );
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    size_t xReceived = prvTakeBatch( pxMyQueue, pxMyQueue->pxFullSemaphore, xItemCount,
+                                     xWaitForAll, xTicksToWait, &xYieldRequired );
+
+    if( xReceived > 0 )
+    {
+        prvCopyBatchFromHead( pxMyQueue, pvBuffer, xReceived );
+        prvReleaseSlots( pxMyQueue, xReceived, &xYieldRequired );
+        myqueueSTATS_RECEIVED( pxMyQueue, xReceived );
+    }
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+    return xReceived;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMyQueueSendToBackBatchFromISR( MyQueueHandle_t pxMyQueue,
+                                       const void* pvItemsToQueue,
+                                       size_t xItemCount,
+                                       BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pvItemsToQueue != NULL || xItemCount == 0 );
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        size_t xSent = prvSPSCPush( pxMyQueue, pvItemsToQueue, xItemCount );
+
+        if( xSent > 0 )
+        {
+            myqueueSTATS_SENT( pxMyQueue, xSent );
+            prvSPSCWakeFromISR( pxMyQueue, &( pxMyQueue->xWaitingReceiver ), pxHigherPriorityTaskWoken );
+        }
+        else if( xItemCount > 0 )
+        {
+            myqueueSTATS_GAVE_UP( pxMyQueue, pdTRUE );
+        }
+
+        return xSent;
+    }
+
+    UBaseType_t xSavedInterruptStatus = myqueueENTER_CRITICAL_FROM_ISR( pxMyQueue );
+
+    size_t xSent = uxMySemaphoreTakeUpToFromCritical( pxMyQueue->pxEmptySemaphore, xItemCount,
+                                                      pxHigherPriorityTaskWoken );
+
+    if( xSent > 0 )
+    {
+        prvCopyBatchToTail( pxMyQueue, pvItemsToQueue, xSent );
+        prvPublishItems( pxMyQueue, xSent, pxHigherPriorityTaskWoken );
+        myqueueSTATS_SENT( pxMyQueue, xSent );
+    }
+    else if( xItemCount > 0 )
+    {
+        myqueueSTATS_GAVE_UP( pxMyQueue, pdTRUE );
+    }
+
+    myqueueEXIT_CRITICAL_FROM_ISR( pxMyQueue, xSavedInterruptStatus );
+
+    return xSent;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMyQueueReceiveBatchFromISR( MyQueueHandle_t pxMyQueue,
+                                    void* pvBuffer,
+                                    size_t xItemCount,
+                                    BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pvBuffer != NULL || xItemCount == 0 );
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        size_t xReceived = prvSPSCPop( pxMyQueue, pvBuffer, xItemCount );
+
+        if( xReceived > 0 )
+        {
+            myqueueSTATS_RECEIVED( pxMyQueue, xReceived );
+            prvSPSCWakeFromISR( pxMyQueue, &( pxMyQueue->xWaitingSender ), pxHigherPriorityTaskWoken );
+        }
+        else if( xItemCount > 0 )
+        {
+            myqueueSTATS_GAVE_UP( pxMyQueue, pdFALSE );
+        }
+
+        return xReceived;
+    }
+
+    UBaseType_t xSavedInterruptStatus = myqueueENTER_CRITICAL_FROM_ISR( pxMyQueue );
+
+    size_t xReceived = uxMySemaphoreTakeUpToFromCritical( pxMyQueue->pxFullSemaphore, xItemCount,
+                                                          pxHigherPriorityTaskWoken );
+
+    if( xReceived > 0 )
+    {
+        prvCopyBatchFromHead( pxMyQueue, pvBuffer, xReceived );
+        prvReleaseSlots( pxMyQueue, xReceived, pxHigherPriorityTaskWoken );
+        myqueueSTATS_RECEIVED( pxMyQueue, xReceived );
+    }
+    else if( xItemCount > 0 )
+    {
+        myqueueSTATS_GAVE_UP( pxMyQueue, pdFALSE );
+    }
+
+    myqueueEXIT_CRITICAL_FROM_ISR( pxMyQueue, xSavedInterruptStatus );
+
+    return xReceived;
+}
+/*-----------------------------------------------------------*/
+
+void* pvMyQueueReserve( MyQueueHandle_t pxMyQueue, TickType_t xTicksToWait )
+{
+    configASSERT( pxMyQueue );
+    /* Variable length queues only take messages */
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        /* Only one slot can be reserved at a time */
+        configASSERT( pxMyQueue->pvReservedSlot == NULL );
+
+        if( prvSPSCWaitFor( pxMyQueue, pdTRUE, 1, xTicksToWait ) == pdFALSE )
+        {
+            return NULL;
+        }
+
+        /* Do not touch the slot until we have seen the consumer free it */
+        myqueueMEMORY_BARRIER();
+        pxMyQueue->pvReservedSlot = pxMyQueue->ucTail;
+
+        return pxMyQueue->pvReservedSlot;
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+    void* pvSlot = NULL;
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    /* Another task already holds the reserved slot. Fail rather than wait as it
+     * may not be committed for a long time */
+    if( pxMyQueue->pvReservedSlot != NULL )
+    {
+        myqueueEXIT_CRITICAL( pxMyQueue );
+        return NULL;
+    }
+
+    if( prvTakeBatch( pxMyQueue, pxMyQueue->pxEmptySemaphore, 1, pdTRUE,
+                      xTicksToWait, &xYieldRequired ) == 1 )
+    {
+        if( pxMyQueue->pvReservedSlot != NULL )
+        {
+            /* Another task claimed it while we were blocked, so hand back
+             * what we took */
+            ( void ) xMySemaphoreGiveNFromCritical( pxMyQueue->pxEmptySemaphore, 1, &xYieldRequired );
+        }
+        else
+        {
+            /* Claim the slot at ucTail. Items sent after it are held back by
+             * prvPublishItems until it is committed */
+            pvSlot = pxMyQueue->ucTail;
+            pxMyQueue->pvReservedSlot = pvSlot;
+
+            pxMyQueue->ucTail = prvNextSlot( pxMyQueue, pxMyQueue->ucTail, 1 );
+        }
+    }
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+    return pvSlot;
+}
+/*-----------------------------------------------------------*/
+
+void vMyQueueCommit( MyQueueHandle_t pxMyQueue, void* pvSlot )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pvSlot != NULL && pvSlot == pxMyQueue->pvReservedSlot );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        pxMyQueue->pvReservedSlot = NULL;
+
+        pxMyQueue->ucTail = prvNextSlot( pxMyQueue, pxMyQueue->ucTail, 1 );
+
+        /* Publish the item only once it is completely written */
+        myqueueMEMORY_BARRIER();
+        pxMyQueue->uxItemsSent++;
+        myqueueSTATS_SENT( pxMyQueue, 1 );
+        prvSPSCWake( pxMyQueue, &( pxMyQueue->xWaitingReceiver ) );
+
+        return;
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    pxMyQueue->pvReservedSlot = NULL;
+    prvPublishItems( pxMyQueue, 1 + pxMyQueue->uxUnpublishedItems, &xYieldRequired );
+    pxMyQueue->uxUnpublishedItems = 0;
+    myqueueSTATS_SENT( pxMyQueue, 1 );
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+}
+/*-----------------------------------------------------------*/
+
+void* pvMyQueuePeekSlot( MyQueueHandle_t pxMyQueue, TickType_t xTicksToWait )
+{
+    configASSERT( pxMyQueue );
+    /* Variable length queues only take messages */
+    configASSERT( pxMyQueue->xIsVariableLength == pdFALSE );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        /* Only one slot can be peeked at a time */
+        configASSERT( pxMyQueue->pvPeekedSlot == NULL );
+
+        if( prvSPSCWaitFor( pxMyQueue, pdFALSE, 1, xTicksToWait ) == pdFALSE )
+        {
+            return NULL;
+        }
+
+        /* Do not touch the slot until we have seen the producer fill it */
+        myqueueMEMORY_BARRIER();
+        pxMyQueue->pvPeekedSlot = pxMyQueue->ucHead;
+
+        return pxMyQueue->pvPeekedSlot;
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+    void* pvSlot = NULL;
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    /* Another task already holds the peeked slot. Fail rather than wait as it
+     * may not be released for a long time */
+    if( pxMyQueue->pvPeekedSlot != NULL )
+    {
+        myqueueEXIT_CRITICAL( pxMyQueue );
+        return NULL;
+    }
+
+    if( prvTakeBatch( pxMyQueue, pxMyQueue->pxFullSemaphore, 1, pdTRUE,
+                      xTicksToWait, &xYieldRequired ) == 1 )
+    {
+        if( pxMyQueue->pvPeekedSlot != NULL )
+        {
+            /* Another task claimed it while we were blocked, so hand back
+             * what we took */
+            ( void ) xMySemaphoreGiveNFromCritical( pxMyQueue->pxFullSemaphore, 1, &xYieldRequired );
+        }
+        else
+        {
+            /* Claim the slot at ucHead. Slots read after it are held back by
+             * prvReleaseSlots until it is released */
+            pvSlot = pxMyQueue->ucHead;
+            pxMyQueue->pvPeekedSlot = pvSlot;
+
+            pxMyQueue->ucHead = prvNextSlot( pxMyQueue, pxMyQueue->ucHead, 1 );
+        }
+    }
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+    return pvSlot;
+}
+/*-----------------------------------------------------------*/
+
+void vMyQueueRelease( MyQueueHandle_t pxMyQueue, void* pvSlot )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pvSlot != NULL && pvSlot == pxMyQueue->pvPeekedSlot );
+
+    if( pxMyQueue->xIsSPSC != pdFALSE )
+    {
+        pxMyQueue->pvPeekedSlot = NULL;
+
+        pxMyQueue->ucHead = prvNextSlot( pxMyQueue, pxMyQueue->ucHead, 1 );
+
+        /* Hand the slot back only once we are done reading it */
+        myqueueMEMORY_BARRIER();
+        pxMyQueue->uxItemsReceived++;
+        myqueueSTATS_RECEIVED( pxMyQueue, 1 );
+        prvSPSCWake( pxMyQueue, &( pxMyQueue->xWaitingSender ) );
+
+        return;
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    pxMyQueue->pvPeekedSlot = NULL;
+    prvReleaseSlots( pxMyQueue, 1 + pxMyQueue->uxUnreleasedSlots, &xYieldRequired );
+    pxMyQueue->uxUnreleasedSlots = 0;
+    myqueueSTATS_RECEIVED( pxMyQueue, 1 );
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+}
+/*-----------------------------------------------------------*/
+
+/* Bytes a message of xLength bytes takes in a variable length queue: its
+ * length header and the message, rounded up to a whole number of headers */
+static size_t prvMessageRecordSize( size_t xLength )
+{
+    size_t xRecordSize = myqueueMESSAGE_HEADER_SIZE + xLength;
+
+    return xRecordSize + ( ( myqueueMESSAGE_HEADER_SIZE - ( xRecordSize % myqueueMESSAGE_HEADER_SIZE ) ) %
+                           myqueueMESSAGE_HEADER_SIZE );
+}
+/*-----------------------------------------------------------*/
+
+/* Bytes of pxEmptySemaphore needed to write a record of xRecordSize bytes at
+ * ucTail: the record, plus the rest of the ring if it does not fit before
+ * ucBufferEnd. uxHeld is what the caller already holds. A ring nothing is
+ * stored in or claimed from is rewound first so no padding is needed. Must be
+ * called inside a critical section */
+static size_t prvMessageSpaceRequired( MyQueueHandle_t pxMyQueue,
+                                       size_t xRecordSize,
+                                       UBaseType_t uxHeld )
+{
+    if( uxMySemaphoreGetCountFromCritical( pxMyQueue->pxEmptySemaphore ) + uxHeld == pxMyQueue->uxLength )
+    {
+        pxMyQueue->ucHead = pxMyQueue->ucBufferBegin;
+        pxMyQueue->ucTail = pxMyQueue->ucBufferBegin;
+    }
+
+    size_t xToEnd = ( size_t ) ( pxMyQueue->ucBufferEnd - pxMyQueue->ucTail );
+
+    return ( xRecordSize <= xToEnd ) ? xRecordSize : xToEnd + xRecordSize;
+}
+/*-----------------------------------------------------------*/
+
+/* Write a message at ucTail, behind a wrap marker if xRequired includes
+ * padding. Caller must hold the xRequired bytes returned by
+ * prvMessageSpaceRequired and be inside a critical section */
+static void prvWriteMessage( MyQueueHandle_t pxMyQueue,
+                             const void* pvMessage,
+                             size_t xLength,
+                             size_t xRequired )
+{
+    size_t xRecordSize = prvMessageRecordSize( xLength );
+
+    if( xRequired > xRecordSize )
+    {
+        size_t xMarker = myqueueMESSAGE_WRAP_MARKER;
+
+        memcpy( ( void* ) pxMyQueue->ucTail, &xMarker, myqueueMESSAGE_HEADER_SIZE );
+        pxMyQueue->ucTail = pxMyQueue->ucBufferBegin;
+    }
+
+    memcpy( ( void* ) pxMyQueue->ucTail, &xLength, myqueueMESSAGE_HEADER_SIZE );
+    memcpy( ( void* ) ( pxMyQueue->ucTail + myqueueMESSAGE_HEADER_SIZE ), pvMessage, xLength );
+
+    pxMyQueue->ucTail += xRecordSize;
+    if( pxMyQueue->ucTail == pxMyQueue->ucBufferEnd )
+    {
+        pxMyQueue->ucTail = pxMyQueue->ucBufferBegin;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Copy the oldest message into pvBuffer and free the bytes it took. Returns
+ * its length, or 0 if it is longer than xBufferLength, in which case it stays
+ * queued and its unit of pxFullSemaphore is given back. Caller must hold a
+ * unit of pxFullSemaphore and be inside a critical section */
+static size_t prvReadMessage( MyQueueHandle_t pxMyQueue,
+                              void* pvBuffer,
+                              size_t xBufferLength,
+                              BaseType_t* pxYieldRequired )
+{
+    size_t xFreed = 0;
+    size_t xLength;
+
+    memcpy( &xLength, ( void* ) pxMyQueue->ucHead, myqueueMESSAGE_HEADER_SIZE );
+
+    if( xLength == myqueueMESSAGE_WRAP_MARKER )
+    {
+        xFreed = ( size_t ) ( pxMyQueue->ucBufferEnd - pxMyQueue->ucHead );
+        pxMyQueue->ucHead = pxMyQueue->ucBufferBegin;
+        memcpy( &xLength, ( void* ) pxMyQueue->ucHead, myqueueMESSAGE_HEADER_SIZE );
+    }
+
+    if( xLength > xBufferLength )
+    {
+        /* Leave it for a receiver with a bigger buffer */
+        ( void ) xMySemaphoreGiveFromCritical( pxMyQueue->pxFullSemaphore, pxYieldRequired );
+        xLength = 0;
+    }
+    else
+    {
+        memcpy( pvBuffer, ( void* ) ( pxMyQueue->ucHead + myqueueMESSAGE_HEADER_SIZE ), xLength );
+
+        size_t xRecordSize = prvMessageRecordSize( xLength );
+
+        xFreed += xRecordSize;
+        pxMyQueue->ucHead += xRecordSize;
+        if( pxMyQueue->ucHead == pxMyQueue->ucBufferEnd )
+        {
+            pxMyQueue->ucHead = pxMyQueue->ucBufferBegin;
+        }
+
+        myqueueSTATS_RECEIVED( pxMyQueue, 1 );
+    }
+
+    if( xFreed > 0 )
+    {
+        prvReleaseSlots( pxMyQueue, xFreed, pxYieldRequired );
+    }
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMyQueueSendMessage( MyQueueHandle_t pxMyQueue,
+                                const void* pvMessage,
+                                size_t xLength,
+                                TickType_t xTicksToWait )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pxMyQueue->xIsVariableLength != pdFALSE );
+    /* A length of 0 is how a receive reports a buffer that is too small */
+    configASSERT( pvMessage != NULL && xLength > 0 );
+
+    size_t xRecordSize = prvMessageRecordSize( xLength );
+
+    /* Would not fit even in an empty queue */
+    configASSERT( xRecordSize <= pxMyQueue->uxLength );
+    if( xRecordSize > pxMyQueue->uxLength )
+    {
+        return errQUEUE_FULL;
+    }
+
+    BaseType_t xYieldRequired = pdFALSE;
+    UBaseType_t uxHeld = 0;
+    size_t xRequired;
+    TimeOut_t xTimeOut;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    for( ;; )
+    {
+        xRequired = prvMessageSpaceRequired( pxMyQueue, xRecordSize, uxHeld );
+
+        if( uxHeld < xRequired &&
+            xMySemaphoreTakeNFromCritical( pxMyQueue->pxEmptySemaphore, xRequired - uxHeld,
+                                           &xYieldRequired ) != pdFALSE )
+        {
+            uxHeld = xRequired;
+        }
+
+        if( uxHeld >= xRequired )
+        {
+            break;
+        }
+
+        /* Where the message goes depends on where ucTail is once there is
+         * room, so never sit on part of the space while waiting */
+        if( uxHeld > 0 )
+        {
+            ( void ) xMySemaphoreGiveNFromCritical( pxMyQueue->pxEmptySemaphore, uxHeld,
+                                                    &xYieldRequired );
+        }
+
+        myqueueEXIT_CRITICAL( pxMyQueue );
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            myqueueENTER_CRITICAL( pxMyQueue );
+            myqueueSTATS_GAVE_UP( pxMyQueue, pdTRUE );
+            myqueueEXIT_CRITICAL( pxMyQueue );
+            myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+            return errQUEUE_FULL;
+        }
+
+        /* No more than the whole ring is ever free. Once we hold all of it
+         * the ring is rewound and the record fits without padding */
+        uxHeld = ( xRequired < pxMyQueue->uxLength ) ? xRequired : pxMyQueue->uxLength;
+
+        BaseType_t xTaken = prvWaitOnSemaphore( pxMyQueue, pxMyQueue->pxEmptySemaphore,
+                                                uxHeld, xTicksToWait );
+        myqueueENTER_CRITICAL( pxMyQueue );
+
+        if( xTaken == pdFALSE )
+        {
+            myqueueEXIT_CRITICAL( pxMyQueue );
+            myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+            return errQUEUE_FULL;
+        }
+    }
+
+    if( uxHeld > xRequired )
+    {
+        ( void ) xMySemaphoreGiveNFromCritical( pxMyQueue->pxEmptySemaphore, uxHeld - xRequired,
+                                                &xYieldRequired );
+    }
+
+    prvWriteMessage( pxMyQueue, pvMessage, xLength, xRequired );
+    prvPublishItems( pxMyQueue, 1, &xYieldRequired );
+    myqueueSTATS_SENT( pxMyQueue, 1 );
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMyQueueReceiveMessage( MyQueueHandle_t pxMyQueue,
+                               void* pvBuffer,
+                               size_t xBufferLength,
+                               TickType_t xTicksToWait )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pxMyQueue->xIsVariableLength != pdFALSE );
+    configASSERT( pvBuffer != NULL || xBufferLength == 0 );
+
+    BaseType_t xYieldRequired = pdFALSE;
+
+    myqueueENTER_CRITICAL( pxMyQueue );
+
+    if( xMySemaphoreTakeFromCritical( pxMyQueue->pxFullSemaphore, &xYieldRequired ) == pdFALSE )
+    {
+        if( xTicksToWait == 0 )
+        {
+            myqueueSTATS_GAVE_UP( pxMyQueue, pdFALSE );
+            myqueueEXIT_CRITICAL( pxMyQueue );
+            myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+            return 0;
+        }
+
+        myqueueEXIT_CRITICAL( pxMyQueue );
+        if( prvWaitOnSemaphore( pxMyQueue, pxMyQueue->pxFullSemaphore, 1, xTicksToWait ) == pdFALSE )
+        {
+            return 0;
+        }
+        myqueueENTER_CRITICAL( pxMyQueue );
+    }
+
+    size_t xReceived = prvReadMessage( pxMyQueue, pvBuffer, xBufferLength, &xYieldRequired );
+
+    myqueueEXIT_CRITICAL( pxMyQueue );
+    myqueueYIELD_IF_REQUIRED( xYieldRequired );
+
+    return xReceived;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMyQueueSendMessageFromISR( MyQueueHandle_t pxMyQueue,
+                                       const void* pvMessage,
+                                       size_t xLength,
+                                       BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pxMyQueue->xIsVariableLength != pdFALSE );
+    configASSERT( pvMessage != NULL && xLength > 0 );
+
+    size_t xRecordSize = prvMessageRecordSize( xLength );
+
+    configASSERT( xRecordSize <= pxMyQueue->uxLength );
+    if( xRecordSize > pxMyQueue->uxLength )
+    {
+        return errQUEUE_FULL;
+    }
+
+    BaseType_t xStatus = errQUEUE_FULL;
+    UBaseType_t uxSavedInterruptStatus = myqueueENTER_CRITICAL_FROM_ISR( pxMyQueue );
+
+    size_t xRequired = prvMessageSpaceRequired( pxMyQueue, xRecordSize, 0 );
+
+    if( xMySemaphoreTakeNFromCritical( pxMyQueue->pxEmptySemaphore, xRequired,
+                                       pxHigherPriorityTaskWoken ) != pdFALSE )
+    {
+        prvWriteMessage( pxMyQueue, pvMessage, xLength, xRequired );
+        prvPublishItems( pxMyQueue, 1, pxHigherPriorityTaskWoken );
+        myqueueSTATS_SENT( pxMyQueue, 1 );
+        xStatus = pdTRUE;
+    }
+    else
+    {
+        myqueueSTATS_GAVE_UP( pxMyQueue, pdTRUE );
+    }
+
+    myqueueEXIT_CRITICAL_FROM_ISR( pxMyQueue, uxSavedInterruptStatus );
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMyQueueReceiveMessageFromISR( MyQueueHandle_t pxMyQueue,
+                                      void* pvBuffer,
+                                      size_t xBufferLength,
+                                      BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMyQueue );
+    configASSERT( pxMyQueue->xIsVariableLength != pdFALSE );
+    configASSERT( pvBuffer != NULL || xBufferLength == 0 );
+
+    size_t xReceived = 0;
+    UBaseType_t uxSavedInterruptStatus = myqueueENTER_CRITICAL_FROM_ISR( pxMyQueue );
+
+    if( xMySemaphoreTakeFromCritical( pxMyQueue->pxFullSemaphore,
+                                      pxHigherPriorityTaskWoken ) != pdFALSE )
+    {
+        xReceived = prvReadMessage( pxMyQueue, pvBuffer, xBufferLength, pxHigherPriorityTaskWoken );
+    }
+    else
+    {
+        myqueueSTATS_GAVE_UP( pxMyQueue, pdFALSE );
+    }
+
+    myqueueEXIT_CRITICAL_FROM_ISR( pxMyQueue, uxSavedInterruptStatus );
+
+    return xReceived;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+    MyQueueSetHandle_t pxMyQueueCreateSet( UBaseType_t uxEventQueueLength )
+    {
+        /* Each entry is the handle of the member that became ready */
+        return pxMyQueueCreate( uxEventQueueLength, sizeof( MyQueueSetMemberHandle_t ) );
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xMyQueueAddToSet( MyQueueHandle_t pxMyQueue,
+                                 MyQueueSetHandle_t pxQueueSet )
+    {
+        configASSERT( pxMyQueue );
+        /* SPSC queues do not go through pxFullSemaphore */
+        configASSERT( pxMyQueue->xIsSPSC == pdFALSE );
+
+        if( pxMyQueue->xIsSPSC != pdFALSE )
+        {
+            return pdFALSE;
+        }
+
+        /* Items are counted by pxFullSemaphore, so it reports for the queue */
+        return xMySemaphoreLinkToSet( pxMyQueue->pxFullSemaphore, pxQueueSet, pxMyQueue );
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xMyQueueRemoveFromSet( MyQueueHandle_t pxMyQueue,
+                                      MyQueueSetHandle_t pxQueueSet )
+    {
+        configASSERT( pxMyQueue );
+
+        if( pxMyQueue->xIsSPSC != pdFALSE )
+        {
+            return pdFALSE;
+        }
+
+        return xMySemaphoreUnlinkFromSet( pxMyQueue->pxFullSemaphore, pxQueueSet );
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xMyQueueAddSemaphoreToSet( MySemaphoreHandle_t pxMySemaphore,
+                                          MyQueueSetHandle_t pxQueueSet )
+    {
+        return xMySemaphoreLinkToSet( pxMySemaphore, pxQueueSet, pxMySemaphore );
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xMyQueueRemoveSemaphoreFromSet( MySemaphoreHandle_t pxMySemaphore,
+                                               MyQueueSetHandle_t pxQueueSet )
+    {
+        return xMySemaphoreUnlinkFromSet( pxMySemaphore, pxQueueSet );
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xMyQueueSendToSetFromCritical( MyQueueSetHandle_t pxQueueSet,
+                                              const void* pvItemToQueue,
+                                              BaseType_t* pxHigherPriorityTaskWoken )
+    {
+        #if ( configNUMBER_OF_CORES > 1 )
+            /* Only the member's lock is held so far */
+            vMySemaphoreLock( &( pxQueueSet->xLock ) );
+        #endif
+
+        BaseType_t xSent = xMyQueueSendToBackFromCritical( pxQueueSet, pvItemToQueue,
+                                                           pxHigherPriorityTaskWoken );
+
+        #if ( configNUMBER_OF_CORES > 1 )
+            vMySemaphoreUnlock( &( pxQueueSet->xLock ) );
+        #endif
+
+        return xSent;
+    }
+/*-----------------------------------------------------------*/
+
+    MyQueueSetMemberHandle_t xMyQueueSelectFromSet( MyQueueSetHandle_t pxQueueSet,
+                                                    TickType_t xTicksToWait )
+    {
+        MyQueueSetMemberHandle_t xMember = NULL;
+
+        ( void ) xMyQueueReceive( pxQueueSet, &xMember, xTicksToWait );
+
+        return xMember;
+    }
+/*-----------------------------------------------------------*/
+
+    MyQueueSetMemberHandle_t xMyQueueSelectFromSetFromISR( MyQueueSetHandle_t pxQueueSet )
+    {
+        MyQueueSetMemberHandle_t xMember = NULL;
+
+        /* Nothing waits to send to a set, so no task can be woken */
+        ( void ) xMyQueueReceiveFromISR( pxQueueSet, &xMember, NULL );
+
+        return xMember;
+    }
+
+#endif /* configUSE_QUEUE_SETS */
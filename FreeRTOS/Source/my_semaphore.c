@@ -1,21 +1,295 @@
 #include "FreeRTOS.h"
 #include <stdio.h>
+#include <string.h>
 
+#include "my_queue.h"
 #include "my_semaphore.h"
 #include "task.h"
 
+/* Waiters are queued by the priority of the waiting task */
+#if ( INCLUDE_uxTaskPriorityGet != 1 )
+    #error INCLUDE_uxTaskPriorityGet must be set to 1 in FreeRTOSConfig.h to use MySemaphore
+#endif
+
+/* Waiter buckets are indexed through a 32 bit priority bitmap */
+#if ( configMAX_PRIORITIES > 32 )
+    #error configMAX_PRIORITIES must be 32 or less to use MySemaphore
+#endif
+
+/* A task blocked in a take or give. Lives on the waiting task's stack and is
+ * linked into the bucket for its priority in xWaitingTakers or xWaitingGivers
+ * until it is served or gives up */
+typedef struct MySemaphoreWaiter
+{
+    /* Neighbours in a circular bucket, the head's previous is the tail */
+    struct MySemaphoreWaiter* pxNext;
+    struct MySemaphoreWaiter* pxPrev;
+    /* Waiting list the waiter is on, NULL once it has been taken off */
+    struct MySemaphoreWaitList* pxContainer;
+    TaskHandle_t xTask;
+    UBaseType_t uxPriority;
+    /* Units the task wants to take (give) in one go */
+    UBaseType_t uxUnits;
+} MySemaphoreWaiter_t;
+
+/* One FIFO bucket per priority plus a bitmap of the non-empty ones, so
+ * adding a waiter, removing one and finding the highest priority waiter are
+ * all O(1) */
+typedef struct MySemaphoreWaitList
+{
+    uint32_t ulPriorities;
+    MySemaphoreWaiter_t* pxBuckets[ configMAX_PRIORITIES ];
+} MySemaphoreWaitList_t;
+
 struct MySemaphoreDefinition
 {
     UBaseType_t uxCount;
     UBaseType_t uxMaxCount;
 
-    /* List of givers (takers) ordered by priority and then when task calls
-     * give (take) */
-    List_t xWaitingGivers;
-    List_t xWaitingTakers;
+    /* Givers (takers) by priority and then by when the task called give
+     * (take) */
+    MySemaphoreWaitList_t xWaitingGivers;
+    MySemaphoreWaitList_t xWaitingTakers;
+
+    /* Task holding a semaphore created as a mutex, NULL when it is free */
+    TaskHandle_t xMutexHolder;
+
+    #if ( configUSE_QUEUE_SETS == 1 )
+        /* Set every given unit is reported to, and the handle reported for
+         * it. The handle is the owning queue for a MyQueue's semaphore */
+        struct MyQueueDefinition* pxQueueSetContainer;
+        void* pvQueueSetMember;
+    #endif
+
+    #if ( configMYQUEUE_STATS == 1 )
+        MySemaphoreStats_t xStats;
+    #endif
+
+    /* Set if the memory was provided by pxMySemaphoreCreateStatic so it must
+     * not be freed */
+    uint8_t ucStaticallyAllocated;
+
+    /* Set if created by pxMySemaphoreCreateMutex(Static) */
+    uint8_t ucIsMutex;
+
+    #if ( configNUMBER_OF_CORES > 1 )
+        /* Lock guarding the semaphore. pxLock points to xLock unless the
+         * semaphore belongs to a MyQueue, which guards it with its own */
+        MySemaphoreLock_t xLock;
+        MySemaphoreLock_t* pxLock;
+    #endif
 };
 /*-----------------------------------------------------------*/
 
+/* Critical sections guarding a semaphore. With more than one core, each
+ * semaphore has its own lock so that cores working on different semaphores
+ * never wait for each other. Mutexes still use the kernel lock, as priority
+ * inheritance changes kernel state under it. Nothing that takes the kernel
+ * lock at task level may be called with a semaphore lock held, because
+ * leaving the kernel's critical section would unmask interrupts */
+#if ( configNUMBER_OF_CORES > 1 )
+    #define mysemaphoreENTER_CRITICAL( pxMySemaphore )                               prvEnterCritical( pxMySemaphore )
+    #define mysemaphoreEXIT_CRITICAL( pxMySemaphore )                                prvExitCritical( pxMySemaphore )
+    #define mysemaphoreENTER_CRITICAL_FROM_ISR( pxMySemaphore )                      ( vMySemaphoreLock( ( pxMySemaphore )->pxLock ), ( UBaseType_t ) 0 )
+    #define mysemaphoreEXIT_CRITICAL_FROM_ISR( pxMySemaphore, uxSavedStatus )    \
+    do {                                                                         \
+        ( void ) ( uxSavedStatus );                                              \
+        vMySemaphoreUnlock( ( pxMySemaphore )->pxLock );                         \
+    } while( 0 )
+#else
+    #define mysemaphoreENTER_CRITICAL( pxMySemaphore )                               taskENTER_CRITICAL()
+    #define mysemaphoreEXIT_CRITICAL( pxMySemaphore )                                taskEXIT_CRITICAL()
+    #define mysemaphoreENTER_CRITICAL_FROM_ISR( pxMySemaphore )                      taskENTER_CRITICAL_FROM_ISR()
+    #define mysemaphoreEXIT_CRITICAL_FROM_ISR( pxMySemaphore, uxSavedStatus )    taskEXIT_CRITICAL_FROM_ISR( uxSavedStatus )
+#endif
+/*-----------------------------------------------------------*/
+
+/* Counters are only ever touched inside a critical section */
+#if ( configMYQUEUE_STATS == 1 )
+    #define mysemaphoreSTATS_ADD( pxMySemaphore, xField, xAmount )    ( ( pxMySemaphore )->xStats.xField += ( xAmount ) )
+#else
+    #define mysemaphoreSTATS_ADD( pxMySemaphore, xField, xAmount )
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseSemaphore( MySemaphoreHandle_t pxNewSemaphore,
+                                    const UBaseType_t uxMaxCount,
+                                    const UBaseType_t uxInitialCount )
+{
+    pxNewSemaphore->uxCount = uxInitialCount;
+    pxNewSemaphore->uxMaxCount = uxMaxCount;
+    pxNewSemaphore->xMutexHolder = NULL;
+    pxNewSemaphore->ucIsMutex = pdFALSE;
+
+    #if ( configUSE_QUEUE_SETS == 1 )
+    {
+        pxNewSemaphore->pxQueueSetContainer = NULL;
+        pxNewSemaphore->pvQueueSetMember = NULL;
+    }
+    #endif
+
+    #if ( configNUMBER_OF_CORES > 1 )
+    {
+        pxNewSemaphore->xLock.ulLocked = 0U;
+        pxNewSemaphore->pxLock = &( pxNewSemaphore->xLock );
+    }
+    #endif
+
+    ( void ) memset( &( pxNewSemaphore->xWaitingGivers ), 0x00, sizeof( MySemaphoreWaitList_t ) );
+    ( void ) memset( &( pxNewSemaphore->xWaitingTakers ), 0x00, sizeof( MySemaphoreWaitList_t ) );
+
+    #if ( configMYQUEUE_STATS == 1 )
+    {
+        ( void ) memset( &( pxNewSemaphore->xStats ), 0x00, sizeof( MySemaphoreStats_t ) );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+    void vMySemaphoreLock( MySemaphoreLock_t* pxLock )
+    {
+        /* Nothing on this core can take the lock from under us, and we cannot
+         * be switched out while other cores spin on it */
+        UBaseType_t uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+        configMYSEMAPHORE_SPIN_LOCK( &( pxLock->ulLocked ) );
+        pxLock->uxSavedInterruptStatus = uxSavedInterruptStatus;
+    }
+/*-----------------------------------------------------------*/
+
+    void vMySemaphoreUnlock( MySemaphoreLock_t* pxLock )
+    {
+        UBaseType_t uxSavedInterruptStatus = pxLock->uxSavedInterruptStatus;
+
+        configMYSEMAPHORE_SPIN_UNLOCK( &( pxLock->ulLocked ) );
+        portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+    }
+/*-----------------------------------------------------------*/
+
+    void vMySemaphoreShareLock( MySemaphoreHandle_t pxMySemaphore,
+                                MySemaphoreLock_t* pxLock )
+    {
+        configASSERT( pxMySemaphore );
+        configASSERT( pxLock );
+
+        pxMySemaphore->pxLock = pxLock;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvEnterCritical( MySemaphoreHandle_t pxMySemaphore )
+    {
+        if( pxMySemaphore->ucIsMutex != pdFALSE )
+        {
+            taskENTER_CRITICAL();
+        }
+        else
+        {
+            vMySemaphoreLock( pxMySemaphore->pxLock );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvExitCritical( MySemaphoreHandle_t pxMySemaphore )
+    {
+        if( pxMySemaphore->ucIsMutex != pdFALSE )
+        {
+            taskEXIT_CRITICAL();
+        }
+        else
+        {
+            vMySemaphoreUnlock( pxMySemaphore->pxLock );
+        }
+    }
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
+/* Append pxWaiter to the bucket for its priority, behind every waiter of the
+ * same priority. Must be called inside a critical section */
+static void prvWaitListInsert( MySemaphoreWaitList_t* pxWaitList,
+                               MySemaphoreWaiter_t* pxWaiter )
+{
+    MySemaphoreWaiter_t* pxHead = pxWaitList->pxBuckets[ pxWaiter->uxPriority ];
+
+    if( pxHead == NULL )
+    {
+        pxWaiter->pxNext = pxWaiter;
+        pxWaiter->pxPrev = pxWaiter;
+        pxWaitList->pxBuckets[ pxWaiter->uxPriority ] = pxWaiter;
+        pxWaitList->ulPriorities |= ( 1UL << pxWaiter->uxPriority );
+    }
+    else
+    {
+        pxWaiter->pxNext = pxHead;
+        pxWaiter->pxPrev = pxHead->pxPrev;
+        pxHead->pxPrev->pxNext = pxWaiter;
+        pxHead->pxPrev = pxWaiter;
+    }
+
+    pxWaiter->pxContainer = pxWaitList;
+}
+/*-----------------------------------------------------------*/
+
+/* Unlink pxWaiter from whichever bucket it is in. Must be called inside a
+ * critical section */
+static void prvWaitListRemove( MySemaphoreWaiter_t* pxWaiter )
+{
+    MySemaphoreWaitList_t* pxWaitList = pxWaiter->pxContainer;
+
+    if( pxWaiter->pxNext == pxWaiter )
+    {
+        pxWaitList->pxBuckets[ pxWaiter->uxPriority ] = NULL;
+        pxWaitList->ulPriorities &= ~( 1UL << pxWaiter->uxPriority );
+    }
+    else
+    {
+        pxWaiter->pxPrev->pxNext = pxWaiter->pxNext;
+        pxWaiter->pxNext->pxPrev = pxWaiter->pxPrev;
+
+        if( pxWaitList->pxBuckets[ pxWaiter->uxPriority ] == pxWaiter )
+        {
+            pxWaitList->pxBuckets[ pxWaiter->uxPriority ] = pxWaiter->pxNext;
+        }
+    }
+
+    pxWaiter->pxContainer = NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* The oldest waiter of the highest waiting priority, or NULL if nobody is
+ * waiting. Must be called inside a critical section */
+static MySemaphoreWaiter_t* prvWaitListHead( const MySemaphoreWaitList_t* pxWaitList )
+{
+    if( pxWaitList->ulPriorities == 0 )
+    {
+        return NULL;
+    }
+
+    UBaseType_t uxTopPriority;
+
+    #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+    {
+        portGET_HIGHEST_PRIORITY( uxTopPriority, pxWaitList->ulPriorities );
+    }
+    #else
+    {
+        /* Bounded by configMAX_PRIORITIES rather than by the number of
+         * waiters */
+        uxTopPriority = configMAX_PRIORITIES - 1;
+
+        while( ( pxWaitList->ulPriorities & ( 1UL << uxTopPriority ) ) == 0 )
+        {
+            uxTopPriority--;
+        }
+    }
+    #endif
+
+    return pxWaitList->pxBuckets[ uxTopPriority ];
+}
+/*-----------------------------------------------------------*/
+
 MySemaphoreHandle_t pxMySemaphoreCreate( const UBaseType_t uxMaxCount,
                                          const UBaseType_t uxInitialCount )
 {
@@ -26,206 +300,662 @@ MySemaphoreHandle_t pxMySemaphoreCreate( const UBaseType_t uxMaxCount,
         return NULL;
     }
 
-    pxNewSemaphore->uxCount = uxInitialCount;
-    pxNewSemaphore->uxMaxCount = uxMaxCount;
+    prvInitialiseSemaphore( pxNewSemaphore, uxMaxCount, uxInitialCount );
+    pxNewSemaphore->ucStaticallyAllocated = pdFALSE;
 
-    vListInitialise( &( pxNewSemaphore->xWaitingGivers ) );
-    vListInitialise( &( pxNewSemaphore->xWaitingTakers ) );
+    return pxNewSemaphore;
+}
+/*-----------------------------------------------------------*/
+
+MySemaphoreHandle_t pxMySemaphoreCreateStatic( const UBaseType_t uxMaxCount,
+                                               const UBaseType_t uxInitialCount,
+                                               StaticMySemaphore_t* pxSemaphoreBuffer )
+{
+    configASSERT( pxSemaphoreBuffer );
+
+    #if ( configASSERT_DEFINED == 1 )
+    {
+        /* StaticMySemaphore_t must stay in step with MySemaphore_t */
+        volatile size_t xSize = sizeof( StaticMySemaphore_t );
+        configASSERT( xSize == sizeof( MySemaphore_t ) );
+        ( void ) xSize;
+    }
+    #endif
+
+    MySemaphoreHandle_t pxNewSemaphore = ( MySemaphoreHandle_t ) pxSemaphoreBuffer;
+
+    prvInitialiseSemaphore( pxNewSemaphore, uxMaxCount, uxInitialCount );
+    pxNewSemaphore->ucStaticallyAllocated = pdTRUE;
 
     return pxNewSemaphore;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_MUTEXES == 1 )
+
+    MySemaphoreHandle_t pxMySemaphoreCreateMutex( void )
+    {
+        MySemaphoreHandle_t pxNewSemaphore = pxMySemaphoreCreate( 1, 1 );
+
+        if( pxNewSemaphore != NULL )
+        {
+            pxNewSemaphore->ucIsMutex = pdTRUE;
+        }
+
+        return pxNewSemaphore;
+    }
+/*-----------------------------------------------------------*/
+
+    MySemaphoreHandle_t pxMySemaphoreCreateMutexStatic( StaticMySemaphore_t* pxSemaphoreBuffer )
+    {
+        MySemaphoreHandle_t pxNewSemaphore = pxMySemaphoreCreateStatic( 1, 1, pxSemaphoreBuffer );
+
+        pxNewSemaphore->ucIsMutex = pdTRUE;
+
+        return pxNewSemaphore;
+    }
+/*-----------------------------------------------------------*/
+
+    TaskHandle_t xMySemaphoreGetMutexHolder( MySemaphoreHandle_t pxMySemaphore )
+    {
+        configASSERT( pxMySemaphore );
+
+        mysemaphoreENTER_CRITICAL( pxMySemaphore );
+        TaskHandle_t xHolder = pxMySemaphore->xMutexHolder;
+        mysemaphoreEXIT_CRITICAL( pxMySemaphore );
+
+        return xHolder;
+    }
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configMYQUEUE_STATS == 1 )
+
+    void vMySemaphoreGetStats( MySemaphoreHandle_t pxMySemaphore,
+                               MySemaphoreStats_t* pxStats )
+    {
+        configASSERT( pxMySemaphore );
+        configASSERT( pxStats );
+
+        mysemaphoreENTER_CRITICAL( pxMySemaphore );
+        *pxStats = pxMySemaphore->xStats;
+        mysemaphoreEXIT_CRITICAL( pxMySemaphore );
+    }
+
+#endif /* configMYQUEUE_STATS */
+/*-----------------------------------------------------------*/
+
 void vMySemaphoreDelete( MySemaphoreHandle_t pxMySemaphore ) {
     /* Check semaphore is non-null */
     configASSERT( pxMySemaphore );
 
-    vPortFree( pxMySemaphore );
+    if( pxMySemaphore->ucStaticallyAllocated == pdFALSE )
+    {
+        vPortFree( pxMySemaphore );
+    }
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xMySemaphoreTake( MySemaphoreHandle_t pxMySemaphore,
-                             TickType_t xTicksToWait )
+/* Wake pxWaiter, which has just been served */
+static void prvWakeWaiter( MySemaphoreWaiter_t* pxWaiter, BaseType_t* pxHigherPriorityTaskWoken )
 {
-    /* Check semaphore is non-null */
-    configASSERT( pxMySemaphore );
+    BaseType_t xWoken = pdFALSE;
 
-    /* Semaphore modification operations must be done under critical sections */
-    taskENTER_CRITICAL();
+    prvWaitListRemove( pxWaiter );
+
+    /* Safe inside either kind of critical section. Leaves any yield to the
+     * caller */
+    vTaskNotifyGiveIndexedFromISR( pxWaiter->xTask, configMYSEMAPHORE_NOTIFICATION_INDEX, &xWoken );
 
-    if( pxMySemaphore->uxCount > 0 )
+    if( xWoken != pdFALSE && pxHigherPriorityTaskWoken != NULL )
     {
-        /* Semaphore resource is available so take it */
-        ( pxMySemaphore->uxCount )--;
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
 
-        /* Since resource can no longer be full, if there are any waiting givers,
-         * they are now able to give the resource */
-        if( listLIST_IS_EMPTY( &( pxMySemaphore->xWaitingGivers ) ) == pdFALSE )
+    /* Send one entry per unit just added to the set pxMySemaphore is in, if any.
+     * Must be called inside a critical section */
+    static void prvNotifyQueueSetContainer( MySemaphoreHandle_t pxMySemaphore,
+                                            UBaseType_t uxUnits,
+                                            BaseType_t* pxHigherPriorityTaskWoken )
+    {
+        if( pxMySemaphore->pxQueueSetContainer == NULL )
         {
-            /* Notify the next giver that resource is no longer full. Next
-             * giver gives semaphore, incrementing count of the semaphore */
-            vTaskPopFromSemaphoreList( &( pxMySemaphore->xWaitingGivers ) );
-            ( pxMySemaphore->uxCount )++;
+            return;
         }
 
-        taskEXIT_CRITICAL();
-        return pdTRUE;
+        while( uxUnits-- > 0 )
+        {
+            BaseType_t xSent = xMyQueueSendToSetFromCritical( pxMySemaphore->pxQueueSetContainer,
+                                                              &( pxMySemaphore->pvQueueSetMember ),
+                                                              pxHigherPriorityTaskWoken );
+
+            /* A set has room for every unit of every member at once */
+            configASSERT( xSent == pdTRUE );
+            ( void ) xSent;
+        }
     }
 
-    /* Semaphore resource is not available so add to list of waiting takers */
-    vTaskPlaceOnSemaphoreList( &( pxMySemaphore->xWaitingTakers ) );
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
 
-    /* Exit critical section to allow task to be notified */
-    taskEXIT_CRITICAL();
+/* Serve waiters in priority order for as long as the head one's request
+ * fits. Stopping at the first one that does not fit keeps a large request
+ * from being starved by smaller ones queued behind it. Serving givers can
+ * make room for takers and the other way round, so repeat until neither
+ * side moves. Must be called inside a critical section */
+static void prvServeWaiters( MySemaphoreHandle_t pxMySemaphore,
+                             BaseType_t* pxHigherPriorityTaskWoken )
+{
+    BaseType_t xServed;
 
-    /* Wait to be notified that semaphore is available with timeout */
-    uint32_t ulNotifiedValue = ulTaskNotifyTake( pdTRUE, xTicksToWait );
+    do
+    {
+        xServed = pdFALSE;
+
+        MySemaphoreWaiter_t* pxTaker;
+        MySemaphoreWaiter_t* pxGiver;
+
+        while( ( pxTaker = prvWaitListHead( &( pxMySemaphore->xWaitingTakers ) ) ) != NULL )
+        {
+            if( pxTaker->uxUnits > pxMySemaphore->uxCount )
+            {
+                break;
+            }
+
+            pxMySemaphore->uxCount -= pxTaker->uxUnits;
+            mysemaphoreSTATS_ADD( pxMySemaphore, uxTakes, pxTaker->uxUnits );
 
-    /* Task is now unblocked. If semaphore was taken, ulNotifiedValue will be
-     * non-zero and give function will have already decremented semaphore count */
-    if( ulNotifiedValue > 0)
+            /* A mutex changes hands here, the new holder counts it once it
+             * runs */
+            if( pxMySemaphore->ucIsMutex != pdFALSE )
+            {
+                pxMySemaphore->xMutexHolder = pxTaker->xTask;
+            }
+
+            prvWakeWaiter( pxTaker, pxHigherPriorityTaskWoken );
+            xServed = pdTRUE;
+        }
+
+        while( ( pxGiver = prvWaitListHead( &( pxMySemaphore->xWaitingGivers ) ) ) != NULL )
+        {
+            if( pxGiver->uxUnits > pxMySemaphore->uxMaxCount - pxMySemaphore->uxCount )
+            {
+                break;
+            }
+
+            pxMySemaphore->uxCount += pxGiver->uxUnits;
+            mysemaphoreSTATS_ADD( pxMySemaphore, uxGives, pxGiver->uxUnits );
+
+            #if ( configUSE_QUEUE_SETS == 1 )
+                prvNotifyQueueSetContainer( pxMySemaphore, pxGiver->uxUnits, pxHigherPriorityTaskWoken );
+            #endif
+
+            prvWakeWaiter( pxGiver, pxHigherPriorityTaskWoken );
+            xServed = pdTRUE;
+        }
+    } while( xServed != pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+/* A task may only skip pxWaitList if everyone on it has lower priority. Any
+ * other caller (xIsTask == pdFALSE) always defers to waiters, as an ISR has
+ * no priority of its own and the interrupted task's has nothing to do with
+ * it. Must be called inside a critical section */
+static BaseType_t prvMayGoFirst( const MySemaphoreWaitList_t* pxWaitList,
+                                 BaseType_t xIsTask )
+{
+    /* Nobody waiting is the common case, and the only one before the
+     * scheduler has started when there may be no calling task */
+    if( pxWaitList->ulPriorities == 0 )
     {
         return pdTRUE;
     }
 
-    /* If semaphore was not taken, remove task from waiting takers */
-    vTaskRemoveFromSemaphoreList( &( pxMySemaphore->xWaitingTakers ) );
-    return pdFALSE;
+    if( xIsTask == pdFALSE )
+    {
+        return pdFALSE;
+    }
+
+    /* Every bucket at or above the calling task's priority must be empty. The
+     * FromISR getter is used as it does not leave the kernel's critical
+     * section at task level */
+    return ( ( pxWaitList->ulPriorities >> uxTaskPriorityGetFromISR( NULL ) ) == 0 ) ? pdTRUE : pdFALSE;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xMySemaphoreGive( MySemaphoreHandle_t pxMySemaphore,
-                             TickType_t xTicksToWait )
+/* Take uxUnits if they are available and prvMayGoFirst lets the caller skip
+ * the queued takers. Must be called inside a critical section */
+static BaseType_t prvTakeN( MySemaphoreHandle_t pxMySemaphore,
+                            UBaseType_t uxUnits,
+                            BaseType_t xIsTask,
+                            BaseType_t* pxHigherPriorityTaskWoken )
+{
+    /* Queued takers are served first, even when a smaller request of ours
+     * would fit, or a stream of small takes could keep a large waiter from
+     * ever being served */
+    if( pxMySemaphore->uxCount < uxUnits ||
+        prvMayGoFirst( &( pxMySemaphore->xWaitingTakers ), xIsTask ) == pdFALSE )
+    {
+        return pdFALSE;
+    }
+
+    pxMySemaphore->uxCount -= uxUnits;
+    mysemaphoreSTATS_ADD( pxMySemaphore, uxTakes, uxUnits );
+
+    /* Since resource can no longer be full, waiting givers may fit now */
+    prvServeWaiters( pxMySemaphore, pxHigherPriorityTaskWoken );
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Block on pxWaitList for uxUnits until served by the other side or until
+ * the deadline in pxTimeOut passes. Must be called inside a critical section
+ * and returns inside it. Whether the task was served is decided under the
+ * critical section, so a wake that races with the timeout is never lost.
+ * Kernel calls that enter a task level critical section are made between
+ * leaving and re-entering it */
+static BaseType_t prvWaitOnList( MySemaphoreHandle_t pxMySemaphore,
+                                 MySemaphoreWaitList_t* pxWaitList,
+                                 UBaseType_t uxUnits,
+                                 TimeOut_t* const pxTimeOut,
+                                 TickType_t* const pxTicksToWait,
+                                 BaseType_t* pxYieldRequired )
+{
+    MySemaphoreWaiter_t xWaiter;
+    BaseType_t xServed;
+
+    #if ( configMYQUEUE_STATS == 1 )
+        TickType_t xWaitStart = xTaskGetTickCountFromISR();
+    #endif
+
+    xWaiter.xTask = xTaskGetCurrentTaskHandle();
+    xWaiter.uxPriority = uxTaskPriorityGetFromISR( NULL );
+    xWaiter.uxUnits = uxUnits;
+
+    prvWaitListInsert( pxWaitList, &xWaiter );
+
+    for( ;; )
+    {
+        /* Exit critical section to allow task to be notified */
+        mysemaphoreEXIT_CRITICAL( pxMySemaphore );
+        uint32_t ulNotifiedValue = ulTaskNotifyTakeIndexed( configMYSEMAPHORE_NOTIFICATION_INDEX,
+                                                            pdTRUE, *pxTicksToWait );
+
+        /* Also leaves the time that is left for the caller's next wait */
+        BaseType_t xTimedOut = xTaskCheckForTimeOut( pxTimeOut, pxTicksToWait );
+        mysemaphoreENTER_CRITICAL( pxMySemaphore );
+
+        if( xWaiter.pxContainer == NULL )
+        {
+            /* Served, so the other side has already moved the units for us.
+             * If that happened after the wait timed out its notification is
+             * still pending and must not cut a later wait short */
+            if( ulNotifiedValue == 0 )
+            {
+                mysemaphoreEXIT_CRITICAL( pxMySemaphore );
+                ( void ) ulTaskNotifyTakeIndexed( configMYSEMAPHORE_NOTIFICATION_INDEX, pdTRUE, 0 );
+                mysemaphoreENTER_CRITICAL( pxMySemaphore );
+            }
+
+            xServed = pdTRUE;
+            break;
+        }
+
+        /* Still waiting, so this was a timeout, or an application notification
+         * if configMYSEMAPHORE_NOTIFICATION_INDEX is shared with it. Only give
+         * up once the whole deadline has passed */
+        if( xTimedOut != pdFALSE )
+        {
+            prvWaitListRemove( &xWaiter );
+
+            /* Smaller requests queued behind ours may fit now */
+            prvServeWaiters( pxMySemaphore, pxYieldRequired );
+
+            xServed = pdFALSE;
+            break;
+        }
+    }
+
+    #if ( configMYQUEUE_STATS == 1 )
+    {
+        TickType_t xWaited = xTaskGetTickCountFromISR() - xWaitStart;
+
+        if( pxWaitList == &( pxMySemaphore->xWaitingTakers ) )
+        {
+            pxMySemaphore->xStats.uxBlockedTakes++;
+        }
+        else
+        {
+            pxMySemaphore->xStats.uxBlockedGives++;
+        }
+
+        pxMySemaphore->xStats.xTotalBlockedTicks += xWaited;
+
+        if( xWaited > pxMySemaphore->xStats.xMaxBlockedTicks )
+        {
+            pxMySemaphore->xStats.xMaxBlockedTicks = xWaited;
+        }
+    }
+    #endif
+
+    return xServed;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreTakeNWithTimeOut( MySemaphoreHandle_t pxMySemaphore,
+                                         UBaseType_t uxUnits,
+                                         TimeOut_t* const pxTimeOut,
+                                         TickType_t* const pxTicksToWait )
 {
     /* Check semaphore is non-null */
     configASSERT( pxMySemaphore );
+    configASSERT( pxTimeOut );
+    configASSERT( pxTicksToWait );
+    /* A request larger than the semaphore could never be served */
+    configASSERT( uxUnits > 0 && uxUnits <= pxMySemaphore->uxMaxCount );
+
+    /* A mutex is held by one task at a time */
+    configASSERT( pxMySemaphore->ucIsMutex == pdFALSE || uxUnits == 1 );
+
+    BaseType_t xYieldRequired = pdFALSE;
+    BaseType_t xTaken = pdTRUE;
 
     /* Semaphore modification operations must be done under critical sections */
-    taskENTER_CRITICAL();
+    mysemaphoreENTER_CRITICAL( pxMySemaphore );
 
-    if( pxMySemaphore->uxCount < pxMySemaphore->uxMaxCount )
+    /* If enough of the resource is available and no higher priority taker is
+     * waiting for it, take it. Otherwise wait to be served by a giver */
+    if( prvTakeN( pxMySemaphore, uxUnits, pdTRUE, &xYieldRequired ) == pdFALSE )
     {
-        /* Semaphore resource is not full so give */
-        ( pxMySemaphore->uxCount )++;
+        if( pxMySemaphore->uxCount >= uxUnits )
+        {
+            mysemaphoreSTATS_ADD( pxMySemaphore, uxContended, 1 );
+        }
 
-        /* Since resource can no longer be empty, if there are any waiting
-         * takers, they are now able to take the resource */
-        if( listLIST_IS_EMPTY( &( pxMySemaphore->xWaitingTakers ) ) == pdFALSE )
+        if( *pxTicksToWait == 0 )
         {
-            /* Notify the next taker that semaphore is ready. Next taker takes
-             * semaphore, decrementing count of the semaphore */
-            vTaskPopFromSemaphoreList( &( pxMySemaphore->xWaitingTakers ) );
-            ( pxMySemaphore->uxCount )--;
+            xTaken = pdFALSE;
         }
+        else
+        {
+            #if ( configUSE_MUTEXES == 1 )
+                /* Lend our priority to the holder so that it cannot be held
+                 * up by tasks of lower priority than ours */
+                if( pxMySemaphore->xMutexHolder != NULL )
+                {
+                    ( void ) xTaskPriorityInherit( pxMySemaphore->xMutexHolder );
+                }
+            #endif
 
-        taskEXIT_CRITICAL();
-        return pdTRUE;
-    }
+            xTaken = prvWaitOnList( pxMySemaphore, &( pxMySemaphore->xWaitingTakers ), uxUnits,
+                                    pxTimeOut, pxTicksToWait, &xYieldRequired );
 
-    /* Semaphore resource full so add to list of waiting givers */
-    vTaskPlaceOnSemaphoreList( &( pxMySemaphore->xWaitingGivers ) );
+            #if ( configUSE_MUTEXES == 1 )
+                /* Take back only the priority no other waiter still needs */
+                if( xTaken == pdFALSE && pxMySemaphore->xMutexHolder != NULL )
+                {
+                    MySemaphoreWaiter_t* pxTaker = prvWaitListHead( &( pxMySemaphore->xWaitingTakers ) );
 
-    /* Exit critical section to allow task to be notified */
-    taskEXIT_CRITICAL();
+                    vTaskPriorityDisinheritAfterTimeout( pxMySemaphore->xMutexHolder,
+                                                         ( pxTaker != NULL ) ? pxTaker->uxPriority : tskIDLE_PRIORITY );
+                }
+            #endif
+        }
+    }
 
-    /* Wait to be notified that resource is not full with timeout */
-    uint32_t ulNotifiedValue = ulTaskNotifyTake( pdTRUE, xTicksToWait );
+    #if ( configUSE_MUTEXES == 1 )
+        if( xTaken != pdFALSE && pxMySemaphore->ucIsMutex != pdFALSE )
+        {
+            /* A waiter was made holder when it was served */
+            pxMySemaphore->xMutexHolder = pvTaskIncrementMutexHeldCount();
+        }
+    #endif
 
-    /* Task is now unblocked. If semaphore was given, ulNotifiedValue will be
-     * non-zero and take function will have already incremented semaphore count */
-    if( ulNotifiedValue > 0)
+    if( xTaken == pdFALSE )
     {
-        return pdTRUE;
+        mysemaphoreSTATS_ADD( pxMySemaphore, uxTakeTimeouts, 1 );
     }
 
-    /* If semaphore was not given, remove task from waiting givers */
-    vTaskRemoveFromSemaphoreList( &( pxMySemaphore->xWaitingGivers ) );
-    return pdFALSE;
+    mysemaphoreEXIT_CRITICAL( pxMySemaphore );
+
+    #if ( configUSE_PREEMPTION != 0 )
+        if( xYieldRequired != pdFALSE )
+        {
+            portYIELD_WITHIN_API();
+        }
+    #endif
+
+    return xTaken;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xMySemaphoreTakeFromISR( MySemaphoreHandle_t pxMySemaphore,
-                                    BaseType_t* pxHigherPriorityTaskWoken )
+BaseType_t xMySemaphoreGiveNWithTimeOut( MySemaphoreHandle_t pxMySemaphore,
+                                         UBaseType_t uxUnits,
+                                         TimeOut_t* const pxTimeOut,
+                                         TickType_t* const pxTicksToWait )
 {
-    /* Taking semaphore from ISR works exactly the same as without ISR except
-     * we do not wait for semaphore if it is empty */
+    /* Check semaphore is non-null */
     configASSERT( pxMySemaphore );
+    configASSERT( pxTimeOut );
+    configASSERT( pxTicksToWait );
+    /* A request larger than the semaphore could never be served */
+    configASSERT( uxUnits > 0 && uxUnits <= pxMySemaphore->uxMaxCount );
 
-    BaseType_t taken = pdFALSE;
+    BaseType_t xYieldRequired = pdFALSE;
+    BaseType_t xGiven = pdTRUE;
 
-    /* ISR must use special critical section */
-    UBaseType_t xSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
-
-    if( pxMySemaphore->uxCount > 0 )
-    {
-        ( pxMySemaphore->uxCount )--;
+    /* Semaphore modification operations must be done under critical sections */
+    mysemaphoreENTER_CRITICAL( pxMySemaphore );
 
-        if( listLIST_IS_EMPTY( &( pxMySemaphore->xWaitingGivers ) ) == pdFALSE )
+    #if ( configUSE_MUTEXES == 1 )
+        if( pxMySemaphore->ucIsMutex != pdFALSE )
         {
-            BaseType_t xWoken =
-                xTaskPopFromSemaphoreListFromISR( &( pxMySemaphore->xWaitingGivers ) );
-            ( pxMySemaphore->uxCount )++;
+            /* Only the holder may give a mutex, so there is always room */
+            configASSERT( uxUnits == 1 );
+            configASSERT( pxMySemaphore->xMutexHolder == xTaskGetCurrentTaskHandle() );
 
-            /* Set pxHigherPriorityTaskWoken if not NULL */
-            if ( pxHigherPriorityTaskWoken != NULL )
+            /* Drop any priority lent to us before the mutex changes hands */
+            if( xTaskPriorityDisinherit( pxMySemaphore->xMutexHolder ) != pdFALSE )
             {
-                *pxHigherPriorityTaskWoken = xWoken;
+                xYieldRequired = pdTRUE;
             }
+
+            pxMySemaphore->xMutexHolder = NULL;
         }
+    #endif
 
-        taken = pdTRUE;
+    /* If there is room and no higher priority giver is waiting for it, give.
+     * Otherwise wait to be served by a taker */
+    if( prvMayGoFirst( &( pxMySemaphore->xWaitingGivers ), pdTRUE ) == pdFALSE ||
+        xMySemaphoreGiveNFromCritical( pxMySemaphore, uxUnits, &xYieldRequired ) == pdFALSE )
+    {
+        if( pxMySemaphore->uxMaxCount - pxMySemaphore->uxCount >= uxUnits )
+        {
+            mysemaphoreSTATS_ADD( pxMySemaphore, uxContended, 1 );
+        }
+
+        xGiven = ( *pxTicksToWait != 0 ) ?
+                 prvWaitOnList( pxMySemaphore, &( pxMySemaphore->xWaitingGivers ), uxUnits,
+                                pxTimeOut, pxTicksToWait, &xYieldRequired ) :
+                 pdFALSE;
     }
 
-    taskEXIT_CRITICAL_FROM_ISR( xSavedInterruptStatus );
-    return taken;
+    if( xGiven == pdFALSE )
+    {
+        mysemaphoreSTATS_ADD( pxMySemaphore, uxGiveTimeouts, 1 );
+    }
+
+    mysemaphoreEXIT_CRITICAL( pxMySemaphore );
+
+    #if ( configUSE_PREEMPTION != 0 )
+        if( xYieldRequired != pdFALSE )
+        {
+            portYIELD_WITHIN_API();
+        }
+    #endif
+
+    return xGiven;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xMySemaphoreGiveFromISR( MySemaphoreHandle_t pxMySemaphore,
-                                    BaseType_t* pxHigherPriorityTaskWoken )
+BaseType_t xMySemaphoreTakeWithTimeOut( MySemaphoreHandle_t pxMySemaphore,
+                                        TimeOut_t* const pxTimeOut,
+                                        TickType_t* const pxTicksToWait )
+{
+    return xMySemaphoreTakeNWithTimeOut( pxMySemaphore, 1, pxTimeOut, pxTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreGiveWithTimeOut( MySemaphoreHandle_t pxMySemaphore,
+                                        TimeOut_t* const pxTimeOut,
+                                        TickType_t* const pxTicksToWait )
+{
+    return xMySemaphoreGiveNWithTimeOut( pxMySemaphore, 1, pxTimeOut, pxTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreTakeN( MySemaphoreHandle_t pxMySemaphore,
+                              UBaseType_t uxUnits,
+                              TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+
+    /* The deadline is measured from here */
+    vTaskSetTimeOutState( &xTimeOut );
+
+    return xMySemaphoreTakeNWithTimeOut( pxMySemaphore, uxUnits, &xTimeOut, &xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreGiveN( MySemaphoreHandle_t pxMySemaphore,
+                              UBaseType_t uxUnits,
+                              TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+
+    /* The deadline is measured from here */
+    vTaskSetTimeOutState( &xTimeOut );
+
+    return xMySemaphoreGiveNWithTimeOut( pxMySemaphore, uxUnits, &xTimeOut, &xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreTake( MySemaphoreHandle_t pxMySemaphore,
+                             TickType_t xTicksToWait )
+{
+    return xMySemaphoreTakeN( pxMySemaphore, 1, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreGive( MySemaphoreHandle_t pxMySemaphore,
+                             TickType_t xTicksToWait )
+{
+    return xMySemaphoreGiveN( pxMySemaphore, 1, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreTakeNFromISR( MySemaphoreHandle_t pxMySemaphore,
+                                     UBaseType_t uxUnits,
+                                     BaseType_t* pxHigherPriorityTaskWoken )
 {
     /* Taking semaphore from ISR works exactly the same as without ISR except
-     * we do not wait for semaphore if it is full */
+     * we do not wait for semaphore if it is empty */
     configASSERT( pxMySemaphore );
-
-    BaseType_t given = pdFALSE;
+    /* Mutexes are only for tasks */
+    configASSERT( pxMySemaphore->ucIsMutex == pdFALSE );
 
     /* ISR must use special critical section */
-    UBaseType_t xSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    UBaseType_t xSavedInterruptStatus = mysemaphoreENTER_CRITICAL_FROM_ISR( pxMySemaphore );
+    BaseType_t taken =
+        xMySemaphoreTakeNFromCritical( pxMySemaphore, uxUnits, pxHigherPriorityTaskWoken );
 
-    if( pxMySemaphore->uxCount < pxMySemaphore->uxMaxCount )
+    if( taken == pdFALSE )
     {
-        ( pxMySemaphore->uxCount )++;
+        mysemaphoreSTATS_ADD( pxMySemaphore, uxTakeTimeouts, 1 );
+    }
 
-        if ( listLIST_IS_EMPTY( &( pxMySemaphore->xWaitingTakers ) ) == pdFALSE )
-        {
-            BaseType_t xWoken =
-                xTaskPopFromSemaphoreListFromISR( &( pxMySemaphore->xWaitingTakers ) );
+    mysemaphoreEXIT_CRITICAL_FROM_ISR( pxMySemaphore, xSavedInterruptStatus );
 
-            // Set HigherPriorityTaskWoken indicator here if not NULL
-            if ( pxHigherPriorityTaskWoken != NULL )
-            {
-                *pxHigherPriorityTaskWoken = xWoken;
-            }
+    return taken;
+}
+/*-----------------------------------------------------------*/
 
-            ( pxMySemaphore->uxCount )--;
-        }
+BaseType_t xMySemaphoreGiveNFromISR( MySemaphoreHandle_t pxMySemaphore,
+                                     UBaseType_t uxUnits,
+                                     BaseType_t* pxHigherPriorityTaskWoken )
+{
+    /* Giving semaphore from ISR works exactly the same as without ISR except
+     * we do not wait for semaphore if it is full */
+    configASSERT( pxMySemaphore );
+    /* Mutexes are only for tasks */
+    configASSERT( pxMySemaphore->ucIsMutex == pdFALSE );
+
+    /* ISR must use special critical section */
+    UBaseType_t xSavedInterruptStatus = mysemaphoreENTER_CRITICAL_FROM_ISR( pxMySemaphore );
+    BaseType_t given =
+        xMySemaphoreGiveNFromCritical( pxMySemaphore, uxUnits, pxHigherPriorityTaskWoken );
 
-        given = pdTRUE;
+    if( given == pdFALSE )
+    {
+        mysemaphoreSTATS_ADD( pxMySemaphore, uxGiveTimeouts, 1 );
     }
 
-    taskEXIT_CRITICAL_FROM_ISR( xSavedInterruptStatus );
+    mysemaphoreEXIT_CRITICAL_FROM_ISR( pxMySemaphore, xSavedInterruptStatus );
+
     return given;
 }
 /*-----------------------------------------------------------*/
 
+UBaseType_t uxMySemaphoreGiveUpToFromISR( MySemaphoreHandle_t pxMySemaphore,
+                                          UBaseType_t uxUnits,
+                                          BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMySemaphore );
+    /* Mutexes are only for tasks */
+    configASSERT( pxMySemaphore->ucIsMutex == pdFALSE );
+
+    UBaseType_t xSavedInterruptStatus = mysemaphoreENTER_CRITICAL_FROM_ISR( pxMySemaphore );
+    UBaseType_t uxGiven =
+        uxMySemaphoreGiveUpToFromCritical( pxMySemaphore, uxUnits, pxHigherPriorityTaskWoken );
+
+    if( uxGiven == 0 && uxUnits > 0 )
+    {
+        mysemaphoreSTATS_ADD( pxMySemaphore, uxGiveTimeouts, 1 );
+    }
+
+    mysemaphoreEXIT_CRITICAL_FROM_ISR( pxMySemaphore, xSavedInterruptStatus );
+
+    return uxGiven;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreTakeFromISR( MySemaphoreHandle_t pxMySemaphore,
+                                    BaseType_t* pxHigherPriorityTaskWoken )
+{
+    return xMySemaphoreTakeNFromISR( pxMySemaphore, 1, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreGiveFromISR( MySemaphoreHandle_t pxMySemaphore,
+                                    BaseType_t* pxHigherPriorityTaskWoken )
+{
+    return xMySemaphoreGiveNFromISR( pxMySemaphore, 1, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xMySemaphoreTakeAvailableFromISR( MySemaphoreHandle_t pxMySemaphore )
 {
     configASSERT( pxMySemaphore );
 
-    UBaseType_t xSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    UBaseType_t xSavedInterruptStatus = mysemaphoreENTER_CRITICAL_FROM_ISR( pxMySemaphore );
     BaseType_t xAvailable = ( pxMySemaphore->uxCount > 0 ) ? pdTRUE : pdFALSE;
-    taskEXIT_CRITICAL_FROM_ISR( xSavedInterruptStatus );
+    mysemaphoreEXIT_CRITICAL_FROM_ISR( pxMySemaphore, xSavedInterruptStatus );
     return xAvailable;
 }
 /*-----------------------------------------------------------*/
@@ -234,9 +964,183 @@ BaseType_t xMySemaphoreGiveAvailableFromISR( MySemaphoreHandle_t pxMySemaphore )
 {
     configASSERT( pxMySemaphore );
 
-    UBaseType_t xSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    UBaseType_t xSavedInterruptStatus = mysemaphoreENTER_CRITICAL_FROM_ISR( pxMySemaphore );
     BaseType_t xAvailable =
         ( pxMySemaphore->uxCount < pxMySemaphore->uxMaxCount ) ? pdTRUE : pdFALSE;
-    taskEXIT_CRITICAL_FROM_ISR( xSavedInterruptStatus );
+    mysemaphoreEXIT_CRITICAL_FROM_ISR( pxMySemaphore, xSavedInterruptStatus );
     return xAvailable;
 }
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreTakeNFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                          UBaseType_t uxUnits,
+                                          BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMySemaphore );
+
+    /* The caller may be an ISR, so always defer to queued takers */
+    return prvTakeN( pxMySemaphore, uxUnits, pdFALSE, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreGiveNFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                          UBaseType_t uxUnits,
+                                          BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMySemaphore );
+
+    if( pxMySemaphore->uxMaxCount - pxMySemaphore->uxCount < uxUnits )
+    {
+        return pdFALSE;
+    }
+
+    pxMySemaphore->uxCount += uxUnits;
+    mysemaphoreSTATS_ADD( pxMySemaphore, uxGives, uxUnits );
+
+    #if ( configUSE_QUEUE_SETS == 1 )
+        prvNotifyQueueSetContainer( pxMySemaphore, uxUnits, pxHigherPriorityTaskWoken );
+    #endif
+
+    /* Since resource can no longer be empty, waiting takers may fit now */
+    prvServeWaiters( pxMySemaphore, pxHigherPriorityTaskWoken );
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreTakeFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                         BaseType_t* pxHigherPriorityTaskWoken )
+{
+    return xMySemaphoreTakeNFromCritical( pxMySemaphore, 1, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMySemaphoreGiveFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                         BaseType_t* pxHigherPriorityTaskWoken )
+{
+    return xMySemaphoreGiveNFromCritical( pxMySemaphore, 1, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMySemaphoreTakeUpToFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                               UBaseType_t uxUnits,
+                                               BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMySemaphore );
+
+    /* Same as xMySemaphoreTakeNFromCritical, taking what is left over would
+     * starve a larger waiter */
+    if( prvMayGoFirst( &( pxMySemaphore->xWaitingTakers ), pdFALSE ) == pdFALSE )
+    {
+        return 0;
+    }
+
+    UBaseType_t uxTaken = ( pxMySemaphore->uxCount < uxUnits ) ? pxMySemaphore->uxCount : uxUnits;
+    pxMySemaphore->uxCount -= uxTaken;
+    mysemaphoreSTATS_ADD( pxMySemaphore, uxTakes, uxTaken );
+
+    /* Since resource can no longer be full, waiting givers may fit now */
+    if( uxTaken > 0 )
+    {
+        prvServeWaiters( pxMySemaphore, pxHigherPriorityTaskWoken );
+    }
+
+    return uxTaken;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMySemaphoreGiveUpToFromCritical( MySemaphoreHandle_t pxMySemaphore,
+                                               UBaseType_t uxUnits,
+                                               BaseType_t* pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxMySemaphore );
+
+    UBaseType_t uxSpace = pxMySemaphore->uxMaxCount - pxMySemaphore->uxCount;
+    UBaseType_t uxGiven = ( uxSpace < uxUnits ) ? uxSpace : uxUnits;
+    pxMySemaphore->uxCount += uxGiven;
+    mysemaphoreSTATS_ADD( pxMySemaphore, uxGives, uxGiven );
+
+    /* Since resource can no longer be empty, waiting takers may fit now */
+    if( uxGiven > 0 )
+    {
+        #if ( configUSE_QUEUE_SETS == 1 )
+            prvNotifyQueueSetContainer( pxMySemaphore, uxGiven, pxHigherPriorityTaskWoken );
+        #endif
+
+        prvServeWaiters( pxMySemaphore, pxHigherPriorityTaskWoken );
+    }
+
+    return uxGiven;
+}
+/*-----------------------------------------------------------*/
+
+TaskHandle_t xMySemaphoreGetNextTakerFromCritical( MySemaphoreHandle_t pxMySemaphore )
+{
+    configASSERT( pxMySemaphore );
+
+    MySemaphoreWaiter_t* pxTaker = prvWaitListHead( &( pxMySemaphore->xWaitingTakers ) );
+
+    return ( pxTaker != NULL ) ? pxTaker->xTask : NULL;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMySemaphoreGetCountFromCritical( MySemaphoreHandle_t pxMySemaphore )
+{
+    configASSERT( pxMySemaphore );
+
+    return pxMySemaphore->uxCount;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+    BaseType_t xMySemaphoreLinkToSet( MySemaphoreHandle_t pxMySemaphore,
+                                      struct MyQueueDefinition* pxQueueSet,
+                                      void* pvSetMember )
+    {
+        configASSERT( pxMySemaphore );
+        configASSERT( pxQueueSet );
+        /* Priority inheritance cannot follow a task that waits on a set */
+        configASSERT( pxMySemaphore->ucIsMutex == pdFALSE );
+
+        BaseType_t xLinked = pdFALSE;
+
+        mysemaphoreENTER_CRITICAL( pxMySemaphore );
+
+        /* Units given before joining would never be reported to the set */
+        if( pxMySemaphore->pxQueueSetContainer == NULL && pxMySemaphore->uxCount == 0 )
+        {
+            pxMySemaphore->pxQueueSetContainer = pxQueueSet;
+            pxMySemaphore->pvQueueSetMember = pvSetMember;
+            xLinked = pdTRUE;
+        }
+
+        mysemaphoreEXIT_CRITICAL( pxMySemaphore );
+
+        return xLinked;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xMySemaphoreUnlinkFromSet( MySemaphoreHandle_t pxMySemaphore,
+                                          struct MyQueueDefinition* pxQueueSet )
+    {
+        configASSERT( pxMySemaphore );
+
+        BaseType_t xUnlinked = pdFALSE;
+
+        mysemaphoreENTER_CRITICAL( pxMySemaphore );
+
+        /* Entries for units still available would be left behind in the set */
+        if( pxMySemaphore->pxQueueSetContainer == pxQueueSet && pxMySemaphore->uxCount == 0 )
+        {
+            pxMySemaphore->pxQueueSetContainer = NULL;
+            pxMySemaphore->pvQueueSetMember = NULL;
+            xUnlinked = pdTRUE;
+        }
+
+        mysemaphoreEXIT_CRITICAL( pxMySemaphore );
+
+        return xUnlinked;
+    }
+
+#endif /* configUSE_QUEUE_SETS */
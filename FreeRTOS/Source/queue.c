@@ -42,6 +42,10 @@
     #include "croutine.h"
 #endif
 
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+    #include "atomic.h"
+#endif
+
 /* Lint e9021, e961 and e750 are suppressed as a MISRA exception justified
  * because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
  * for the header files above, but not in this file, in order to generate the
@@ -78,11 +82,33 @@ typedef struct SemaphoreData
     UBaseType_t uxRecursiveCallCount; /**< Maintains a count of the number of times a recursive mutex has been recursively 'taken' when the structure is used as a mutex. */
 } SemaphoreData_t;
 
+/* A read write lock keeps the number of tasks holding it for reading in
+ * uxMessagesWaiting.  Tasks waiting to read are held in
+ * xTasksWaitingToReceive and tasks waiting to write in xTasksWaitingToSend. */
+typedef struct ReadWriteLockData
+{
+    TaskHandle_t xWriter;          /**< The handle of the task that holds the lock for writing, or NULL. */
+    UBaseType_t uxWritersWaiting;  /**< The number of tasks that are waiting to write.  New readers are held off while it is not 0. */
+} ReadWriteLockData_t;
+
 /* Semaphores do not actually store or copy data, so have an item size of
  * zero. */
 #define queueSEMAPHORE_QUEUE_ITEM_LENGTH    ( ( UBaseType_t ) 0 )
 #define queueMUTEX_GIVE_BLOCK_TIME          ( ( TickType_t ) 0U )
 
+/* The queue length of a read write lock, which is the most tasks that can hold
+ * it for reading at once. */
+#define queueREAD_WRITE_LOCK_MAX_READERS    ( ~( ( UBaseType_t ) 0U ) )
+
+/* A read write lock looks like a counting semaphore of the length above, so
+ * its pcHead is pointed at the union that holds its state instead of at the
+ * queue itself to tell the two apart, much as NULL marks a mutex. */
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+    #define prvIsReadWriteLock( pxQueue )    ( ( ( pxQueue )->uxQueueType == ( int8_t * ) &( ( pxQueue )->u ) ) ? pdTRUE : pdFALSE )
+#else
+    #define prvIsReadWriteLock( pxQueue )    pdFALSE
+#endif
+
 #if ( configUSE_PREEMPTION == 0 )
 
 /* If the cooperative scheduler is being used then a yield should not be
@@ -110,6 +136,9 @@ typedef struct QueueDefinition /* The old naming convention is used to prevent b
     {
         QueuePointers_t xQueue;     /**< Data required exclusively when this structure is used as a queue. */
         SemaphoreData_t xSemaphore; /**< Data required exclusively when this structure is used as a semaphore. */
+        #if ( configUSE_READ_WRITE_LOCKS == 1 )
+            ReadWriteLockData_t xReadWriteLock; /**< Data required exclusively when this structure is used as a read write lock. */
+        #endif
     } u;
 
     List_t xTasksWaitingToSend;             /**< List of tasks that are blocked waiting to post onto this queue.  Stored in priority order. */
@@ -134,6 +163,19 @@ typedef struct QueueDefinition /* The old naming convention is used to prevent b
         UBaseType_t uxQueueNumber;
         uint8_t ucQueueType;
     #endif
+
+    /* While a slot is handed out, uxLength is reduced by the number of slots
+     * it keeps out of use so the normal space checks never reach them. */
+    #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+        int8_t * pcReserved;       /**< The slot handed out by xQueueReserve() and not yet committed, or NULL. */
+        int8_t * pcAcquired;       /**< The slot handed out by xQueueAcquire() and not yet released, or NULL. */
+        UBaseType_t uxUnpublished; /**< Items sent to the back of the queue behind pcReserved.  They become receivable when it is committed. */
+        UBaseType_t uxUnreleased;  /**< Slots read behind pcAcquired.  They become free when it is released. */
+    #endif
+
+    #if ( configUSE_MUTEX_PRIORITY_CEILING == 1 )
+        UBaseType_t uxCeilingPriority; /**< The priority a task is raised to while it holds the mutex, or 0 if the mutex uses priority inheritance instead. */
+    #endif
 } xQUEUE;
 
 /* The old xQUEUE name is maintained above then typedefed to the new Queue_t
@@ -207,6 +249,85 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
 static void prvCopyDataFromQueue( Queue_t * const pxQueue,
                                   void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Copies uxCount items to the back of the queue, or out of the front of it,
+ * with at most two memcpy() calls.  The caller must have checked there is
+ * enough space (or there are enough items).
+ */
+static void prvCopyMultipleToQueue( Queue_t * const pxQueue,
+                                    const int8_t * pcItemsToQueue,
+                                    const UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+static void prvCopyMultipleFromQueue( Queue_t * const pxQueue,
+                                      int8_t * pcBuffer,
+                                      const UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Removes up to uxMaxTasks tasks from pxEventList, one for each item that
+ * was sent or received, stopping early if the list empties.  Must be called
+ * from a critical section with the queue unlocked.
+ *
+ * @return pdTRUE if any task removed has a higher priority than the calling
+ * task, otherwise pdFALSE.
+ */
+static BaseType_t prvUnblockMultiple( List_t * const pxEventList,
+                                      UBaseType_t uxMaxTasks ) PRIVILEGED_FUNCTION;
+
+/*
+ * Lets tasks waiting for data (or the queue set the queue is in) know that
+ * uxItemsSent items were just added to the queue.  Must be called from a
+ * critical section with the queue unlocked.
+ *
+ * @return pdTRUE if a context switch is required, otherwise pdFALSE.
+ */
+static BaseType_t prvNotifyItemsSent( Queue_t * const pxQueue,
+                                      UBaseType_t uxItemsSent ) PRIVILEGED_FUNCTION;
+
+#if ( configUSE_QUEUE_ZERO_COPY == 1 )
+
+/*
+ * Called from a critical section after uxCount items have been written to the
+ * back of the queue.  If a slot is reserved the items are behind it, so they
+ * are held back until it is committed instead of being made receivable.
+ *
+ * @return pdTRUE if the items were held back, otherwise pdFALSE.
+ */
+    static BaseType_t prvHoldBackSentItems( Queue_t * const pxQueue,
+                                            const UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called from a critical section after uxCount items have been removed from
+ * the queue.  If a slot is acquired the freed slots are behind it, and cannot
+ * be written until it is released.
+ */
+    static void prvHoldBackFreedSlots( Queue_t * const pxQueue,
+                                       const UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+#endif
+
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+
+/*
+ * Take or give an uncontended mutex with a single compare-and-swap on
+ * xMutexHolder instead of a critical section.
+ *
+ * @return pdTRUE if the mutex was taken or given, otherwise pdFALSE, in which
+ * case the caller must use the slow path.
+ */
+    static BaseType_t prvTakeMutexFast( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+    static BaseType_t prvGiveMutexFast( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called from a critical section by a task that wants a semaphore.  If the
+ * semaphore is a mutex held through the fast path, the holder is counted and
+ * marked so it has to give the mutex back through the slow path, which wakes
+ * waiting tasks and disinherits any priority it inherits meanwhile.
+ *
+ * @return The semaphore count.
+ */
+    static UBaseType_t prvGetSemaphoreCount( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+#else
+    #define prvGetSemaphoreCount( pxQueue )    ( ( pxQueue )->uxMessagesWaiting )
+#endif
+
 #if ( configUSE_QUEUE_SETS == 1 )
 
 /*
@@ -246,6 +367,59 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
  */
     static UBaseType_t prvGetDisinheritPriorityAfterTimeout( const Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
 #endif
+
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+
+/*
+ * Sets up a queue created by xQueueCreateReadWriteLock() or
+ * xQueueCreateReadWriteLockStatic() as a free read write lock.
+ */
+    static void prvInitialiseReadWriteLock( Queue_t * pxNewQueue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Common implementation of xQueueTakeReadLock() and xQueueTakeWriteLock().
+ * Follows xQueueSemaphoreTake(), with readers waiting in
+ * xTasksWaitingToReceive and writers waiting in xTasksWaitingToSend.
+ */
+    static BaseType_t prvTakeReadWriteLock( Queue_t * const pxQueue,
+                                            TickType_t xTicksToWait,
+                                            const BaseType_t xWrite ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called from a critical section to determine if the calling task can take
+ * the lock for reading (xWrite is pdFALSE) or writing (xWrite is pdTRUE)
+ * without waiting.  A task cannot read while another task writes or waits to
+ * write, so a steady stream of readers cannot keep a writer out.
+ */
+    static BaseType_t prvIsReadWriteLockFree( const Queue_t * pxQueue,
+                                              const BaseType_t xWrite ) PRIVILEGED_FUNCTION;
+
+/*
+ * Uses a critical section to determine if the calling task would still have
+ * to wait for the lock.
+ */
+    static BaseType_t prvIsReadWriteLockBusy( const Queue_t * pxQueue,
+                                              const BaseType_t xWrite ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called once a task stops waiting for the lock without taking it.  Undoes
+ * any priority the writer inherited from the task and, if the task was the
+ * last waiting writer, lets the readers it held off take the lock.
+ */
+    static void prvAbandonReadWriteLockWait( Queue_t * const pxQueue,
+                                             const BaseType_t xWrite,
+                                             const BaseType_t xWaited,
+                                             const BaseType_t xInheritanceOccurred ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called from a critical section when the lock is released by its writer or
+ * last reader.  Unblocks a waiting writer if there is one, otherwise the
+ * waiting readers.
+ *
+ * @return pdTRUE if a context switch is required, otherwise pdFALSE.
+ */
+    static BaseType_t prvUnblockReadWriteLockWaiters( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -295,6 +469,77 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
             ( pxQueue )->cRxLock = ( int8_t ) ( ( cRxLock ) + ( int8_t ) 1 ); \
         }                                                                     \
     } while( 0 )
+
+/*
+ * Macro to copy a single item into or out of the queue storage area.  Items
+ * the size of a 32-bit or 64-bit word, which covers pointers and handles, are
+ * copied with a constant length so the compiler can replace the memcpy() call
+ * with a single load and store.  The pointers need not be aligned.
+ */
+#if ( configQUEUE_INLINE_ITEM_COPY == 1 )
+    #define prvCopyItem( pvDestination, pvSource, uxItemSize )                             \
+    do {                                                                                   \
+        if( ( uxItemSize ) == ( UBaseType_t ) sizeof( uint32_t ) )                         \
+        {                                                                                  \
+            ( void ) memcpy( ( pvDestination ), ( pvSource ), sizeof( uint32_t ) );        \
+        }                                                                                  \
+        else if( ( uxItemSize ) == ( UBaseType_t ) sizeof( uint64_t ) )                    \
+        {                                                                                  \
+            ( void ) memcpy( ( pvDestination ), ( pvSource ), sizeof( uint64_t ) );        \
+        }                                                                                  \
+        else                                                                               \
+        {                                                                                  \
+            ( void ) memcpy( ( pvDestination ), ( pvSource ), ( size_t ) ( uxItemSize ) ); \
+        }                                                                                  \
+    } while( 0 )
+#else
+    #define prvCopyItem( pvDestination, pvSource, uxItemSize ) \
+    ( void ) memcpy( ( pvDestination ), ( pvSource ), ( size_t ) ( uxItemSize ) )
+#endif
+
+/*
+ * With the mutex fast path an uncontended mutex is taken by swapping its
+ * xMutexHolder from NULL to the calling task, and given by swapping it back,
+ * leaving uxMessagesWaiting at 1 and the holder's mutex held count alone.  A
+ * mutex taken through the slow path, or converted to it by
+ * prvGetSemaphoreCount(), has the low bit of xMutexHolder set instead.  The
+ * fast give then fails and the holder gives the mutex through the slow path.
+ * Task control blocks are at least pointer aligned, so the bit is free.  A
+ * mutex in a queue set always uses the slow path, which notifies the set.
+ */
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+    #define queueMUTEX_HOLDER_COUNTED    ( ( portPOINTER_SIZE_TYPE ) 1U )
+
+    #define prvGetMutexHolder( pxQueue ) \
+    ( ( TaskHandle_t ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxQueue )->u.xSemaphore.xMutexHolder ) & ~queueMUTEX_HOLDER_COUNTED ) )
+
+    #define prvCountedMutexHolder( xMutexHolder ) \
+    ( ( TaskHandle_t ) ( ( ( portPOINTER_SIZE_TYPE ) ( xMutexHolder ) ) | queueMUTEX_HOLDER_COUNTED ) )
+
+    #if ( configUSE_QUEUE_SETS == 1 )
+        #define prvIsQueueInSet( pxQueue )    ( ( ( pxQueue )->pxQueueSetContainer != NULL ) ? pdTRUE : pdFALSE )
+    #else
+        #define prvIsQueueInSet( pxQueue )    pdFALSE
+    #endif
+
+    #define prvIsMutexHeldUncounted( pxQueue )                                                              \
+    ( ( ( pxQueue )->uxQueueType == queueQUEUE_IS_MUTEX ) && ( ( pxQueue )->u.xSemaphore.xMutexHolder != NULL ) && \
+      ( ( ( ( portPOINTER_SIZE_TYPE ) ( pxQueue )->u.xSemaphore.xMutexHolder ) & queueMUTEX_HOLDER_COUNTED ) == 0U ) )
+#else
+    #define prvGetMutexHolder( pxQueue )               ( ( pxQueue )->u.xSemaphore.xMutexHolder )
+    #define prvCountedMutexHolder( xMutexHolder )      ( xMutexHolder )
+#endif
+
+/*
+ * A task that takes a mutex created with xSemaphoreCreateMutexWithCeiling() is
+ * raised to the ceiling priority straight away, so tasks waiting for the mutex
+ * do not raise the holder's priority through priority inheritance.
+ */
+#if ( configUSE_MUTEX_PRIORITY_CEILING == 1 )
+    #define prvHasPriorityCeiling( pxQueue )    ( ( ( pxQueue )->uxCeilingPriority != ( UBaseType_t ) 0 ) ? pdTRUE : pdFALSE )
+#else
+    #define prvHasPriorityCeiling( pxQueue )    pdFALSE
+#endif
 /*-----------------------------------------------------------*/
 
 BaseType_t xQueueGenericReset( QueueHandle_t xQueue,
@@ -310,6 +555,18 @@ BaseType_t xQueueGenericReset( QueueHandle_t xQueue,
         /* Check for multiplication overflow. */
         ( ( SIZE_MAX / pxQueue->uxLength ) >= pxQueue->uxItemSize ) )
     {
+        #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+        {
+            /* uxLength does not hold the full length of the queue while one
+             * of its slots is handed out. */
+            configASSERT( ( xNewQueue != pdFALSE ) || ( ( pxQueue->pcReserved == NULL ) && ( pxQueue->pcAcquired == NULL ) ) );
+        }
+        #endif
+
+        /* A read write lock keeps its state where the queue pointers would
+         * be, so it cannot be reset once created. */
+        configASSERT( ( xNewQueue != pdFALSE ) || ( prvIsReadWriteLock( pxQueue ) == pdFALSE ) );
+
         taskENTER_CRITICAL();
         {
             pxQueue->u.xQueue.pcTail = pxQueue->pcHead + ( pxQueue->uxLength * pxQueue->uxItemSize ); /*lint !e9016 Pointer arithmetic allowed on char types, especially when it assists conveying intent. */
@@ -586,6 +843,21 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
     }
     #endif /* configUSE_QUEUE_SETS */
 
+    #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+    {
+        pxNewQueue->pcReserved = NULL;
+        pxNewQueue->pcAcquired = NULL;
+        pxNewQueue->uxUnpublished = ( UBaseType_t ) 0U;
+        pxNewQueue->uxUnreleased = ( UBaseType_t ) 0U;
+    }
+    #endif /* configUSE_QUEUE_ZERO_COPY */
+
+    #if ( configUSE_MUTEX_PRIORITY_CEILING == 1 )
+    {
+        pxNewQueue->uxCeilingPriority = ( UBaseType_t ) 0U;
+    }
+    #endif /* configUSE_MUTEX_PRIORITY_CEILING */
+
     traceQUEUE_CREATE( pxNewQueue );
 }
 /*-----------------------------------------------------------*/
@@ -657,6 +929,118 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( ( configUSE_MUTEX_PRIORITY_CEILING == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+    QueueHandle_t xQueueCreateMutexWithCeiling( const UBaseType_t uxCeilingPriority )
+    {
+        Queue_t * pxNewQueue;
+        const UBaseType_t uxMutexLength = ( UBaseType_t ) 1, uxMutexSize = ( UBaseType_t ) 0;
+
+        /* The idle priority cannot be a ceiling as it is used to mean the mutex
+         * has no ceiling. */
+        configASSERT( uxCeilingPriority > tskIDLE_PRIORITY );
+        configASSERT( uxCeilingPriority < ( UBaseType_t ) configMAX_PRIORITIES );
+
+        pxNewQueue = ( Queue_t * ) xQueueGenericCreate( uxMutexLength, uxMutexSize, queueQUEUE_TYPE_MUTEX );
+
+        if( pxNewQueue != NULL )
+        {
+            pxNewQueue->uxCeilingPriority = uxCeilingPriority;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        prvInitialiseMutex( pxNewQueue );
+
+        return ( QueueHandle_t ) pxNewQueue;
+    }
+
+#endif /* ( ( configUSE_MUTEX_PRIORITY_CEILING == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) ) */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_MUTEX_PRIORITY_CEILING == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+    QueueHandle_t xQueueCreateMutexWithCeilingStatic( const UBaseType_t uxCeilingPriority,
+                                                      StaticQueue_t * pxStaticQueue )
+    {
+        Queue_t * pxNewQueue;
+        const UBaseType_t uxMutexLength = ( UBaseType_t ) 1, uxMutexSize = ( UBaseType_t ) 0;
+
+        configASSERT( uxCeilingPriority > tskIDLE_PRIORITY );
+        configASSERT( uxCeilingPriority < ( UBaseType_t ) configMAX_PRIORITIES );
+
+        pxNewQueue = ( Queue_t * ) xQueueGenericCreateStatic( uxMutexLength, uxMutexSize, NULL, pxStaticQueue, queueQUEUE_TYPE_MUTEX );
+
+        if( pxNewQueue != NULL )
+        {
+            pxNewQueue->uxCeilingPriority = uxCeilingPriority;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        prvInitialiseMutex( pxNewQueue );
+
+        return ( QueueHandle_t ) pxNewQueue;
+    }
+
+#endif /* ( ( configUSE_MUTEX_PRIORITY_CEILING == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+
+    static void prvInitialiseReadWriteLock( Queue_t * pxNewQueue )
+    {
+        if( pxNewQueue != NULL )
+        {
+            /* The queue create function set the queue pointers, which share
+             * storage with the lock state. */
+            pxNewQueue->uxQueueType = ( int8_t * ) &( pxNewQueue->u );
+            pxNewQueue->u.xReadWriteLock.xWriter = NULL;
+            pxNewQueue->u.xReadWriteLock.uxWritersWaiting = ( UBaseType_t ) 0U;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_READ_WRITE_LOCKS */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_READ_WRITE_LOCKS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+    QueueHandle_t xQueueCreateReadWriteLock( void )
+    {
+        QueueHandle_t xNewQueue;
+
+        xNewQueue = xQueueGenericCreate( queueREAD_WRITE_LOCK_MAX_READERS, queueSEMAPHORE_QUEUE_ITEM_LENGTH, queueQUEUE_TYPE_READ_WRITE_LOCK );
+        prvInitialiseReadWriteLock( ( Queue_t * ) xNewQueue );
+
+        return xNewQueue;
+    }
+
+#endif /* ( ( configUSE_READ_WRITE_LOCKS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) ) */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_READ_WRITE_LOCKS == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+    QueueHandle_t xQueueCreateReadWriteLockStatic( StaticQueue_t * pxStaticQueue )
+    {
+        QueueHandle_t xNewQueue;
+
+        xNewQueue = xQueueGenericCreateStatic( queueREAD_WRITE_LOCK_MAX_READERS, queueSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, pxStaticQueue, queueQUEUE_TYPE_READ_WRITE_LOCK );
+        prvInitialiseReadWriteLock( ( Queue_t * ) xNewQueue );
+
+        return xNewQueue;
+    }
+
+#endif /* ( ( configUSE_READ_WRITE_LOCKS == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) ) */
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_MUTEXES == 1 ) && ( INCLUDE_xSemaphoreGetMutexHolder == 1 ) )
 
     TaskHandle_t xQueueGetMutexHolder( QueueHandle_t xSemaphore )
@@ -675,7 +1059,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
         {
             if( pxSemaphore->uxQueueType == queueQUEUE_IS_MUTEX )
             {
-                pxReturn = pxSemaphore->u.xSemaphore.xMutexHolder;
+                pxReturn = prvGetMutexHolder( pxSemaphore );
             }
             else
             {
@@ -703,7 +1087,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
          * not required here. */
         if( ( ( Queue_t * ) xSemaphore )->uxQueueType == queueQUEUE_IS_MUTEX )
         {
-            pxReturn = ( ( Queue_t * ) xSemaphore )->u.xSemaphore.xMutexHolder;
+            pxReturn = prvGetMutexHolder( ( Queue_t * ) xSemaphore );
         }
         else
         {
@@ -731,7 +1115,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
          * this is the only condition we are interested in it does not matter if
          * pxMutexHolder is accessed simultaneously by another task.  Therefore no
          * mutual exclusion is required to test the pxMutexHolder variable. */
-        if( pxMutex->u.xSemaphore.xMutexHolder == xTaskGetCurrentTaskHandle() )
+        if( prvGetMutexHolder( pxMutex ) == xTaskGetCurrentTaskHandle() )
         {
             traceGIVE_MUTEX_RECURSIVE( pxMutex );
 
@@ -786,7 +1170,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
 
         traceTAKE_MUTEX_RECURSIVE( pxMutex );
 
-        if( pxMutex->u.xSemaphore.xMutexHolder == xTaskGetCurrentTaskHandle() )
+        if( prvGetMutexHolder( pxMutex ) == xTaskGetCurrentTaskHandle() )
         {
             ( pxMutex->u.xSemaphore.uxRecursiveCallCount )++;
             xReturn = pdPASS;
@@ -814,72 +1198,205 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
 #endif /* configUSE_RECURSIVE_MUTEXES */
 /*-----------------------------------------------------------*/
 
-#if ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
 
-    QueueHandle_t xQueueCreateCountingSemaphoreStatic( const UBaseType_t uxMaxCount,
-                                                       const UBaseType_t uxInitialCount,
-                                                       StaticQueue_t * pxStaticQueue )
+    BaseType_t xQueueTakeReadLock( QueueHandle_t xLock,
+                                   TickType_t xTicksToWait )
     {
-        QueueHandle_t xHandle = NULL;
+        return prvTakeReadWriteLock( ( Queue_t * ) xLock, xTicksToWait, pdFALSE );
+    }
+/*-----------------------------------------------------------*/
 
-        if( ( uxMaxCount != 0 ) &&
-            ( uxInitialCount <= uxMaxCount ) )
-        {
-            xHandle = xQueueGenericCreateStatic( uxMaxCount, queueSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, pxStaticQueue, queueQUEUE_TYPE_COUNTING_SEMAPHORE );
+    BaseType_t xQueueTakeWriteLock( QueueHandle_t xLock,
+                                    TickType_t xTicksToWait )
+    {
+        return prvTakeReadWriteLock( ( Queue_t * ) xLock, xTicksToWait, pdTRUE );
+    }
+/*-----------------------------------------------------------*/
 
-            if( xHandle != NULL )
+    BaseType_t xQueueGiveReadLock( QueueHandle_t xLock )
+    {
+        BaseType_t xReturn;
+        Queue_t * const pxQueue = ( Queue_t * ) xLock;
+
+        configASSERT( pxQueue );
+        configASSERT( prvIsReadWriteLock( pxQueue ) != pdFALSE );
+
+        taskENTER_CRITICAL();
+        {
+            /* Readers are not recorded, so all that can be checked is that
+             * some task holds the lock for reading. */
+            if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
             {
-                ( ( Queue_t * ) xHandle )->uxMessagesWaiting = uxInitialCount;
+                traceQUEUE_SEND( pxQueue );
 
-                traceCREATE_COUNTING_SEMAPHORE();
+                pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( pxQueue->uxMessagesWaiting - ( UBaseType_t ) 1 );
+
+                if( prvUnblockReadWriteLockWaiters( pxQueue ) != pdFALSE )
+                {
+                    queueYIELD_IF_USING_PREEMPTION();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                xReturn = pdPASS;
             }
             else
             {
-                traceCREATE_COUNTING_SEMAPHORE_FAILED();
+                traceQUEUE_SEND_FAILED( pxQueue );
+                xReturn = pdFAIL;
             }
         }
-        else
-        {
-            configASSERT( xHandle );
-            mtCOVERAGE_TEST_MARKER();
-        }
+        taskEXIT_CRITICAL();
 
-        return xHandle;
+        return xReturn;
     }
-
-#endif /* ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) ) */
 /*-----------------------------------------------------------*/
 
-#if ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
-
-    QueueHandle_t xQueueCreateCountingSemaphore( const UBaseType_t uxMaxCount,
-                                                 const UBaseType_t uxInitialCount )
+    BaseType_t xQueueGiveWriteLock( QueueHandle_t xLock )
     {
-        QueueHandle_t xHandle = NULL;
+        BaseType_t xReturn, xYieldRequired;
+        Queue_t * const pxQueue = ( Queue_t * ) xLock;
 
-        if( ( uxMaxCount != 0 ) &&
-            ( uxInitialCount <= uxMaxCount ) )
-        {
-            xHandle = xQueueGenericCreate( uxMaxCount, queueSEMAPHORE_QUEUE_ITEM_LENGTH, queueQUEUE_TYPE_COUNTING_SEMAPHORE );
+        configASSERT( pxQueue );
+        configASSERT( prvIsReadWriteLock( pxQueue ) != pdFALSE );
 
-            if( xHandle != NULL )
+        taskENTER_CRITICAL();
+        {
+            /* As with xQueueGiveMutexRecursive(), only the task that holds the
+             * lock for writing can give it back, and the holder cannot change
+             * while the calling task is checking it. */
+            if( ( pxQueue->u.xReadWriteLock.xWriter != NULL ) &&
+                ( pxQueue->u.xReadWriteLock.xWriter == xTaskGetCurrentTaskHandle() ) )
             {
-                ( ( Queue_t * ) xHandle )->uxMessagesWaiting = uxInitialCount;
+                traceQUEUE_SEND( pxQueue );
 
-                traceCREATE_COUNTING_SEMAPHORE();
+                /* Drop any priority the writer inherited from waiting tasks. */
+                xYieldRequired = xTaskPriorityDisinherit( pxQueue->u.xReadWriteLock.xWriter );
+                pxQueue->u.xReadWriteLock.xWriter = NULL;
+
+                if( prvUnblockReadWriteLockWaiters( pxQueue ) != pdFALSE )
+                {
+                    xYieldRequired = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                if( xYieldRequired != pdFALSE )
+                {
+                    queueYIELD_IF_USING_PREEMPTION();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                xReturn = pdPASS;
             }
             else
             {
-                traceCREATE_COUNTING_SEMAPHORE_FAILED();
+                traceQUEUE_SEND_FAILED( pxQueue );
+                xReturn = pdFAIL;
             }
         }
-        else
-        {
-            configASSERT( xHandle );
-            mtCOVERAGE_TEST_MARKER();
-        }
+        taskEXIT_CRITICAL();
 
-        return xHandle;
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    TaskHandle_t xQueueGetWriteLockHolder( QueueHandle_t xLock )
+    {
+        TaskHandle_t xReturn;
+        Queue_t * const pxQueue = ( Queue_t * ) xLock;
+
+        configASSERT( pxQueue );
+        configASSERT( prvIsReadWriteLock( pxQueue ) != pdFALSE );
+
+        /* Like xQueueGetMutexHolder(), the writer may change as soon as the
+         * critical section is exited. */
+        taskENTER_CRITICAL();
+        {
+            xReturn = pxQueue->u.xReadWriteLock.xWriter;
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+
+#endif /* configUSE_READ_WRITE_LOCKS */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+    QueueHandle_t xQueueCreateCountingSemaphoreStatic( const UBaseType_t uxMaxCount,
+                                                       const UBaseType_t uxInitialCount,
+                                                       StaticQueue_t * pxStaticQueue )
+    {
+        QueueHandle_t xHandle = NULL;
+
+        if( ( uxMaxCount != 0 ) &&
+            ( uxInitialCount <= uxMaxCount ) )
+        {
+            xHandle = xQueueGenericCreateStatic( uxMaxCount, queueSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, pxStaticQueue, queueQUEUE_TYPE_COUNTING_SEMAPHORE );
+
+            if( xHandle != NULL )
+            {
+                ( ( Queue_t * ) xHandle )->uxMessagesWaiting = uxInitialCount;
+
+                traceCREATE_COUNTING_SEMAPHORE();
+            }
+            else
+            {
+                traceCREATE_COUNTING_SEMAPHORE_FAILED();
+            }
+        }
+        else
+        {
+            configASSERT( xHandle );
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xHandle;
+    }
+
+#endif /* ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) ) */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+    QueueHandle_t xQueueCreateCountingSemaphore( const UBaseType_t uxMaxCount,
+                                                 const UBaseType_t uxInitialCount )
+    {
+        QueueHandle_t xHandle = NULL;
+
+        if( ( uxMaxCount != 0 ) &&
+            ( uxInitialCount <= uxMaxCount ) )
+        {
+            xHandle = xQueueGenericCreate( uxMaxCount, queueSEMAPHORE_QUEUE_ITEM_LENGTH, queueQUEUE_TYPE_COUNTING_SEMAPHORE );
+
+            if( xHandle != NULL )
+            {
+                ( ( Queue_t * ) xHandle )->uxMessagesWaiting = uxInitialCount;
+
+                traceCREATE_COUNTING_SEMAPHORE();
+            }
+            else
+            {
+                traceCREATE_COUNTING_SEMAPHORE_FAILED();
+            }
+        }
+        else
+        {
+            configASSERT( xHandle );
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xHandle;
     }
 
 #endif /* ( ( configUSE_COUNTING_SEMAPHORES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) ) */
@@ -897,12 +1414,27 @@ BaseType_t xQueueGenericSend( QueueHandle_t xQueue,
     configASSERT( pxQueue );
     configASSERT( !( ( pvItemToQueue == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
     configASSERT( !( ( xCopyPosition == queueOVERWRITE ) && ( pxQueue->uxLength != 1 ) ) );
+    configASSERT( prvIsReadWriteLock( pxQueue ) == pdFALSE );
     #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
     {
         configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
     }
     #endif
 
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+    {
+        if( ( xCopyPosition == queueSEND_TO_BACK ) && ( prvGiveMutexFast( pxQueue ) != pdFALSE ) )
+        {
+            traceQUEUE_SEND( pxQueue );
+            return pdPASS;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif
+
     /*lint -save -e904 This function relaxes the coding standard somewhat to
      * allow return statements within the function itself.  This is done in the
      * interest of execution time efficiency. */
@@ -1117,6 +1649,7 @@ BaseType_t xQueueGenericSendFromISR( QueueHandle_t xQueue,
     configASSERT( pxQueue );
     configASSERT( !( ( pvItemToQueue == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
     configASSERT( !( ( xCopyPosition == queueOVERWRITE ) && ( pxQueue->uxLength != 1 ) ) );
+    configASSERT( prvIsReadWriteLock( pxQueue ) == pdFALSE );
 
     /* RTOS ports that support interrupt nesting have the concept of a maximum
      * system call (or maximum API call) interrupt priority.  Interrupts that are
@@ -1292,7 +1825,11 @@ BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue,
     /* Normally a mutex would not be given from an interrupt, especially if
      * there is a mutex holder, as priority inheritance makes no sense for an
      * interrupts, only tasks. */
-    configASSERT( !( ( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX ) && ( pxQueue->u.xSemaphore.xMutexHolder != NULL ) ) );
+    configASSERT( !( ( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX ) && ( prvGetMutexHolder( pxQueue ) != NULL ) ) );
+
+    /* A read write lock is only given with xQueueGiveReadLock() and
+     * xQueueGiveWriteLock(). */
+    configASSERT( prvIsReadWriteLock( pxQueue ) == pdFALSE );
 
     /* RTOS ports that support interrupt nesting have the concept of a maximum
      * system call (or maximum API call) interrupt priority.  Interrupts that are
@@ -1450,6 +1987,7 @@ BaseType_t xQueueReceive( QueueHandle_t xQueue,
     /* The buffer into which data is received can only be NULL if the data size
      * is zero (so no data is copied into the buffer). */
     configASSERT( !( ( ( pvBuffer ) == NULL ) && ( ( pxQueue )->uxItemSize != ( UBaseType_t ) 0U ) ) );
+    configASSERT( prvIsReadWriteLock( pxQueue ) == pdFALSE );
 
     /* Cannot block if the scheduler is suspended. */
     #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
@@ -1476,6 +2014,12 @@ BaseType_t xQueueReceive( QueueHandle_t xQueue,
                 traceQUEUE_RECEIVE( pxQueue );
                 pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( uxMessagesWaiting - ( UBaseType_t ) 1 );
 
+                #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+                {
+                    prvHoldBackFreedSlots( pxQueue, ( UBaseType_t ) 1 );
+                }
+                #endif
+
                 /* There is now space in the queue, were any tasks waiting to
                  * post to the queue?  If so, unblock the highest priority waiting
                  * task. */
@@ -1604,6 +2148,7 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
     /* Check this really is a semaphore, in which case the item size will be
      * 0. */
     configASSERT( pxQueue->uxItemSize == 0 );
+    configASSERT( prvIsReadWriteLock( pxQueue ) == pdFALSE );
 
     /* Cannot block if the scheduler is suspended. */
     #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
@@ -1612,6 +2157,20 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
     }
     #endif
 
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+    {
+        if( prvTakeMutexFast( pxQueue ) != pdFALSE )
+        {
+            traceQUEUE_RECEIVE( pxQueue );
+            return pdPASS;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif
+
     /*lint -save -e904 This function relaxes the coding standard somewhat to allow return
      * statements within the function itself.  This is done in the interest
      * of execution time efficiency. */
@@ -1621,7 +2180,7 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
         {
             /* Semaphores are queues with an item size of 0, and where the
              * number of messages in the queue is the semaphore's count value. */
-            const UBaseType_t uxSemaphoreCount = pxQueue->uxMessagesWaiting;
+            const UBaseType_t uxSemaphoreCount = prvGetSemaphoreCount( pxQueue );
 
             /* Is there data in the queue now?  To be running the calling task
              * must be the highest priority task wanting to access the queue. */
@@ -1639,7 +2198,20 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
                     {
                         /* Record the information required to implement
                          * priority inheritance should it become necessary. */
-                        pxQueue->u.xSemaphore.xMutexHolder = pvTaskIncrementMutexHeldCount();
+                        pxQueue->u.xSemaphore.xMutexHolder = prvCountedMutexHolder( pvTaskIncrementMutexHeldCount() );
+
+                        #if ( configUSE_MUTEX_PRIORITY_CEILING == 1 )
+                        {
+                            if( pxQueue->uxCeilingPriority != ( UBaseType_t ) 0 )
+                            {
+                                vTaskPriorityRaiseToCeiling( pxQueue->uxCeilingPriority );
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
+                        #endif /* configUSE_MUTEX_PRIORITY_CEILING */
                     }
                     else
                     {
@@ -1714,11 +2286,13 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
 
                 #if ( configUSE_MUTEXES == 1 )
                 {
-                    if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+                    /* The holder of a mutex with a priority ceiling already
+                     * runs at the ceiling, so nothing is inherited. */
+                    if( ( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX ) && ( prvHasPriorityCeiling( pxQueue ) == pdFALSE ) )
                     {
                         taskENTER_CRITICAL();
                         {
-                            xInheritanceOccurred = xTaskPriorityInherit( pxQueue->u.xSemaphore.xMutexHolder );
+                            xInheritanceOccurred = xTaskPriorityInherit( prvGetMutexHolder( pxQueue ) );
                         }
                         taskEXIT_CRITICAL();
                     }
@@ -1786,7 +2360,7 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
                              * again, but only as low as the next highest priority
                              * task that is waiting for the same mutex. */
                             uxHighestWaitingPriority = prvGetDisinheritPriorityAfterTimeout( pxQueue );
-                            vTaskPriorityDisinheritAfterTimeout( pxQueue->u.xSemaphore.xMutexHolder, uxHighestWaitingPriority );
+                            vTaskPriorityDisinheritAfterTimeout( prvGetMutexHolder( pxQueue ), uxHighestWaitingPriority );
                         }
                         taskEXIT_CRITICAL();
                     }
@@ -1820,6 +2394,7 @@ BaseType_t xQueuePeek( QueueHandle_t xQueue,
     /* The buffer into which data is received can only be NULL if the data size
      * is zero (so no data is copied into the buffer. */
     configASSERT( !( ( ( pvBuffer ) == NULL ) && ( ( pxQueue )->uxItemSize != ( UBaseType_t ) 0U ) ) );
+    configASSERT( prvIsReadWriteLock( pxQueue ) == pdFALSE );
 
     /* Cannot block if the scheduler is suspended. */
     #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
@@ -1974,6 +2549,7 @@ BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue,
 
     configASSERT( pxQueue );
     configASSERT( !( ( pvBuffer == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
+    configASSERT( prvIsReadWriteLock( pxQueue ) == pdFALSE );
 
     /* RTOS ports that support interrupt nesting have the concept of a maximum
      * system call (or maximum API call) interrupt priority.  Interrupts that are
@@ -2005,6 +2581,12 @@ BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue,
             prvCopyDataFromQueue( pxQueue, pvBuffer );
             pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( uxMessagesWaiting - ( UBaseType_t ) 1 );
 
+            #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+            {
+                prvHoldBackFreedSlots( pxQueue, ( UBaseType_t ) 1 );
+            }
+            #endif
+
             /* If the queue is locked the event list will not be modified.
              * Instead update the lock count so the task that unlocks the queue
              * will know that an ISR has removed data while the queue was
@@ -2112,265 +2694,1783 @@ BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,
 }
 /*-----------------------------------------------------------*/
 
-UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
+size_t xQueueSendMultiple( QueueHandle_t xQueue,
+                           const void * const pvItemsToQueue,
+                           const size_t xItemCount,
+                           TickType_t xTicksToWait )
 {
-    UBaseType_t uxReturn;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+    Queue_t * const pxQueue = xQueue;
+    UBaseType_t uxItemsSent;
 
-    configASSERT( xQueue );
+    configASSERT( pxQueue );
 
-    taskENTER_CRITICAL();
+    /* Semaphores and mutexes have no items to copy. */
+    configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+    configASSERT( !( ( pvItemsToQueue == NULL ) && ( xItemCount != ( size_t ) 0U ) ) );
+    #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
     {
-        uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+        configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
     }
-    taskEXIT_CRITICAL();
+    #endif
 
-    return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
+    /*lint -save -e904 This function relaxes the coding standard somewhat to
+     * allow return statements within the function itself.  This is done in the
+     * interest of execution time efficiency. */
+    if( xItemCount == ( size_t ) 0U )
+    {
+        return 0;
+    }
 
-UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue )
-{
-    UBaseType_t uxReturn;
-    Queue_t * const pxQueue = xQueue;
+    for( ; ; )
+    {
+        taskENTER_CRITICAL();
+        {
+            const UBaseType_t uxSpaces = ( UBaseType_t ) ( pxQueue->uxLength - pxQueue->uxMessagesWaiting );
 
-    configASSERT( pxQueue );
+            /* Is there room for at least one item now?  As many as fit are
+             * sent in one go, and one waiting task is unblocked per item. */
+            if( uxSpaces > ( UBaseType_t ) 0 )
+            {
+                uxItemsSent = ( xItemCount < ( size_t ) uxSpaces ) ? ( UBaseType_t ) xItemCount : uxSpaces;
 
-    taskENTER_CRITICAL();
-    {
-        uxReturn = ( UBaseType_t ) ( pxQueue->uxLength - pxQueue->uxMessagesWaiting );
-    }
-    taskEXIT_CRITICAL();
+                traceQUEUE_SEND( pxQueue );
 
-    return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
+                prvCopyMultipleToQueue( pxQueue, ( const int8_t * ) pvItemsToQueue, uxItemsSent );
 
-UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
-{
-    UBaseType_t uxReturn;
-    Queue_t * const pxQueue = xQueue;
+                if( prvNotifyItemsSent( pxQueue, uxItemsSent ) != pdFALSE )
+                {
+                    /* Yes it is ok to do this from within the critical
+                     * section - the kernel takes care of that. */
+                    queueYIELD_IF_USING_PREEMPTION();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
 
-    configASSERT( pxQueue );
-    uxReturn = pxQueue->uxMessagesWaiting;
+                taskEXIT_CRITICAL();
+                return ( size_t ) uxItemsSent;
+            }
+            else
+            {
+                if( xTicksToWait == ( TickType_t ) 0 )
+                {
+                    /* The queue was full and no block time is specified (or
+                     * the block time has expired) so leave now. */
+                    taskEXIT_CRITICAL();
+                    traceQUEUE_SEND_FAILED( pxQueue );
+                    return 0;
+                }
+                else if( xEntryTimeSet == pdFALSE )
+                {
+                    /* The queue was full and a block time was specified so
+                     * configure the timeout structure. */
+                    vTaskInternalSetTimeOutState( &xTimeOut );
+                    xEntryTimeSet = pdTRUE;
+                }
+                else
+                {
+                    /* Entry time was already set. */
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
 
-    return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+        /* Interrupts and other tasks can send to and receive from the queue
+         * now the critical section has been exited. */
+
+        vTaskSuspendAll();
+        prvLockQueue( pxQueue );
+
+        /* Update the timeout state to see if it has expired yet. */
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+        {
+            if( prvIsQueueFull( pxQueue ) != pdFALSE )
+            {
+                traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+                vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+                prvUnlockQueue( pxQueue );
+
+                if( xTaskResumeAll() == pdFALSE )
+                {
+                    #if ( configNUMBER_OF_CORES == 1 )
+                    {
+                        portYIELD_WITHIN_API();
+                    }
+                    #else /* #if ( configNUMBER_OF_CORES == 1 ) */
+                    {
+                        vTaskYieldWithinAPI();
+                    }
+                    #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
+                }
+            }
+            else
+            {
+                /* Try again. */
+                prvUnlockQueue( pxQueue );
+                ( void ) xTaskResumeAll();
+            }
+        }
+        else
+        {
+            /* The timeout has expired. */
+            prvUnlockQueue( pxQueue );
+            ( void ) xTaskResumeAll();
+
+            traceQUEUE_SEND_FAILED( pxQueue );
+            return 0;
+        }
+    } /*lint -restore */
+}
 /*-----------------------------------------------------------*/
 
-void vQueueDelete( QueueHandle_t xQueue )
+size_t xQueueSendMultipleFromISR( QueueHandle_t xQueue,
+                                  const void * const pvItemsToQueue,
+                                  const size_t xItemCount,
+                                  BaseType_t * const pxHigherPriorityTaskWoken )
 {
+    UBaseType_t uxItemsSent = 0;
+    UBaseType_t uxSavedInterruptStatus;
     Queue_t * const pxQueue = xQueue;
 
     configASSERT( pxQueue );
-    traceQUEUE_DELETE( pxQueue );
+    configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+    configASSERT( !( ( pvItemsToQueue == NULL ) && ( xItemCount != ( size_t ) 0U ) ) );
 
-    #if ( configQUEUE_REGISTRY_SIZE > 0 )
-    {
-        vQueueUnregisterQueue( pxQueue );
-    }
-    #endif
+    /* See the comment in xQueueGenericSendFromISR(). */
+    portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-    #if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        const UBaseType_t uxSpaces = ( UBaseType_t ) ( pxQueue->uxLength - pxQueue->uxMessagesWaiting );
+
+        uxItemsSent = ( xItemCount < ( size_t ) uxSpaces ) ? ( UBaseType_t ) xItemCount : uxSpaces;
+
+        if( uxItemsSent > ( UBaseType_t ) 0 )
+        {
+            int8_t cTxLock = pxQueue->cTxLock;
+
+            traceQUEUE_SEND_FROM_ISR( pxQueue );
+
+            prvCopyMultipleToQueue( pxQueue, ( const int8_t * ) pvItemsToQueue, uxItemsSent );
+
+            /* The event list is not altered if the queue is locked.  This will
+             * be done when the queue is unlocked later. */
+            if( cTxLock == queueUNLOCKED )
+            {
+                if( prvNotifyItemsSent( pxQueue, uxItemsSent ) != pdFALSE )
+                {
+                    if( pxHigherPriorityTaskWoken != NULL )
+                    {
+                        *pxHigherPriorityTaskWoken = pdTRUE;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                /* Count every item so the task that unlocks the queue can
+                 * unblock a task for each. */
+                UBaseType_t uxItem;
+
+                for( uxItem = 0; uxItem < uxItemsSent; uxItem++ )
+                {
+                    prvIncrementQueueTxLock( pxQueue, cTxLock );
+                    cTxLock = pxQueue->cTxLock;
+                }
+            }
+        }
+        else
+        {
+            traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    return ( size_t ) uxItemsSent;
+}
+/*-----------------------------------------------------------*/
+
+size_t xQueueReceiveMultiple( QueueHandle_t xQueue,
+                              void * const pvBuffer,
+                              const size_t xBufferLengthItems,
+                              TickType_t xTicksToWait )
+{
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+    Queue_t * const pxQueue = xQueue;
+    UBaseType_t uxItemsReceived;
+
+    configASSERT( pxQueue );
+    configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+    configASSERT( !( ( pvBuffer == NULL ) && ( xBufferLengthItems != ( size_t ) 0U ) ) );
+
+    /* Cannot block if the scheduler is suspended. */
+    #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+    {
+        configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+    }
+    #endif
+
+    /*lint -save -e904  This function relaxes the coding standard somewhat to
+     * allow return statements within the function itself.  This is done in the
+     * interest of execution time efficiency. */
+    if( xBufferLengthItems == ( size_t ) 0U )
+    {
+        return 0;
+    }
+
+    for( ; ; )
+    {
+        taskENTER_CRITICAL();
+        {
+            const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
+
+            /* Is there data in the queue now?  As many items as fit in the
+             * buffer are removed in one go, and one task waiting to send is
+             * unblocked per item. */
+            if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+            {
+                uxItemsReceived = ( xBufferLengthItems < ( size_t ) uxMessagesWaiting ) ?
+                                  ( UBaseType_t ) xBufferLengthItems : uxMessagesWaiting;
+
+                prvCopyMultipleFromQueue( pxQueue, ( int8_t * ) pvBuffer, uxItemsReceived );
+                traceQUEUE_RECEIVE( pxQueue );
+
+                if( prvUnblockMultiple( &( pxQueue->xTasksWaitingToSend ), uxItemsReceived ) != pdFALSE )
+                {
+                    queueYIELD_IF_USING_PREEMPTION();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                taskEXIT_CRITICAL();
+                return ( size_t ) uxItemsReceived;
+            }
+            else
+            {
+                if( xTicksToWait == ( TickType_t ) 0 )
+                {
+                    /* The queue was empty and no block time is specified (or
+                     * the block time has expired) so leave now. */
+                    taskEXIT_CRITICAL();
+                    traceQUEUE_RECEIVE_FAILED( pxQueue );
+                    return 0;
+                }
+                else if( xEntryTimeSet == pdFALSE )
+                {
+                    /* The queue was empty and a block time was specified so
+                     * configure the timeout structure. */
+                    vTaskInternalSetTimeOutState( &xTimeOut );
+                    xEntryTimeSet = pdTRUE;
+                }
+                else
+                {
+                    /* Entry time was already set. */
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        /* Interrupts and other tasks can send to and receive from the queue
+         * now the critical section has been exited. */
+
+        vTaskSuspendAll();
+        prvLockQueue( pxQueue );
+
+        /* Update the timeout state to see if it has expired yet. */
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+        {
+            /* The timeout has not expired.  If the queue is still empty place
+             * the task on the list of tasks waiting to receive from the queue. */
+            if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+            {
+                traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+                vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+                prvUnlockQueue( pxQueue );
+
+                if( xTaskResumeAll() == pdFALSE )
+                {
+                    #if ( configNUMBER_OF_CORES == 1 )
+                    {
+                        portYIELD_WITHIN_API();
+                    }
+                    #else /* #if ( configNUMBER_OF_CORES == 1 ) */
+                    {
+                        vTaskYieldWithinAPI();
+                    }
+                    #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                /* The queue contains data again.  Loop back to try and read the
+                 * data. */
+                prvUnlockQueue( pxQueue );
+                ( void ) xTaskResumeAll();
+            }
+        }
+        else
+        {
+            /* Timed out.  If there is no data in the queue exit, otherwise loop
+             * back and attempt to read the data. */
+            prvUnlockQueue( pxQueue );
+            ( void ) xTaskResumeAll();
+
+            if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+            {
+                traceQUEUE_RECEIVE_FAILED( pxQueue );
+                return 0;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    } /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+size_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue,
+                                     void * const pvBuffer,
+                                     const size_t xBufferLengthItems,
+                                     BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    UBaseType_t uxItemsReceived = 0;
+    UBaseType_t uxSavedInterruptStatus;
+    Queue_t * const pxQueue = xQueue;
+
+    configASSERT( pxQueue );
+    configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+    configASSERT( !( ( pvBuffer == NULL ) && ( xBufferLengthItems != ( size_t ) 0U ) ) );
+
+    /* See the comment in xQueueGenericSendFromISR(). */
+    portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
+
+        uxItemsReceived = ( xBufferLengthItems < ( size_t ) uxMessagesWaiting ) ?
+                          ( UBaseType_t ) xBufferLengthItems : uxMessagesWaiting;
+
+        if( uxItemsReceived > ( UBaseType_t ) 0 )
+        {
+            int8_t cRxLock = pxQueue->cRxLock;
+
+            traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+
+            prvCopyMultipleFromQueue( pxQueue, ( int8_t * ) pvBuffer, uxItemsReceived );
+
+            /* If the queue is locked the event list will not be modified.
+             * Instead update the lock count so the task that unlocks the queue
+             * will know that an ISR has removed data while the queue was
+             * locked. */
+            if( cRxLock == queueUNLOCKED )
+            {
+                if( prvUnblockMultiple( &( pxQueue->xTasksWaitingToSend ), uxItemsReceived ) != pdFALSE )
+                {
+                    if( pxHigherPriorityTaskWoken != NULL )
+                    {
+                        *pxHigherPriorityTaskWoken = pdTRUE;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                UBaseType_t uxItem;
+
+                for( uxItem = 0; uxItem < uxItemsReceived; uxItem++ )
+                {
+                    prvIncrementQueueRxLock( pxQueue, cRxLock );
+                    cRxLock = pxQueue->cRxLock;
+                }
+            }
+        }
+        else
+        {
+            traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    return ( size_t ) uxItemsReceived;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_ZERO_COPY == 1 )
+
+    BaseType_t xQueueReserve( QueueHandle_t xQueue,
+                              void ** const ppvSlot,
+                              TickType_t xTicksToWait )
+    {
+        BaseType_t xEntryTimeSet = pdFALSE;
+        TimeOut_t xTimeOut;
+        Queue_t * const pxQueue = xQueue;
+
+        configASSERT( pxQueue );
+        configASSERT( ppvSlot );
+
+        /* Semaphores and mutexes have no storage to hand out. */
+        configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+        /* A queue set would be told about items sent behind the reserved slot
+         * before they can be received. */
+        #if ( configUSE_QUEUE_SETS == 1 )
+        {
+            configASSERT( pxQueue->pxQueueSetContainer == NULL );
+        }
+        #endif
+
+        #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+        {
+            configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+        }
+        #endif
+
+        /*lint -save -e904 This function relaxes the coding standard somewhat to
+         * allow return statements within the function itself.  This is done in the
+         * interest of execution time efficiency. */
+        for( ; ; )
+        {
+            taskENTER_CRITICAL();
+            {
+                /* Only one slot can be reserved at a time.  A task waiting for
+                 * it to be committed would sit in xTasksWaitingToSend, where a
+                 * receive could wake it instead of a task waiting for space,
+                 * so fail at once. */
+                if( pxQueue->pcReserved != NULL )
+                {
+                    taskEXIT_CRITICAL();
+                    traceQUEUE_SEND_FAILED( pxQueue );
+                    return errQUEUE_FULL;
+                }
+                else if( pxQueue->uxMessagesWaiting < pxQueue->uxLength )
+                {
+                    pxQueue->pcReserved = pxQueue->pcWriteTo;
+                    pxQueue->pcWriteTo += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+
+                    if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+                    {
+                        pxQueue->pcWriteTo = pxQueue->pcHead;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    pxQueue->uxLength--;
+                    *ppvSlot = ( void * ) pxQueue->pcReserved;
+
+                    taskEXIT_CRITICAL();
+                    return pdPASS;
+                }
+                else
+                {
+                    if( xTicksToWait == ( TickType_t ) 0 )
+                    {
+                        taskEXIT_CRITICAL();
+                        traceQUEUE_SEND_FAILED( pxQueue );
+                        return errQUEUE_FULL;
+                    }
+                    else if( xEntryTimeSet == pdFALSE )
+                    {
+                        vTaskInternalSetTimeOutState( &xTimeOut );
+                        xEntryTimeSet = pdTRUE;
+                    }
+                    else
+                    {
+                        /* Entry time was already set. */
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            vTaskSuspendAll();
+            prvLockQueue( pxQueue );
+
+            if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+            {
+                if( prvIsQueueFull( pxQueue ) != pdFALSE )
+                {
+                    traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+                    vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+                    prvUnlockQueue( pxQueue );
+
+                    if( xTaskResumeAll() == pdFALSE )
+                    {
+                        #if ( configNUMBER_OF_CORES == 1 )
+                        {
+                            portYIELD_WITHIN_API();
+                        }
+                        #else /* #if ( configNUMBER_OF_CORES == 1 ) */
+                        {
+                            vTaskYieldWithinAPI();
+                        }
+                        #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
+                    }
+                }
+                else
+                {
+                    /* Try again. */
+                    prvUnlockQueue( pxQueue );
+                    ( void ) xTaskResumeAll();
+                }
+            }
+            else
+            {
+                /* The timeout has expired. */
+                prvUnlockQueue( pxQueue );
+                ( void ) xTaskResumeAll();
+
+                traceQUEUE_SEND_FAILED( pxQueue );
+                return errQUEUE_FULL;
+            }
+        } /*lint -restore */
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xQueueCommit( QueueHandle_t xQueue,
+                             void * const pvSlot )
+    {
+        Queue_t * const pxQueue = xQueue;
+        UBaseType_t uxItemsPublished;
+        BaseType_t xYieldRequired;
+
+        configASSERT( pxQueue );
+        configASSERT( ( pvSlot != NULL ) && ( ( int8_t * ) pvSlot == pxQueue->pcReserved ) );
+
+        taskENTER_CRITICAL();
+        {
+            /* The reserved item and any items sent behind it all become
+             * receivable now, in the order they were placed in the queue. */
+            uxItemsPublished = ( UBaseType_t ) ( pxQueue->uxUnpublished + ( UBaseType_t ) 1 );
+            pxQueue->pcReserved = NULL;
+            pxQueue->uxUnpublished = ( UBaseType_t ) 0U;
+            pxQueue->uxLength += uxItemsPublished;
+            pxQueue->uxMessagesWaiting += uxItemsPublished;
+
+            traceQUEUE_SEND( pxQueue );
+
+            xYieldRequired = prvUnblockMultiple( &( pxQueue->xTasksWaitingToReceive ), uxItemsPublished );
+
+            if( xYieldRequired != pdFALSE )
+            {
+                queueYIELD_IF_USING_PREEMPTION();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return pdPASS;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xQueueAcquire( QueueHandle_t xQueue,
+                              void ** const ppvSlot,
+                              TickType_t xTicksToWait )
+    {
+        BaseType_t xEntryTimeSet = pdFALSE;
+        TimeOut_t xTimeOut;
+        Queue_t * const pxQueue = xQueue;
+
+        configASSERT( pxQueue );
+        configASSERT( ppvSlot );
+        configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+        #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+        {
+            configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+        }
+        #endif
+
+        /*lint -save -e904  This function relaxes the coding standard somewhat to
+         * allow return statements within the function itself.  This is done in the
+         * interest of execution time efficiency. */
+        for( ; ; )
+        {
+            taskENTER_CRITICAL();
+            {
+                /* Only one slot can be acquired at a time.  As in
+                 * xQueueReserve(), fail at once rather than wait for it to be
+                 * released in xTasksWaitingToReceive. */
+                if( pxQueue->pcAcquired != NULL )
+                {
+                    taskEXIT_CRITICAL();
+                    traceQUEUE_RECEIVE_FAILED( pxQueue );
+                    return errQUEUE_EMPTY;
+                }
+                else if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+                {
+                    pxQueue->u.xQueue.pcReadFrom += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+
+                    if( pxQueue->u.xQueue.pcReadFrom >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+                    {
+                        pxQueue->u.xQueue.pcReadFrom = pxQueue->pcHead;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    /* The item is no longer in the queue, but its slot stays out
+                     * of use until xQueueRelease(), so no sender is unblocked. */
+                    pxQueue->pcAcquired = pxQueue->u.xQueue.pcReadFrom;
+                    pxQueue->uxMessagesWaiting--;
+                    pxQueue->uxLength--;
+                    *ppvSlot = ( void * ) pxQueue->pcAcquired;
+
+                    traceQUEUE_RECEIVE( pxQueue );
+
+                    taskEXIT_CRITICAL();
+                    return pdPASS;
+                }
+                else
+                {
+                    if( xTicksToWait == ( TickType_t ) 0 )
+                    {
+                        taskEXIT_CRITICAL();
+                        traceQUEUE_RECEIVE_FAILED( pxQueue );
+                        return errQUEUE_EMPTY;
+                    }
+                    else if( xEntryTimeSet == pdFALSE )
+                    {
+                        vTaskInternalSetTimeOutState( &xTimeOut );
+                        xEntryTimeSet = pdTRUE;
+                    }
+                    else
+                    {
+                        /* Entry time was already set. */
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            vTaskSuspendAll();
+            prvLockQueue( pxQueue );
+
+            if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+            {
+                if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+                {
+                    traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+                    vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+                    prvUnlockQueue( pxQueue );
+
+                    if( xTaskResumeAll() == pdFALSE )
+                    {
+                        #if ( configNUMBER_OF_CORES == 1 )
+                        {
+                            portYIELD_WITHIN_API();
+                        }
+                        #else /* #if ( configNUMBER_OF_CORES == 1 ) */
+                        {
+                            vTaskYieldWithinAPI();
+                        }
+                        #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    /* Loop back to try again. */
+                    prvUnlockQueue( pxQueue );
+                    ( void ) xTaskResumeAll();
+                }
+            }
+            else
+            {
+                prvUnlockQueue( pxQueue );
+                ( void ) xTaskResumeAll();
+
+                if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+                {
+                    traceQUEUE_RECEIVE_FAILED( pxQueue );
+                    return errQUEUE_EMPTY;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        } /*lint -restore */
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xQueueRelease( QueueHandle_t xQueue,
+                              void * const pvSlot )
+    {
+        Queue_t * const pxQueue = xQueue;
+        UBaseType_t uxSlotsFreed;
+        BaseType_t xYieldRequired;
+
+        configASSERT( pxQueue );
+        configASSERT( ( pvSlot != NULL ) && ( ( int8_t * ) pvSlot == pxQueue->pcAcquired ) );
+
+        taskENTER_CRITICAL();
+        {
+            /* The acquired slot and any read behind it are free again. */
+            uxSlotsFreed = ( UBaseType_t ) ( pxQueue->uxUnreleased + ( UBaseType_t ) 1 );
+            pxQueue->pcAcquired = NULL;
+            pxQueue->uxUnreleased = ( UBaseType_t ) 0U;
+            pxQueue->uxLength += uxSlotsFreed;
+
+            xYieldRequired = prvUnblockMultiple( &( pxQueue->xTasksWaitingToSend ), uxSlotsFreed );
+
+            if( xYieldRequired != pdFALSE )
+            {
+                queueYIELD_IF_USING_PREEMPTION();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return pdPASS;
+    }
+
+#endif /* configUSE_QUEUE_ZERO_COPY */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
+{
+    UBaseType_t uxReturn;
+
+    configASSERT( xQueue );
+
+    taskENTER_CRITICAL();
+    {
+        uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+
+        #if ( configUSE_MUTEX_FAST_PATH == 1 )
+        {
+            /* A mutex held through the fast path still has a count of 1. */
+            if( prvIsMutexHeldUncounted( ( Queue_t * ) xQueue ) )
+            {
+                uxReturn = ( UBaseType_t ) 0;
+            }
+        }
+        #endif
+    }
+    taskEXIT_CRITICAL();
+
+    return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue )
+{
+    UBaseType_t uxReturn;
+    Queue_t * const pxQueue = xQueue;
+
+    configASSERT( pxQueue );
+
+    taskENTER_CRITICAL();
+    {
+        uxReturn = ( UBaseType_t ) ( pxQueue->uxLength - pxQueue->uxMessagesWaiting );
+    }
+    taskEXIT_CRITICAL();
+
+    return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
+{
+    UBaseType_t uxReturn;
+    Queue_t * const pxQueue = xQueue;
+
+    configASSERT( pxQueue );
+    uxReturn = pxQueue->uxMessagesWaiting;
+
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+    {
+        if( prvIsMutexHeldUncounted( pxQueue ) )
+        {
+            uxReturn = ( UBaseType_t ) 0;
+        }
+    }
+    #endif
+
+    return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+void vQueueDelete( QueueHandle_t xQueue )
+{
+    Queue_t * const pxQueue = xQueue;
+
+    configASSERT( pxQueue );
+    traceQUEUE_DELETE( pxQueue );
+
+    #if ( configQUEUE_REGISTRY_SIZE > 0 )
+    {
+        vQueueUnregisterQueue( pxQueue );
+    }
+    #endif
+
+    #if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
     {
         /* The queue can only have been allocated dynamically - free it
          * again. */
         vPortFree( pxQueue );
     }
-    #elif ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+    #elif ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+    {
+        /* The queue could have been allocated statically or dynamically, so
+         * check before attempting to free the memory. */
+        if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+        {
+            vPortFree( pxQueue );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #else /* if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) ) */
+    {
+        /* The queue must have been statically allocated, so is not going to be
+         * deleted.  Avoid compiler warnings about the unused parameter. */
+        ( void ) pxQueue;
+    }
+    #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+    UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue )
+    {
+        return ( ( Queue_t * ) xQueue )->uxQueueNumber;
+    }
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+    void vQueueSetQueueNumber( QueueHandle_t xQueue,
+                               UBaseType_t uxQueueNumber )
+    {
+        ( ( Queue_t * ) xQueue )->uxQueueNumber = uxQueueNumber;
+    }
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+    uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
+    {
+        return ( ( Queue_t * ) xQueue )->ucQueueType;
+    }
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueGetQueueItemSize( QueueHandle_t xQueue ) /* PRIVILEGED_FUNCTION */
+{
+    return ( ( Queue_t * ) xQueue )->uxItemSize;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueGetQueueLength( QueueHandle_t xQueue ) /* PRIVILEGED_FUNCTION */
+{
+    #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+    {
+        /* Add back the slots held out of use by xQueueReserve() and
+         * xQueueAcquire(). */
+        const Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+        UBaseType_t uxLength = pxQueue->uxLength + pxQueue->uxUnpublished + pxQueue->uxUnreleased;
+
+        if( pxQueue->pcReserved != NULL )
+        {
+            uxLength++;
+        }
+
+        if( pxQueue->pcAcquired != NULL )
+        {
+            uxLength++;
+        }
+
+        return uxLength;
+    }
+    #else
+    {
+        return ( ( Queue_t * ) xQueue )->uxLength;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 )
+
+    static UBaseType_t prvGetDisinheritPriorityAfterTimeout( const Queue_t * const pxQueue )
+    {
+        UBaseType_t uxHighestPriorityOfWaitingTasks;
+
+        /* If a task waiting for a mutex causes the mutex holder to inherit a
+         * priority, but the waiting task times out, then the holder should
+         * disinherit the priority - but only down to the highest priority of any
+         * other tasks that are waiting for the same mutex.  For this purpose,
+         * return the priority of the highest priority task that is waiting for the
+         * mutex.  Writers waiting for a read write lock are in
+         * xTasksWaitingToSend, so both lists are checked. */
+        if( listCURRENT_LIST_LENGTH( &( pxQueue->xTasksWaitingToReceive ) ) > 0U )
+        {
+            uxHighestPriorityOfWaitingTasks = ( UBaseType_t ) ( ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxQueue->xTasksWaitingToReceive ) ) );
+        }
+        else
+        {
+            uxHighestPriorityOfWaitingTasks = tskIDLE_PRIORITY;
+        }
+
+        #if ( configUSE_READ_WRITE_LOCKS == 1 )
+        {
+            UBaseType_t uxHighestPriorityOfWaitingWriters;
+
+            /* Tasks waiting to write to a read write lock are in
+             * xTasksWaitingToSend.  The list is always empty for a mutex. */
+            if( listCURRENT_LIST_LENGTH( &( pxQueue->xTasksWaitingToSend ) ) > 0U )
+            {
+                uxHighestPriorityOfWaitingWriters = ( UBaseType_t ) ( ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxQueue->xTasksWaitingToSend ) ) );
+
+                if( uxHighestPriorityOfWaitingWriters > uxHighestPriorityOfWaitingTasks )
+                {
+                    uxHighestPriorityOfWaitingTasks = uxHighestPriorityOfWaitingWriters;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configUSE_READ_WRITE_LOCKS */
+
+        return uxHighestPriorityOfWaitingTasks;
+    }
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
+                                      const void * pvItemToQueue,
+                                      const BaseType_t xPosition )
+{
+    BaseType_t xReturn = pdFALSE;
+    UBaseType_t uxMessagesWaiting;
+
+    /* This function is called from a critical section. */
+
+    uxMessagesWaiting = pxQueue->uxMessagesWaiting;
+
+    if( pxQueue->uxItemSize == ( UBaseType_t ) 0 )
+    {
+        #if ( configUSE_MUTEXES == 1 )
+        {
+            if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+            {
+                /* The mutex is no longer being held. */
+                xReturn = xTaskPriorityDisinherit( prvGetMutexHolder( pxQueue ) );
+                pxQueue->u.xSemaphore.xMutexHolder = NULL;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        #endif /* configUSE_MUTEXES */
+    }
+    else if( xPosition == queueSEND_TO_BACK )
+    {
+        prvCopyItem( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
+        pxQueue->pcWriteTo += pxQueue->uxItemSize;                                                       /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+
+        if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail )                                             /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+        {
+            pxQueue->pcWriteTo = pxQueue->pcHead;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+        {
+            /* The front of the queue is the slot held by xQueueAcquire(). */
+            configASSERT( pxQueue->pcAcquired == NULL );
+
+            /* The only slot of a queue that can be overwritten is the slot
+             * held by xQueueReserve() while one is reserved, and the overwrite
+             * would not be undone by the reduced uxLength. */
+            configASSERT( ( xPosition != queueOVERWRITE ) || ( pxQueue->pcReserved == NULL ) );
+        }
+        #endif
+
+        prvCopyItem( ( void * ) pxQueue->u.xQueue.pcReadFrom, pvItemToQueue, pxQueue->uxItemSize ); /*lint !e961 !e9087 !e418 MISRA exception as the casts are only redundant for some ports.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes.  Assert checks null pointer only used when length is 0. */
+        pxQueue->u.xQueue.pcReadFrom -= pxQueue->uxItemSize;
+
+        if( pxQueue->u.xQueue.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+        {
+            pxQueue->u.xQueue.pcReadFrom = ( pxQueue->u.xQueue.pcTail - pxQueue->uxItemSize );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( xPosition == queueOVERWRITE )
+        {
+            if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+            {
+                /* An item is not being added but overwritten, so subtract
+                 * one from the recorded number of items in the queue so when
+                 * one is added again below the number of recorded items remains
+                 * correct. */
+                --uxMessagesWaiting;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+    #if ( configUSE_QUEUE_ZERO_COPY == 1 )
     {
-        /* The queue could have been allocated statically or dynamically, so
-         * check before attempting to free the memory. */
-        if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+        if( ( xPosition == queueSEND_TO_BACK ) && ( prvHoldBackSentItems( pxQueue, ( UBaseType_t ) 1 ) != pdFALSE ) )
         {
-            vPortFree( pxQueue );
+            return xReturn;
         }
         else
         {
             mtCOVERAGE_TEST_MARKER();
         }
     }
-    #else /* if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) ) */
+    #endif
+
+    pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( uxMessagesWaiting + ( UBaseType_t ) 1 );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyDataFromQueue( Queue_t * const pxQueue,
+                                  void * const pvBuffer )
+{
+    if( pxQueue->uxItemSize != ( UBaseType_t ) 0 )
     {
-        /* The queue must have been statically allocated, so is not going to be
-         * deleted.  Avoid compiler warnings about the unused parameter. */
-        ( void ) pxQueue;
+        pxQueue->u.xQueue.pcReadFrom += pxQueue->uxItemSize;           /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+
+        if( pxQueue->u.xQueue.pcReadFrom >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+        {
+            pxQueue->u.xQueue.pcReadFrom = pxQueue->pcHead;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        prvCopyItem( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
     }
-    #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
 }
 /*-----------------------------------------------------------*/
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+static void prvCopyMultipleToQueue( Queue_t * const pxQueue,
+                                    const int8_t * pcItemsToQueue,
+                                    const UBaseType_t uxCount )
+{
+    /* This function is called from a critical section. */
+    size_t xBytes = ( size_t ) uxCount * ( size_t ) pxQueue->uxItemSize;
+    const size_t xBytesToEnd = ( size_t ) ( pxQueue->u.xQueue.pcTail - pxQueue->pcWriteTo ); /*lint !e946 !e9016 Pointer arithmetic on char types ok. */
+
+    /* Fill the storage area up to its end first, then wrap to the start. */
+    if( xBytes >= xBytesToEnd )
+    {
+        ( void ) memcpy( ( void * ) pxQueue->pcWriteTo, ( const void * ) pcItemsToQueue, xBytesToEnd ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports. */
+        pcItemsToQueue += xBytesToEnd;
+        xBytes -= xBytesToEnd;
+        pxQueue->pcWriteTo = pxQueue->pcHead;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( xBytes > ( size_t ) 0 )
+    {
+        ( void ) memcpy( ( void * ) pxQueue->pcWriteTo, ( const void * ) pcItemsToQueue, xBytes ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports. */
+        pxQueue->pcWriteTo += xBytes;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+    {
+        if( prvHoldBackSentItems( pxQueue, uxCount ) != pdFALSE )
+        {
+            return;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif
+
+    pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( pxQueue->uxMessagesWaiting + uxCount );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyMultipleFromQueue( Queue_t * const pxQueue,
+                                      int8_t * pcBuffer,
+                                      const UBaseType_t uxCount )
+{
+    /* This function is called from a critical section. */
+    size_t xBytes = ( size_t ) uxCount * ( size_t ) pxQueue->uxItemSize;
+    size_t xBytesToEnd;
+    int8_t * pcReadFrom;
+
+    if( xBytes > ( size_t ) 0 )
+    {
+        /* pcReadFrom points to the last item read, so the first item to read
+         * is the one after it. */
+        pcReadFrom = pxQueue->u.xQueue.pcReadFrom + pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok. */
+
+        if( pcReadFrom >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+        {
+            pcReadFrom = pxQueue->pcHead;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        xBytesToEnd = ( size_t ) ( pxQueue->u.xQueue.pcTail - pcReadFrom ); /*lint !e946 !e9016 Pointer arithmetic on char types ok. */
+
+        if( xBytes > xBytesToEnd )
+        {
+            ( void ) memcpy( ( void * ) pcBuffer, ( void * ) pcReadFrom, xBytesToEnd ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports. */
+            pcBuffer += xBytesToEnd;
+            xBytes -= xBytesToEnd;
+            pcReadFrom = pxQueue->pcHead;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        ( void ) memcpy( ( void * ) pcBuffer, ( void * ) pcReadFrom, xBytes ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports. */
+
+        /* Leave pcReadFrom on the last item read, as prvCopyDataFromQueue()
+         * does. */
+        pxQueue->u.xQueue.pcReadFrom = pcReadFrom + xBytes - pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok. */
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( pxQueue->uxMessagesWaiting - uxCount );
+
+    #if ( configUSE_QUEUE_ZERO_COPY == 1 )
+    {
+        prvHoldBackFreedSlots( pxQueue, uxCount );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUnblockMultiple( List_t * const pxEventList,
+                                      UBaseType_t uxMaxTasks )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    /* This function is called from a critical section. */
+
+    while( ( uxMaxTasks > ( UBaseType_t ) 0 ) && ( listLIST_IS_EMPTY( pxEventList ) == pdFALSE ) )
+    {
+        if( xTaskRemoveFromEventList( pxEventList ) != pdFALSE )
+        {
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        --uxMaxTasks;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNotifyItemsSent( Queue_t * const pxQueue,
+                                      UBaseType_t uxItemsSent )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    /* This function is called from a critical section. */
+
+    #if ( configUSE_QUEUE_SETS == 1 )
+    {
+        if( pxQueue->pxQueueSetContainer != NULL )
+        {
+            /* The set holds one entry per item in its member queues. */
+            while( uxItemsSent > ( UBaseType_t ) 0 )
+            {
+                if( prvNotifyQueueSetContainer( pxQueue ) != pdFALSE )
+                {
+                    xReturn = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                --uxItemsSent;
+            }
+        }
+        else
+        {
+            xReturn = prvUnblockMultiple( &( pxQueue->xTasksWaitingToReceive ), uxItemsSent );
+        }
+    }
+    #else /* configUSE_QUEUE_SETS */
+    {
+        xReturn = prvUnblockMultiple( &( pxQueue->xTasksWaitingToReceive ), uxItemsSent );
+    }
+    #endif /* configUSE_QUEUE_SETS */
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_ZERO_COPY == 1 )
+
+    static BaseType_t prvHoldBackSentItems( Queue_t * const pxQueue,
+                                            const UBaseType_t uxCount )
+    {
+        BaseType_t xReturn = pdFALSE;
+
+        /* This function is called from a critical section. */
+
+        if( pxQueue->pcReserved != NULL )
+        {
+            /* The slots stay out of use, uncounted, until xQueueCommit(). */
+            pxQueue->uxUnpublished += uxCount;
+            pxQueue->uxLength -= uxCount;
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvHoldBackFreedSlots( Queue_t * const pxQueue,
+                                       const UBaseType_t uxCount )
+    {
+        /* This function is called from a critical section. */
+
+        if( pxQueue->pcAcquired != NULL )
+        {
+            /* The next item is written in front of the acquired slot, so
+             * slots behind it only become free again in xQueueRelease(). */
+            pxQueue->uxUnreleased += uxCount;
+            pxQueue->uxLength -= uxCount;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_QUEUE_ZERO_COPY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+
+    static BaseType_t prvTakeMutexFast( Queue_t * const pxQueue )
+    {
+        BaseType_t xReturn = pdFALSE;
+        TaskHandle_t xCurrentTask;
+
+        if( ( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX ) &&
+            ( prvIsQueueInSet( pxQueue ) == pdFALSE ) &&
+            ( prvHasPriorityCeiling( pxQueue ) == pdFALSE ) &&
+            ( pxQueue->u.xSemaphore.xMutexHolder == NULL ) &&
+            ( pxQueue->uxMessagesWaiting != ( UBaseType_t ) 0 ) )
+        {
+            xCurrentTask = xTaskGetCurrentTaskHandle();
+
+            /* Fails if another task took the mutex since it was checked. */
+            if( ( xCurrentTask != NULL ) &&
+                ( Atomic_CompareAndSwapPointers_p32( ( void * volatile * ) &( pxQueue->u.xSemaphore.xMutexHolder ),
+                                                     xCurrentTask, NULL ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS ) )
+            {
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvGiveMutexFast( Queue_t * const pxQueue )
+    {
+        BaseType_t xReturn = pdFALSE;
+        TaskHandle_t xMutexHolder;
+
+        if( ( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX ) && ( prvIsQueueInSet( pxQueue ) == pdFALSE ) )
+        {
+            xMutexHolder = pxQueue->u.xSemaphore.xMutexHolder;
+
+            /* Only the holder can give a mutex, and only while no other task
+             * has found it held can it be given without a critical section.
+             * If a waiting task marks the holder between this read and the
+             * swap then the swap fails. */
+            if( ( xMutexHolder != NULL ) &&
+                ( ( ( ( portPOINTER_SIZE_TYPE ) xMutexHolder ) & queueMUTEX_HOLDER_COUNTED ) == 0U ) )
+            {
+                configASSERT( xMutexHolder == xTaskGetCurrentTaskHandle() );
+
+                if( Atomic_CompareAndSwapPointers_p32( ( void * volatile * ) &( pxQueue->u.xSemaphore.xMutexHolder ),
+                                                       NULL, xMutexHolder ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    xReturn = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvGetSemaphoreCount( Queue_t * const pxQueue )
+    {
+        /* This function is called from a critical section. */
+
+        if( prvIsMutexHeldUncounted( pxQueue ) )
+        {
+            /* Record the holder as the slow path would have done when it took
+             * the mutex, so priority inheritance works and the holder's give
+             * wakes the waiting tasks. */
+            vTaskIncrementMutexHeldCountOf( pxQueue->u.xSemaphore.xMutexHolder );
+            pxQueue->u.xSemaphore.xMutexHolder = prvCountedMutexHolder( pxQueue->u.xSemaphore.xMutexHolder );
+            pxQueue->uxMessagesWaiting = ( UBaseType_t ) 0;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return pxQueue->uxMessagesWaiting;
+    }
+
+#endif /* configUSE_MUTEX_FAST_PATH */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_READ_WRITE_LOCKS == 1 )
+
+    static BaseType_t prvTakeReadWriteLock( Queue_t * const pxQueue,
+                                            TickType_t xTicksToWait,
+                                            const BaseType_t xWrite )
+    {
+        BaseType_t xEntryTimeSet = pdFALSE;
+        TimeOut_t xTimeOut;
+        BaseType_t xInheritanceOccurred = pdFALSE;
+        List_t * const pxWaitingList = ( xWrite != pdFALSE ) ? &( pxQueue->xTasksWaitingToSend ) : &( pxQueue->xTasksWaitingToReceive );
+
+        configASSERT( pxQueue );
+
+        /* Check this really is a read write lock. */
+        configASSERT( prvIsReadWriteLock( pxQueue ) != pdFALSE );
+
+        /* Cannot block if the scheduler is suspended. */
+        #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+        {
+            configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+        }
+        #endif
 
-    UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue )
-    {
-        return ( ( Queue_t * ) xQueue )->uxQueueNumber;
-    }
+        /*lint -save -e904 This function relaxes the coding standard somewhat to allow return
+         * statements within the function itself.  This is done in the interest
+         * of execution time efficiency. */
+        for( ; ; )
+        {
+            taskENTER_CRITICAL();
+            {
+                if( prvIsReadWriteLockFree( pxQueue, xWrite ) != pdFALSE )
+                {
+                    traceQUEUE_RECEIVE( pxQueue );
 
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+                    if( xWrite != pdFALSE )
+                    {
+                        /* Record the information required to implement
+                         * priority inheritance should it become necessary. */
+                        pxQueue->u.xReadWriteLock.xWriter = pvTaskIncrementMutexHeldCount();
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+                        if( xEntryTimeSet != pdFALSE )
+                        {
+                            ( pxQueue->u.xReadWriteLock.uxWritersWaiting )--;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    else
+                    {
+                        pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( pxQueue->uxMessagesWaiting + ( UBaseType_t ) 1 );
+                    }
 
-    void vQueueSetQueueNumber( QueueHandle_t xQueue,
-                               UBaseType_t uxQueueNumber )
-    {
-        ( ( Queue_t * ) xQueue )->uxQueueNumber = uxQueueNumber;
-    }
+                    taskEXIT_CRITICAL();
+                    return pdPASS;
+                }
+                else
+                {
+                    if( xTicksToWait == ( TickType_t ) 0 )
+                    {
+                        /* The lock is not free and no block time is specified
+                         * (or the block time has expired) so exit now. */
+                        taskEXIT_CRITICAL();
+                        prvAbandonReadWriteLockWait( pxQueue, xWrite, xEntryTimeSet, xInheritanceOccurred );
+                        traceQUEUE_RECEIVE_FAILED( pxQueue );
+                        return errQUEUE_EMPTY;
+                    }
+                    else if( xEntryTimeSet == pdFALSE )
+                    {
+                        /* The lock is not free and a block time was specified
+                         * so configure the timeout structure ready to block.
+                         * From now on a writer holds off new readers. */
+                        vTaskInternalSetTimeOutState( &xTimeOut );
+                        xEntryTimeSet = pdTRUE;
 
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+                        if( xWrite != pdFALSE )
+                        {
+                            ( pxQueue->u.xReadWriteLock.uxWritersWaiting )++;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    else
+                    {
+                        /* Entry time was already set. */
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+            /* Other tasks can give and take the lock now the critical section
+             * has been exited. */
 
-    uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
-    {
-        return ( ( Queue_t * ) xQueue )->ucQueueType;
-    }
+            vTaskSuspendAll();
+            prvLockQueue( pxQueue );
 
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+            /* Update the timeout state to see if it has expired yet. */
+            if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+            {
+                if( prvIsReadWriteLockBusy( pxQueue, xWrite ) != pdFALSE )
+                {
+                    traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
 
-UBaseType_t uxQueueGetQueueItemSize( QueueHandle_t xQueue ) /* PRIVILEGED_FUNCTION */
-{
-    return ( ( Queue_t * ) xQueue )->uxItemSize;
-}
-/*-----------------------------------------------------------*/
+                    /* Only a writer can inherit a priority.  The readers
+                     * holding the lock are not recorded. */
+                    taskENTER_CRITICAL();
+                    {
+                        if( pxQueue->u.xReadWriteLock.xWriter != NULL )
+                        {
+                            xInheritanceOccurred = xTaskPriorityInherit( pxQueue->u.xReadWriteLock.xWriter );
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    taskEXIT_CRITICAL();
 
-UBaseType_t uxQueueGetQueueLength( QueueHandle_t xQueue ) /* PRIVILEGED_FUNCTION */
-{
-    return ( ( Queue_t * ) xQueue )->uxLength;
-}
-/*-----------------------------------------------------------*/
+                    vTaskPlaceOnEventList( pxWaitingList, xTicksToWait );
+                    prvUnlockQueue( pxQueue );
 
-#if ( configUSE_MUTEXES == 1 )
+                    if( xTaskResumeAll() == pdFALSE )
+                    {
+                        #if ( configNUMBER_OF_CORES == 1 )
+                        {
+                            portYIELD_WITHIN_API();
+                        }
+                        #else /* #if ( configNUMBER_OF_CORES == 1 ) */
+                        {
+                            vTaskYieldWithinAPI();
+                        }
+                        #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    /* There was no timeout and the lock is free, so attempt
+                     * to take it again. */
+                    prvUnlockQueue( pxQueue );
+                    ( void ) xTaskResumeAll();
+                }
+            }
+            else
+            {
+                /* Timed out. */
+                prvUnlockQueue( pxQueue );
+                ( void ) xTaskResumeAll();
 
-    static UBaseType_t prvGetDisinheritPriorityAfterTimeout( const Queue_t * const pxQueue )
+                /* If the lock is still not free exit now as the timeout has
+                 * expired.  Otherwise return to attempt to take it. */
+                if( prvIsReadWriteLockBusy( pxQueue, xWrite ) != pdFALSE )
+                {
+                    prvAbandonReadWriteLockWait( pxQueue, xWrite, xEntryTimeSet, xInheritanceOccurred );
+                    traceQUEUE_RECEIVE_FAILED( pxQueue );
+                    return errQUEUE_EMPTY;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        } /*lint -restore */
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvIsReadWriteLockFree( const Queue_t * pxQueue,
+                                              const BaseType_t xWrite )
     {
-        UBaseType_t uxHighestPriorityOfWaitingTasks;
+        BaseType_t xReturn = pdFALSE;
 
-        /* If a task waiting for a mutex causes the mutex holder to inherit a
-         * priority, but the waiting task times out, then the holder should
-         * disinherit the priority - but only down to the highest priority of any
-         * other tasks that are waiting for the same mutex.  For this purpose,
-         * return the priority of the highest priority task that is waiting for the
-         * mutex. */
-        if( listCURRENT_LIST_LENGTH( &( pxQueue->xTasksWaitingToReceive ) ) > 0U )
+        if( pxQueue->u.xReadWriteLock.xWriter == NULL )
         {
-            uxHighestPriorityOfWaitingTasks = ( UBaseType_t ) ( ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxQueue->xTasksWaitingToReceive ) ) );
+            if( xWrite != pdFALSE )
+            {
+                if( pxQueue->uxMessagesWaiting == ( UBaseType_t ) 0 )
+                {
+                    xReturn = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                if( ( pxQueue->u.xReadWriteLock.uxWritersWaiting == ( UBaseType_t ) 0 ) &&
+                    ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) )
+                {
+                    xReturn = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
         }
         else
         {
-            uxHighestPriorityOfWaitingTasks = tskIDLE_PRIORITY;
+            mtCOVERAGE_TEST_MARKER();
         }
 
-        return uxHighestPriorityOfWaitingTasks;
+        return xReturn;
     }
-
-#endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
-                                      const void * pvItemToQueue,
-                                      const BaseType_t xPosition )
-{
-    BaseType_t xReturn = pdFALSE;
-    UBaseType_t uxMessagesWaiting;
-
-    /* This function is called from a critical section. */
-
-    uxMessagesWaiting = pxQueue->uxMessagesWaiting;
-
-    if( pxQueue->uxItemSize == ( UBaseType_t ) 0 )
+    static BaseType_t prvIsReadWriteLockBusy( const Queue_t * pxQueue,
+                                              const BaseType_t xWrite )
     {
-        #if ( configUSE_MUTEXES == 1 )
+        BaseType_t xReturn;
+
+        taskENTER_CRITICAL();
         {
-            if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+            if( prvIsReadWriteLockFree( pxQueue, xWrite ) != pdFALSE )
             {
-                /* The mutex is no longer being held. */
-                xReturn = xTaskPriorityDisinherit( pxQueue->u.xSemaphore.xMutexHolder );
-                pxQueue->u.xSemaphore.xMutexHolder = NULL;
+                xReturn = pdFALSE;
             }
             else
             {
-                mtCOVERAGE_TEST_MARKER();
+                xReturn = pdTRUE;
             }
         }
-        #endif /* configUSE_MUTEXES */
+        taskEXIT_CRITICAL();
+
+        return xReturn;
     }
-    else if( xPosition == queueSEND_TO_BACK )
+/*-----------------------------------------------------------*/
+
+    static void prvAbandonReadWriteLockWait( Queue_t * const pxQueue,
+                                             const BaseType_t xWrite,
+                                             const BaseType_t xWaited,
+                                             const BaseType_t xInheritanceOccurred )
     {
-        ( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
-        pxQueue->pcWriteTo += pxQueue->uxItemSize;                                                       /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+        UBaseType_t uxHighestWaitingPriority;
 
-        if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail )                                             /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+        if( xWaited != pdFALSE )
         {
-            pxQueue->pcWriteTo = pxQueue->pcHead;
+            taskENTER_CRITICAL();
+            {
+                /* As in xQueueSemaphoreTake(), the writer disinherits the
+                 * priority of this task, but only down to the priority of the
+                 * highest priority task still waiting for the lock. */
+                if( xInheritanceOccurred != pdFALSE )
+                {
+                    uxHighestWaitingPriority = prvGetDisinheritPriorityAfterTimeout( pxQueue );
+                    vTaskPriorityDisinheritAfterTimeout( pxQueue->u.xReadWriteLock.xWriter, uxHighestWaitingPriority );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                if( xWrite != pdFALSE )
+                {
+                    ( pxQueue->u.xReadWriteLock.uxWritersWaiting )--;
+
+                    if( ( pxQueue->u.xReadWriteLock.uxWritersWaiting == ( UBaseType_t ) 0 ) &&
+                        ( pxQueue->u.xReadWriteLock.xWriter == NULL ) )
+                    {
+                        /* Readers were only waiting for this writer. */
+                        if( prvUnblockReadWriteLockWaiters( pxQueue ) != pdFALSE )
+                        {
+                            queueYIELD_IF_USING_PREEMPTION();
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            taskEXIT_CRITICAL();
         }
         else
         {
             mtCOVERAGE_TEST_MARKER();
         }
     }
-    else
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvUnblockReadWriteLockWaiters( Queue_t * const pxQueue )
     {
-        ( void ) memcpy( ( void * ) pxQueue->u.xQueue.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e9087 !e418 MISRA exception as the casts are only redundant for some ports.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes.  Assert checks null pointer only used when length is 0. */
-        pxQueue->u.xQueue.pcReadFrom -= pxQueue->uxItemSize;
+        BaseType_t xReturn = pdFALSE;
 
-        if( pxQueue->u.xQueue.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
-        {
-            pxQueue->u.xQueue.pcReadFrom = ( pxQueue->u.xQueue.pcTail - pxQueue->uxItemSize );
-        }
-        else
-        {
-            mtCOVERAGE_TEST_MARKER();
-        }
+        /* This function is called from a critical section. */
 
-        if( xPosition == queueOVERWRITE )
+        if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
         {
-            if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+            /* Writers go first, once the last reader is gone. */
+            if( pxQueue->uxMessagesWaiting == ( UBaseType_t ) 0 )
             {
-                /* An item is not being added but overwritten, so subtract
-                 * one from the recorded number of items in the queue so when
-                 * one is added again below the number of recorded items remains
-                 * correct. */
-                --uxMessagesWaiting;
+                xReturn = xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) );
             }
             else
             {
                 mtCOVERAGE_TEST_MARKER();
             }
         }
-        else
-        {
-            mtCOVERAGE_TEST_MARKER();
-        }
-    }
-
-    pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( uxMessagesWaiting + ( UBaseType_t ) 1 );
-
-    return xReturn;
-}
-/*-----------------------------------------------------------*/
-
-static void prvCopyDataFromQueue( Queue_t * const pxQueue,
-                                  void * const pvBuffer )
-{
-    if( pxQueue->uxItemSize != ( UBaseType_t ) 0 )
-    {
-        pxQueue->u.xQueue.pcReadFrom += pxQueue->uxItemSize;           /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
-
-        if( pxQueue->u.xQueue.pcReadFrom >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+        else if( pxQueue->u.xReadWriteLock.uxWritersWaiting == ( UBaseType_t ) 0 )
         {
-            pxQueue->u.xQueue.pcReadFrom = pxQueue->pcHead;
+            /* A writer that has been unblocked but has not run yet still holds
+             * off the readers, otherwise they can all read at once. */
+            xReturn = prvUnblockMultiple( &( pxQueue->xTasksWaitingToReceive ), pxQueue->uxLength - pxQueue->uxMessagesWaiting );
         }
         else
         {
             mtCOVERAGE_TEST_MARKER();
         }
 
-        ( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
+        return xReturn;
     }
-}
+
+#endif /* configUSE_READ_WRITE_LOCKS */
 /*-----------------------------------------------------------*/
 
 static void prvUnlockQueue( Queue_t * const pxQueue )
@@ -311,7 +311,6 @@ typedef struct tskTaskControlBlock       /* The old naming convention is used to
 
     ListItem_t xStateListItem;                  /**< The list that the state list item of a task is reference from denotes the state of that task (Ready, Blocked, Suspended ). */
     ListItem_t xEventListItem;                  /**< Used to reference a task from an event list. */
-    ListItem_t xSemaphoreWaitItem;              /**< Used to reference a task from a seamphore waiting list. */
     UBaseType_t uxPriority;                     /**< The priority of the task.  0 is the lowest priority. */
     StackType_t * pxStack;                      /**< Points to the start of the stack. */
     #if ( configNUMBER_OF_CORES > 1 )
@@ -1595,7 +1594,6 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
 
     vListInitialiseItem( &( pxNewTCB->xStateListItem ) );
     vListInitialiseItem( &( pxNewTCB->xEventListItem ) );
-    vListInitialiseItem( &( pxNewTCB->xSemaphoreWaitItem ) );
 
     /* Set the pxNewTCB as a link back from the ListItem_t.  This is so we can get
      * back to  the containing TCB from a generic item in a list. */
@@ -1605,13 +1603,6 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
     listSET_LIST_ITEM_VALUE( &( pxNewTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxPriority ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
     listSET_LIST_ITEM_OWNER( &( pxNewTCB->xEventListItem ), pxNewTCB );
 
-    /* Initialize semaphore waiting list item
-     * We want to order waiting list from highest to lowest priority */
-    listSET_LIST_ITEM_VALUE(
-        &( pxNewTCB->xSemaphoreWaitItem ),
-        ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxPriority );
-    listSET_LIST_ITEM_OWNER( &( pxNewTCB->xSemaphoreWaitItem ), pxNewTCB );
-
     #if ( portUSING_MPU_WRAPPERS == 1 )
     {
         vPortStoreTaskMPUSettings( &( pxNewTCB->xMPUSettings ), xRegions, pxNewTCB->pxStack, ulStackDepth );
@@ -4787,17 +4778,6 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList,
 }
 /*-----------------------------------------------------------*/
 
-void vTaskPlaceOnSemaphoreList( List_t * const pxSemaphoreList )
-{
-    configASSERT( pxSemaphoreList );
-
-    /* Semaphore waiting item should not be on another list */
-    configASSERT( pxCurrentTCB->xSemaphoreWaitItem.pxContainer == NULL );
-
-    vListInsert( pxSemaphoreList, &( pxCurrentTCB->xSemaphoreWaitItem ) );
-}
-/*-----------------------------------------------------------*/
-
 #if ( configUSE_TIMERS == 1 )
 
     void vTaskPlaceOnEventListRestricted( List_t * const pxEventList,
@@ -4923,54 +4903,6 @@ BaseType_t xTaskRemoveFromEventList ( const List_t * const pxEventList )
 }
 /*-----------------------------------------------------------*/
 
-void vTaskRemoveFromSemaphoreList( const List_t * const pxSemaphoreList )
-{
-    configASSERT( pxSemaphoreList );
-
-    /* Check that this task's semaphore waiting item is indeed in this list */
-    configASSERT( pxCurrentTCB->xSemaphoreWaitItem.pxContainer == pxSemaphoreList );
-
-    listREMOVE_ITEM( &( pxCurrentTCB->xSemaphoreWaitItem ) );
-}
-/*-----------------------------------------------------------*/
-
-void vTaskPopFromSemaphoreList( const List_t * const pxSemaphoreList )
-{
-    configASSERT( pxSemaphoreList );
-
-    /* Get task whose item we should remove from semaphore list and notify */
-    TaskHandle_t pxHeadOwner = listGET_OWNER_OF_HEAD_ENTRY( pxSemaphoreList );
-    configASSERT( pxHeadOwner );
-
-    /* Remove the item */
-    listREMOVE_ITEM( &( pxHeadOwner->xSemaphoreWaitItem ) );
-
-    /* Notify task that it ready */
-    xTaskNotifyGive( pxHeadOwner );
-}
-/*-----------------------------------------------------------*/
-
-BaseType_t xTaskPopFromSemaphoreListFromISR ( const List_t * const pxSemaphoreList )
-{
-    configASSERT( pxSemaphoreList );
-
-    /* Get task whose item we should remove from list and notify */
-    TaskHandle_t pxHeadOwner = listGET_OWNER_OF_HEAD_ENTRY( pxSemaphoreList );
-    configASSERT( pxHeadOwner );
-
-    /* Remove the item */
-    listREMOVE_ITEM( &( pxHeadOwner->xSemaphoreWaitItem ) );
-
-    /* Notify task that it is ready */
-    BaseType_t xHigherPriorityTaskWoken;
-    vTaskNotifyGiveFromISR( pxHeadOwner, &xHigherPriorityTaskWoken );
-
-    /* Returns if the removed task priority is greater than priority of
-     * currently running task */
-    return xHigherPriorityTaskWoken;
-}
-/*-----------------------------------------------------------*/
-
 void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem,
                                         const TickType_t xItemValue )
 {
@@ -6861,6 +6793,77 @@ TickType_t uxTaskResetEventItemValue( void )
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+
+    void vTaskIncrementMutexHeldCountOf( TaskHandle_t xMutexHolder )
+    {
+        TCB_t * const pxTCB = xMutexHolder;
+
+        /* Only called from a critical section, for a task that holds a mutex. */
+        configASSERT( pxTCB );
+        ( pxTCB->uxMutexesHeld )++;
+    }
+
+#endif /* configUSE_MUTEX_FAST_PATH */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEX_PRIORITY_CEILING == 1 )
+
+    void vTaskPriorityRaiseToCeiling( UBaseType_t uxCeilingPriority )
+    {
+        TCB_t * const pxTCB = pxCurrentTCB;
+
+        /* If xSemaphoreCreateMutexWithCeiling() is called before any tasks have
+         * been created then pxCurrentTCB will be NULL. */
+        if( pxTCB != NULL )
+        {
+            /* The ceiling must be at least the priority of every task that uses
+             * the mutex, otherwise the ceiling protocol cannot bound blocking. */
+            configASSERT( pxTCB->uxBasePriority <= uxCeilingPriority );
+
+            if( pxTCB->uxPriority < uxCeilingPriority )
+            {
+                /* Only reset the event list item value if the value is not
+                 * being used for anything else. */
+                if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
+                {
+                    listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxCeilingPriority ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                /* The calling task is running, so is in a ready list and has
+                 * to be moved to the list for its new priority. */
+                if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
+                {
+                    portRESET_READY_PRIORITY( pxTCB->uxPriority, uxTopReadyPriority );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pxTCB->uxPriority = uxCeilingPriority;
+                prvAddTaskToReadyList( pxTCB );
+
+                traceTASK_PRIORITY_INHERIT( pxTCB, uxCeilingPriority );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_MUTEX_PRIORITY_CEILING */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_TASK_NOTIFICATIONS == 1 )
 
     uint32_t ulTaskGenericNotifyTake( UBaseType_t uxIndexToWaitOn,
@@ -0,0 +1,352 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file queue_multiple_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../queue_utest_common.h"
+
+/* Queue includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "queue.h"
+#include "semphr.h"
+#include "mock_fake_port.h"
+
+/* ===============================  CONSTANTS =============================== */
+
+#define MULTIPLE_QUEUE_LENGTH    5
+
+/* ============================  GLOBAL VARIABLES =========================== */
+
+/**
+ * @brief Queue handle shared with the timeout callbacks.
+ */
+static QueueHandle_t xQueueHandleStatic = NULL;
+
+/* ==========================  CALLBACK FUNCTIONS =========================== */
+
+/* ============================= Unity Fixtures ============================= */
+
+void setUp( void )
+{
+    commonSetUp();
+}
+
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+void suiteSetUp()
+{
+    commonSuiteSetUp();
+}
+
+int suiteTearDown( int numFailures )
+{
+    return commonSuiteTearDown( numFailures );
+}
+
+/* ==========================  Helper functions =========================== */
+
+/* =============================  Test Cases ============================== */
+
+/**
+ * @brief Test xQueueSendMultiple with an invalid QueueHandle
+ * @coverage xQueueSendMultiple
+ */
+void test_xQueueSendMultiple_invalid_handle( void )
+{
+    uint32_t testVal = 0;
+
+    EXPECT_ASSERT_BREAK( xQueueSendMultiple( NULL, &testVal, 1, 0 ) );
+}
+
+/**
+ * @brief Test xQueueSendMultiple on a binary semaphore
+ * @details Semaphores have no items to copy so the call must assert.
+ * @coverage xQueueSendMultiple
+ */
+void test_xQueueSendMultiple_semaphore( void )
+{
+    SemaphoreHandle_t xSemaphore = xSemaphoreCreateBinary();
+    uint32_t testVal = 0;
+
+    EXPECT_ASSERT_BREAK( xQueueSendMultiple( xSemaphore, &testVal, 1, 0 ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xQueueSendMultiple and xQueueReceiveMultiple with zero items
+ * @coverage xQueueSendMultiple xQueueReceiveMultiple
+ */
+void test_xQueueSendMultiple_zero_items( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t testVal = 0;
+
+    TEST_ASSERT_EQUAL( 0, xQueueSendMultiple( xQueue, &testVal, 0, TICKS_TO_WAIT ) );
+    TEST_ASSERT_EQUAL( 0, xQueueReceiveMultiple( xQueue, &testVal, 0, TICKS_TO_WAIT ) );
+    TEST_ASSERT_EQUAL( 0, uxQueueMessagesWaiting( xQueue ) );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueSendMultiple with more items than there is space for
+ * @details Verify that only the items that fit are sent and that they are
+ * received in order, including when the copy wraps around the end of the
+ * storage area.
+ * @coverage xQueueSendMultiple xQueueReceiveMultiple prvCopyMultipleToQueue prvCopyMultipleFromQueue
+ */
+void test_xQueueSendMultiple_partial_wraparound( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t testVals[ MULTIPLE_QUEUE_LENGTH + 2 ];
+    uint32_t checkVals[ MULTIPLE_QUEUE_LENGTH + 2 ];
+    size_t i;
+
+    for( i = 0; i < MULTIPLE_QUEUE_LENGTH + 2; i++ )
+    {
+        testVals[ i ] = getNextMonotonicTestValue();
+    }
+
+    /* Move the read and write positions to the middle of the storage area. */
+    TEST_ASSERT_EQUAL( 3, xQueueSendMultiple( xQueue, testVals, 3, 0 ) );
+    TEST_ASSERT_EQUAL( 3, xQueueReceiveMultiple( xQueue, checkVals, MULTIPLE_QUEUE_LENGTH, 0 ) );
+    TEST_ASSERT_EQUAL_UINT32_ARRAY( testVals, checkVals, 3 );
+
+    /* Only MULTIPLE_QUEUE_LENGTH items fit, and the copy wraps. */
+    TEST_ASSERT_EQUAL( MULTIPLE_QUEUE_LENGTH, xQueueSendMultiple( xQueue, &testVals[ 2 ], MULTIPLE_QUEUE_LENGTH + 2, 0 ) );
+    TEST_ASSERT_EQUAL( MULTIPLE_QUEUE_LENGTH, uxQueueMessagesWaiting( xQueue ) );
+    TEST_ASSERT_EQUAL( 0, xQueueSendMultiple( xQueue, testVals, 1, 0 ) );
+
+    /* The single item API sees the same order. */
+    TEST_ASSERT_EQUAL( pdTRUE, xQueuePeek( xQueue, &checkVals[ 0 ], 0 ) );
+    TEST_ASSERT_EQUAL( testVals[ 2 ], checkVals[ 0 ] );
+
+    TEST_ASSERT_EQUAL( 2, xQueueReceiveMultiple( xQueue, checkVals, 2, 0 ) );
+    TEST_ASSERT_EQUAL_UINT32_ARRAY( &testVals[ 2 ], checkVals, 2 );
+    TEST_ASSERT_EQUAL( 3, xQueueReceiveMultiple( xQueue, checkVals, MULTIPLE_QUEUE_LENGTH + 2, 0 ) );
+    TEST_ASSERT_EQUAL_UINT32_ARRAY( &testVals[ 4 ], checkVals, 3 );
+    TEST_ASSERT_EQUAL( 0, xQueueReceiveMultiple( xQueue, checkVals, 1, 0 ) );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueSendMultiple with a higher priority task waiting
+ * @details The waiting task is unblocked and the caller yields.
+ * @coverage xQueueSendMultiple prvNotifyItemsSent prvUnblockMultiple
+ */
+void test_xQueueSendMultiple_task_waiting_higher_priority( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t testVals[ 3 ] = { 1, 2, 3 };
+
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+    td_task_addFakeTaskWaitingToReceiveFromQueue( xQueue );
+
+    TEST_ASSERT_EQUAL( 3, xQueueSendMultiple( xQueue, testVals, 3, 0 ) );
+
+    TEST_ASSERT_EQUAL( 0, listCURRENT_LIST_LENGTH( pxGetTasksWaitingToReceiveFromQueue( xQueue ) ) );
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueReceiveMultiple with a higher priority task waiting to send
+ * @coverage xQueueReceiveMultiple prvUnblockMultiple
+ */
+void test_xQueueReceiveMultiple_task_waiting_higher_priority( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t checkVals[ MULTIPLE_QUEUE_LENGTH ];
+
+    queue_common_add_sequential_to_queue( xQueue, MULTIPLE_QUEUE_LENGTH );
+
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+    td_task_addFakeTaskWaitingToSendToQueue( xQueue );
+
+    TEST_ASSERT_EQUAL( 2, xQueueReceiveMultiple( xQueue, checkVals, 2, 0 ) );
+    TEST_ASSERT_EQUAL( 0, checkVals[ 0 ] );
+    TEST_ASSERT_EQUAL( 1, checkVals[ 1 ] );
+
+    TEST_ASSERT_EQUAL( 0, listCURRENT_LIST_LENGTH( pxGetTasksWaitingToSendToQueue( xQueue ) ) );
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueSendMultiple on a full queue with a timeout
+ * @coverage xQueueSendMultiple
+ */
+void test_xQueueSendMultiple_blocking_timeout( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t testVal = getNextMonotonicTestValue();
+
+    queue_common_add_sequential_to_queue( xQueue, MULTIPLE_QUEUE_LENGTH );
+
+    TEST_ASSERT_EQUAL( 0, xQueueSendMultiple( xQueue, &testVal, 1, TICKS_TO_WAIT ) );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getCount_vPortYieldWithinAPI() );
+    TEST_ASSERT_EQUAL( MULTIPLE_QUEUE_LENGTH, uxQueueMessagesWaiting( xQueue ) );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Callback which adds an item to the test queue from an ISR.
+ */
+static BaseType_t xQueueReceiveMultiple_xTaskCheckForTimeOutCB( TimeOut_t * const pxTimeOut,
+                                                                TickType_t * const pxTicksToWait,
+                                                                int cmock_num_calls )
+{
+    BaseType_t xReturnValue = td_task_xTaskCheckForTimeOutStub( pxTimeOut, pxTicksToWait, cmock_num_calls );
+
+    if( cmock_num_calls == NUM_CALLS_TO_INTERCEPT )
+    {
+        uint32_t testVals[ 2 ];
+
+        testVals[ 0 ] = getNextMonotonicTestValue();
+        testVals[ 1 ] = getNextMonotonicTestValue();
+        TEST_ASSERT_EQUAL( 2, xQueueSendMultipleFromISR( xQueueHandleStatic, testVals, 2, NULL ) );
+    }
+
+    return xReturnValue;
+}
+
+/**
+ * @brief Test a blocking call to xQueueReceiveMultiple on a locked queue
+ * @details Items sent from an ISR while the queue is locked are received
+ * once the queue is unlocked.
+ * @coverage xQueueReceiveMultiple xQueueSendMultipleFromISR
+ */
+void test_xQueueReceiveMultiple_blocking_success_locked( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t checkVals[ MULTIPLE_QUEUE_LENGTH ];
+
+    xQueueHandleStatic = xQueue;
+
+    vFakePortAssertIfInterruptPriorityInvalid_Expect();
+    xTaskCheckForTimeOut_Stub( &xQueueReceiveMultiple_xTaskCheckForTimeOutCB );
+    uxTaskGetNumberOfTasks_IgnoreAndReturn( 2 );
+
+    TEST_ASSERT_EQUAL( 2, xQueueReceiveMultiple( xQueue, checkVals, MULTIPLE_QUEUE_LENGTH, TICKS_TO_WAIT ) );
+    TEST_ASSERT_EQUAL( getLastMonotonicTestValue() - 1, checkVals[ 0 ] );
+    TEST_ASSERT_EQUAL( getLastMonotonicTestValue(), checkVals[ 1 ] );
+
+    TEST_ASSERT_EQUAL( NUM_CALLS_TO_INTERCEPT, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( NUM_CALLS_TO_INTERCEPT, td_task_getCount_vPortYieldWithinAPI() );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueSendMultipleFromISR and xQueueReceiveMultipleFromISR
+ * @coverage xQueueSendMultipleFromISR xQueueReceiveMultipleFromISR
+ */
+void test_xQueueSendMultipleFromISR_partial( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t testVals[ MULTIPLE_QUEUE_LENGTH + 1 ] = { 1, 2, 3, 4, 5, 6 };
+    uint32_t checkVals[ MULTIPLE_QUEUE_LENGTH + 1 ];
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    vFakePortAssertIfInterruptPriorityInvalid_Ignore();
+
+    TEST_ASSERT_EQUAL( MULTIPLE_QUEUE_LENGTH, xQueueSendMultipleFromISR( xQueue, testVals, MULTIPLE_QUEUE_LENGTH + 1, &xHigherPriorityTaskWoken ) );
+    TEST_ASSERT_EQUAL( 0, xQueueSendMultipleFromISR( xQueue, testVals, 1, &xHigherPriorityTaskWoken ) );
+
+    TEST_ASSERT_EQUAL( MULTIPLE_QUEUE_LENGTH, xQueueReceiveMultipleFromISR( xQueue, checkVals, MULTIPLE_QUEUE_LENGTH + 1, &xHigherPriorityTaskWoken ) );
+    TEST_ASSERT_EQUAL_UINT32_ARRAY( testVals, checkVals, MULTIPLE_QUEUE_LENGTH );
+    TEST_ASSERT_EQUAL( 0, xQueueReceiveMultipleFromISR( xQueue, checkVals, 1, &xHigherPriorityTaskWoken ) );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xHigherPriorityTaskWoken );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueSendMultipleFromISR with a higher priority task waiting
+ * @coverage xQueueSendMultipleFromISR
+ */
+void test_xQueueSendMultipleFromISR_task_waiting_higher_priority( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t testVals[ 2 ] = { 1, 2 };
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    vFakePortAssertIfInterruptPriorityInvalid_Expect();
+
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+    td_task_addFakeTaskWaitingToReceiveFromQueue( xQueue );
+
+    TEST_ASSERT_EQUAL( 2, xQueueSendMultipleFromISR( xQueue, testVals, 2, &xHigherPriorityTaskWoken ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xHigherPriorityTaskWoken );
+    TEST_ASSERT_EQUAL( pdTRUE, td_task_getYieldPending() );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueReceiveMultipleFromISR on a locked queue
+ * @details The receive lock is incremented once per item received.
+ * @coverage xQueueReceiveMultipleFromISR
+ */
+void test_xQueueReceiveMultipleFromISR_locked( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( MULTIPLE_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t checkVals[ 3 ];
+
+    queue_common_add_sequential_to_queue( xQueue, MULTIPLE_QUEUE_LENGTH );
+
+    vFakePortAssertIfInterruptPriorityInvalid_Expect();
+    uxTaskGetNumberOfTasks_IgnoreAndReturn( MULTIPLE_QUEUE_LENGTH );
+
+    vSetQueueRxLock( xQueue, queueLOCKED_UNMODIFIED );
+
+    TEST_ASSERT_EQUAL( 3, xQueueReceiveMultipleFromISR( xQueue, checkVals, 3, NULL ) );
+
+    TEST_ASSERT_EQUAL( 3, cGetQueueRxLock( xQueue ) );
+
+    vSetQueueRxLock( xQueue, queueUNLOCKED );
+
+    vQueueDelete( xQueue );
+}
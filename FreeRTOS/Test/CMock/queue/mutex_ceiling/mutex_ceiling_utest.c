@@ -0,0 +1,274 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file mutex_ceiling_utest.c */
+
+#include "../queue_utest_common.h"
+
+/* Queue includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "semphr.h"
+#include "mock_fake_port.h"
+
+/* ============================  GLOBAL VARIABLES =========================== */
+
+#define CEILING_PRIORITY    ( tskIDLE_PRIORITY + 3 )
+
+/* Stand in task control blocks.  Their addresses are used as task handles,
+ * which must be aligned like real ones for the mutex fast path to use them. */
+static StaticTask_t xFakeTaskA;
+
+/* ==========================  CALLBACK FUNCTIONS =========================== */
+
+/* ============================= Unity Fixtures ============================= */
+
+void setUp( void )
+{
+    commonSetUp();
+}
+
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+void suiteSetUp()
+{
+    commonSuiteSetUp();
+}
+
+int suiteTearDown( int numFailures )
+{
+    return commonSuiteTearDown( numFailures );
+}
+
+/* ==========================  Helper functions =========================== */
+
+static SemaphoreHandle_t xCreateMutexTakenBy( TaskHandle_t xHolder )
+{
+    SemaphoreHandle_t xSemaphore;
+
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+    xSemaphore = xSemaphoreCreateMutexWithCeiling( CEILING_PRIORITY );
+    TEST_ASSERT_NOT_EQUAL( NULL, xSemaphore );
+
+    pvTaskIncrementMutexHeldCount_ExpectAndReturn( xHolder );
+    vTaskPriorityRaiseToCeiling_Expect( CEILING_PRIORITY );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xSemaphore, 0 ) );
+
+    return xSemaphore;
+}
+
+/* ==========================  Test Cases =========================== */
+
+/**
+ * @brief Test xSemaphoreCreateMutexWithCeiling with a valid ceiling.
+ * @coverage xQueueCreateMutexWithCeiling
+ */
+void test_macro_xSemaphoreCreateMutexWithCeiling_success( void )
+{
+    SemaphoreHandle_t xSemaphore = NULL;
+
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+
+    xSemaphore = xSemaphoreCreateMutexWithCeiling( CEILING_PRIORITY );
+
+    TEST_ASSERT_NOT_EQUAL( NULL, xSemaphore );
+    TEST_ASSERT_EQUAL( QUEUE_T_SIZE, getLastMallocSize() );
+    TEST_ASSERT_EQUAL( B_SEMPHR_AVAILABLE, uxSemaphoreGetCount( xSemaphore ) );
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetMutexHolder( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreCreateMutexWithCeiling with the idle priority as the ceiling.
+ * @coverage xQueueCreateMutexWithCeiling
+ */
+void test_macro_xSemaphoreCreateMutexWithCeiling_idle_priority( void )
+{
+    SemaphoreHandle_t xSemaphore = NULL;
+
+    fakeAssertExpectFail();
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+
+    xSemaphore = xSemaphoreCreateMutexWithCeiling( tskIDLE_PRIORITY );
+
+    TEST_ASSERT_EQUAL( true, fakeAssertGetFlagAndClear() );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreCreateMutexWithCeiling with a ceiling of configMAX_PRIORITIES.
+ * @coverage xQueueCreateMutexWithCeiling
+ */
+void test_macro_xSemaphoreCreateMutexWithCeiling_too_high( void )
+{
+    SemaphoreHandle_t xSemaphore = NULL;
+
+    fakeAssertExpectFail();
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+
+    xSemaphore = xSemaphoreCreateMutexWithCeiling( configMAX_PRIORITIES );
+
+    TEST_ASSERT_EQUAL( true, fakeAssertGetFlagAndClear() );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreCreateMutexWithCeilingStatic with a null buffer
+ * @coverage xQueueCreateMutexWithCeilingStatic
+ */
+void test_macro_xSemaphoreCreateMutexWithCeilingStatic_nullptr( void )
+{
+    SemaphoreHandle_t xSemaphore = INVALID_PTR;
+
+    /* Expect that xQueueCreate will assert due to the NULL buffer */
+    fakeAssertExpectFail();
+
+    xSemaphore = xSemaphoreCreateMutexWithCeilingStatic( CEILING_PRIORITY, NULL );
+
+    /* Check that configASSERT was called twice */
+    fakeAssertVerifyNumAssertsAndClear( 2 );
+
+    TEST_ASSERT_EQUAL( NULL, xSemaphore );
+    TEST_ASSERT_EQUAL( 0, getLastMallocSize() );
+}
+
+/**
+ * @brief Test xSemaphoreCreateMutexWithCeilingStatic with a valid buffer.
+ * @coverage xQueueCreateMutexWithCeilingStatic
+ */
+void test_macro_xSemaphoreCreateMutexWithCeilingStatic_success( void )
+{
+    SemaphoreHandle_t xSemaphore = NULL;
+    StaticSemaphore_t xSemaphoreBuffer;
+
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+
+    xSemaphore = xSemaphoreCreateMutexWithCeilingStatic( CEILING_PRIORITY, &xSemaphoreBuffer );
+
+    /* Check that no call to malloc occurred */
+    TEST_ASSERT_EQUAL( 0, getLastMallocSize() );
+
+    TEST_ASSERT_EQUAL( B_SEMPHR_AVAILABLE, uxSemaphoreGetCount( xSemaphore ) );
+
+    /* Taken through the slow path, which raises the holder to the ceiling */
+    pvTaskIncrementMutexHeldCount_ExpectAndReturn( ( TaskHandle_t ) &xFakeTaskA );
+    vTaskPriorityRaiseToCeiling_Expect( CEILING_PRIORITY );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xSemaphore, 0 ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreTake and xSemaphoreGive on a mutex with a ceiling.
+ * @details The holder is raised to the ceiling on take, without the fast
+ * path, and gives the mutex back through xTaskPriorityDisinherit.
+ * @coverage xQueueSemaphoreTake prvTakeMutexFast prvGiveMutexFast
+ */
+void test_macro_xSemaphoreTake_xSemaphoreGive_ceiling( void )
+{
+    TaskHandle_t xHolder = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xSemaphore = xCreateMutexTakenBy( xHolder );
+
+    TEST_ASSERT_EQUAL( xHolder, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_TAKEN, uxSemaphoreGetCount( xSemaphore ) );
+
+    /* Return pdTRUE to signify that the raised priority was dropped */
+    xTaskPriorityDisinherit_ExpectAndReturn( xHolder, pdTRUE );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGive( xSemaphore ) );
+
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_AVAILABLE, uxSemaphoreGetCount( xSemaphore ) );
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test a non blocking xSemaphoreTake on a mutex with a ceiling that is held.
+ * @coverage xQueueSemaphoreTake
+ */
+void test_macro_xSemaphoreTake_ceiling_held( void )
+{
+    SemaphoreHandle_t xSemaphore = xCreateMutexTakenBy( ( TaskHandle_t ) &xFakeTaskA );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTake( xSemaphore, 0 ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_TAKEN, uxSemaphoreGetCount( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test a blocking xSemaphoreTake on a mutex with a ceiling that is held.
+ * @details The waiting task does not change the priority of the holder, so
+ * there is nothing to disinherit when it times out.
+ * @coverage xQueueSemaphoreTake
+ */
+void test_macro_xSemaphoreTake_blocking_ceiling_held_no_inherit( void )
+{
+    SemaphoreHandle_t xSemaphore = xCreateMutexTakenBy( ( TaskHandle_t ) &xFakeTaskA );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTake( xSemaphore, TICKS_TO_WAIT ) );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getCount_vPortYieldWithinAPI() );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreTake on a mutex without a ceiling in the same build.
+ * @details The mutex still uses the fast path and priority inheritance.
+ * @coverage xQueueSemaphoreTake prvTakeMutexFast
+ */
+void test_macro_xSemaphoreTake_mutex_without_ceiling( void )
+{
+    TaskHandle_t xHolder = ( TaskHandle_t ) &xFakeTaskA;
+
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+    SemaphoreHandle_t xSemaphore = xSemaphoreCreateMutex();
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xHolder );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xSemaphore, 0 ) );
+
+    vTaskIncrementMutexHeldCountOf_Expect( xHolder );
+    xTaskPriorityInherit_ExpectAndReturn( xHolder, pdTRUE );
+    vTaskPriorityDisinheritAfterTimeout_Expect( xHolder, tskIDLE_PRIORITY );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTake( xSemaphore, 1 ) );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    vSemaphoreDelete( xSemaphore );
+}
@@ -0,0 +1,295 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file mutex_fast_path_utest.c */
+
+#include "../queue_utest_common.h"
+
+/* Queue includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "semphr.h"
+#include "mock_fake_port.h"
+
+/* ============================  GLOBAL VARIABLES =========================== */
+
+/* Stand in task control blocks.  Their addresses are used as task handles,
+ * which must be aligned like real ones for the fast path to use them. */
+static StaticTask_t xFakeTaskA;
+static StaticTask_t xFakeTaskB;
+
+/* ==========================  CALLBACK FUNCTIONS =========================== */
+
+/* ============================= Unity Fixtures ============================= */
+
+void setUp( void )
+{
+    commonSetUp();
+}
+
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+void suiteSetUp()
+{
+    commonSuiteSetUp();
+}
+
+int suiteTearDown( int numFailures )
+{
+    return commonSuiteTearDown( numFailures );
+}
+
+/* ==========================  Helper functions =========================== */
+
+static SemaphoreHandle_t xCreateMutexTakenBy( TaskHandle_t xHolder )
+{
+    SemaphoreHandle_t xSemaphore;
+
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+    xSemaphore = xSemaphoreCreateMutex();
+    TEST_ASSERT_NOT_EQUAL( NULL, xSemaphore );
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xHolder );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xSemaphore, 0 ) );
+
+    return xSemaphore;
+}
+
+/* ==========================  Test Cases =========================== */
+
+/**
+ * @brief Test xSemaphoreTake on a free mutex.
+ * @details The mutex is taken without counting it against the holder.
+ * @coverage xQueueSemaphoreTake prvTakeMutexFast
+ */
+void test_macro_xSemaphoreTake_mutex_fast( void )
+{
+    TaskHandle_t xHolder = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xSemaphore = xCreateMutexTakenBy( xHolder );
+
+    TEST_ASSERT_EQUAL( xHolder, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( xHolder, xSemaphoreGetMutexHolderFromISR( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_TAKEN, uxSemaphoreGetCount( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_TAKEN, uxSemaphoreGetCountFromISR( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreGive on a mutex taken through the fast path.
+ * @details The mutex is given back without disinheriting a priority.
+ * @coverage xQueueGenericSend prvGiveMutexFast
+ */
+void test_macro_xSemaphoreGive_mutex_fast( void )
+{
+    TaskHandle_t xHolder = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xSemaphore = xCreateMutexTakenBy( xHolder );
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xHolder );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGive( xSemaphore ) );
+
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_AVAILABLE, uxSemaphoreGetCount( xSemaphore ) );
+
+    /* And it can be taken again */
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xHolder );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xSemaphore, 0 ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreGive on a fast path mutex from a task that does not hold it.
+ * @coverage prvGiveMutexFast
+ */
+void test_macro_xSemaphoreGive_mutex_fast_not_holder( void )
+{
+    SemaphoreHandle_t xSemaphore = xCreateMutexTakenBy( ( TaskHandle_t ) &xFakeTaskA );
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( ( TaskHandle_t ) &xFakeTaskB );
+
+    EXPECT_ASSERT_BREAK( xSemaphoreGive( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreTake on a mutex before any task exists.
+ * @details With no current task the mutex is taken through the slow path.
+ * @coverage xQueueSemaphoreTake prvTakeMutexFast
+ */
+void test_macro_xSemaphoreTake_mutex_no_current_task( void )
+{
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+    SemaphoreHandle_t xSemaphore = xSemaphoreCreateMutex();
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( NULL );
+    pvTaskIncrementMutexHeldCount_ExpectAndReturn( NULL );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xSemaphore, 0 ) );
+
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_TAKEN, uxSemaphoreGetCount( xSemaphore ) );
+
+    /* Given back through the slow path */
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGive( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_AVAILABLE, uxSemaphoreGetCount( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test a non blocking xSemaphoreTake on a mutex held through the fast path.
+ * @details The holder is counted, and then gives the mutex through the slow path.
+ * @coverage xQueueSemaphoreTake prvGetSemaphoreCount prvGiveMutexFast
+ */
+void test_macro_xSemaphoreTake_mutex_fast_held( void )
+{
+    TaskHandle_t xHolder = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xSemaphore = xCreateMutexTakenBy( xHolder );
+
+    vTaskIncrementMutexHeldCountOf_Expect( xHolder );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTake( xSemaphore, 0 ) );
+
+    /* Only counted once */
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTake( xSemaphore, 0 ) );
+
+    TEST_ASSERT_EQUAL( xHolder, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_TAKEN, uxSemaphoreGetCount( xSemaphore ) );
+
+    xTaskPriorityDisinherit_ExpectAndReturn( xHolder, pdFALSE );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGive( xSemaphore ) );
+
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_AVAILABLE, uxSemaphoreGetCount( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test a blocking xSemaphoreTake on a mutex held through the fast path.
+ * @details The holder inherits the priority of the waiting task, and
+ * disinherits it again when the waiting task times out.
+ * @coverage xQueueSemaphoreTake prvGetSemaphoreCount
+ */
+void test_macro_xSemaphoreTake_blocking_mutex_fast_held_inherit_timeout( void )
+{
+    TaskHandle_t xHolder = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xSemaphore = xCreateMutexTakenBy( xHolder );
+
+    vTaskIncrementMutexHeldCountOf_Expect( xHolder );
+
+    for( int i = 0; i < TICKS_TO_WAIT; i++ )
+    {
+        /* Return pdTRUE to signify that priority inheritance occurred */
+        xTaskPriorityInherit_ExpectAndReturn( xHolder, pdTRUE );
+    }
+
+    vTaskPriorityDisinheritAfterTimeout_Expect( xHolder, tskIDLE_PRIORITY );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTake( xSemaphore, TICKS_TO_WAIT ) );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getCount_vPortYieldWithinAPI() );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test xSemaphoreTake on a binary semaphore.
+ * @details Only mutexes use the fast path.
+ * @coverage xQueueSemaphoreTake prvTakeMutexFast prvGiveMutexFast
+ */
+void test_macro_xSemaphoreTake_binary_semaphore_slow_path( void )
+{
+    SemaphoreHandle_t xSemaphore = xSemaphoreCreateBinary();
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGive( xSemaphore ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xSemaphore, 0 ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_TAKEN, uxSemaphoreGetCount( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test a recursive mutex taken through the fast path.
+ * @coverage xQueueTakeMutexRecursive xQueueGiveMutexRecursive
+ */
+void test_macro_xSemaphoreTakeRecursive_mutex_fast( void )
+{
+    TaskHandle_t xHolder = ( TaskHandle_t ) &xFakeTaskA;
+
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+    SemaphoreHandle_t xSemaphore = xSemaphoreCreateRecursiveMutex();
+
+    xTaskGetCurrentTaskHandle_IgnoreAndReturn( xHolder );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRecursive( xSemaphore, 0 ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRecursive( xSemaphore, 0 ) );
+    TEST_ASSERT_EQUAL( xHolder, xSemaphoreGetMutexHolder( xSemaphore ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRecursive( xSemaphore ) );
+    TEST_ASSERT_EQUAL( xHolder, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRecursive( xSemaphore ) );
+
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreGiveRecursive( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test a recursive mutex held through the fast path by another task.
+ * @details The holder is counted, so its last give goes through the slow path.
+ * @coverage xQueueTakeMutexRecursive xQueueGiveMutexRecursive prvGetSemaphoreCount
+ */
+void test_macro_xSemaphoreTakeRecursive_mutex_fast_held( void )
+{
+    TaskHandle_t xHolder = ( TaskHandle_t ) &xFakeTaskA;
+
+    xTaskPriorityDisinherit_ExpectAndReturn( NULL, pdFALSE );
+    SemaphoreHandle_t xSemaphore = xSemaphoreCreateRecursiveMutex();
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xHolder );
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xHolder );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRecursive( xSemaphore, 0 ) );
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( ( TaskHandle_t ) &xFakeTaskB );
+    vTaskIncrementMutexHeldCountOf_Expect( xHolder );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTakeRecursive( xSemaphore, 0 ) );
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xHolder );
+    xTaskPriorityDisinherit_ExpectAndReturn( xHolder, pdFALSE );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRecursive( xSemaphore ) );
+
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetMutexHolder( xSemaphore ) );
+    TEST_ASSERT_EQUAL( B_SEMPHR_AVAILABLE, uxSemaphoreGetCount( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
@@ -0,0 +1,445 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file read_write_lock_utest.c */
+
+#include "../queue_utest_common.h"
+
+/* Queue includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "semphr.h"
+#include "mock_fake_port.h"
+
+/* ============================  GLOBAL VARIABLES =========================== */
+
+/* Stand in task control blocks, used as task handles. */
+static StaticTask_t xFakeTaskA;
+static StaticTask_t xFakeTaskB;
+
+/* ==========================  CALLBACK FUNCTIONS =========================== */
+
+/* ============================= Unity Fixtures ============================= */
+
+void setUp( void )
+{
+    commonSetUp();
+}
+
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+void suiteSetUp()
+{
+    commonSuiteSetUp();
+}
+
+int suiteTearDown( int numFailures )
+{
+    return commonSuiteTearDown( numFailures );
+}
+
+/* ==========================  Helper functions =========================== */
+
+static SemaphoreHandle_t xCreateLockWrittenBy( TaskHandle_t xWriter )
+{
+    SemaphoreHandle_t xLock = xSemaphoreCreateReadWriteLock();
+
+    TEST_ASSERT_NOT_EQUAL( NULL, xLock );
+
+    pvTaskIncrementMutexHeldCount_ExpectAndReturn( xWriter );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeWrite( xLock, 0 ) );
+
+    return xLock;
+}
+
+/* ==========================  Test Cases =========================== */
+
+/**
+ * @brief Test xSemaphoreCreateReadWriteLock.
+ * @coverage xQueueCreateReadWriteLock prvInitialiseReadWriteLock
+ */
+void test_macro_xSemaphoreCreateReadWriteLock_success( void )
+{
+    SemaphoreHandle_t xLock = xSemaphoreCreateReadWriteLock();
+
+    TEST_ASSERT_NOT_EQUAL( NULL, xLock );
+    TEST_ASSERT_EQUAL( QUEUE_T_SIZE, getLastMallocSize() );
+    TEST_ASSERT_EQUAL( 0, uxSemaphoreGetCount( xLock ) );
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetWriteLockHolder( xLock ) );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test xSemaphoreCreateReadWriteLockStatic with a null buffer
+ * @coverage xQueueCreateReadWriteLockStatic prvInitialiseReadWriteLock
+ */
+void test_macro_xSemaphoreCreateReadWriteLockStatic_nullptr( void )
+{
+    SemaphoreHandle_t xLock = INVALID_PTR;
+
+    /* Expect that xQueueCreate will assert due to the NULL buffer */
+    fakeAssertExpectFail();
+
+    xLock = xSemaphoreCreateReadWriteLockStatic( NULL );
+
+    /* Check that configASSERT was called twice */
+    fakeAssertVerifyNumAssertsAndClear( 2 );
+
+    TEST_ASSERT_EQUAL( NULL, xLock );
+    TEST_ASSERT_EQUAL( 0, getLastMallocSize() );
+}
+
+/**
+ * @brief Test xSemaphoreCreateReadWriteLockStatic with a valid buffer.
+ * @coverage xQueueCreateReadWriteLockStatic
+ */
+void test_macro_xSemaphoreCreateReadWriteLockStatic_success( void )
+{
+    SemaphoreHandle_t xLock = NULL;
+    StaticSemaphore_t xLockBuffer;
+
+    xLock = xSemaphoreCreateReadWriteLockStatic( &xLockBuffer );
+
+    /* Check that no call to malloc occurred */
+    TEST_ASSERT_EQUAL( 0, getLastMallocSize() );
+
+    TEST_ASSERT_EQUAL( 0, uxSemaphoreGetCount( xLock ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRead( xLock ) );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test xSemaphoreTakeRead and xSemaphoreGiveRead with several readers.
+ * @details The lock cannot be taken for writing until every reader gives it back.
+ * @coverage xQueueTakeReadLock xQueueGiveReadLock xQueueTakeWriteLock prvTakeReadWriteLock prvIsReadWriteLockFree
+ */
+void test_macro_xSemaphoreTakeRead_multiple_readers( void )
+{
+    SemaphoreHandle_t xLock = xSemaphoreCreateReadWriteLock();
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+    TEST_ASSERT_EQUAL( 2, uxSemaphoreGetCount( xLock ) );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTakeWrite( xLock, 0 ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRead( xLock ) );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTakeWrite( xLock, 0 ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRead( xLock ) );
+    TEST_ASSERT_EQUAL( 0, uxSemaphoreGetCount( xLock ) );
+
+    /* Nothing left to give */
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreGiveRead( xLock ) );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test xSemaphoreTakeWrite and xSemaphoreGiveWrite.
+ * @details The writer is counted as holding a mutex, and disinherits any
+ * priority when it gives the lock back.
+ * @coverage xQueueTakeWriteLock xQueueGiveWriteLock xQueueGetWriteLockHolder
+ */
+void test_macro_xSemaphoreTakeWrite_xSemaphoreGiveWrite( void )
+{
+    TaskHandle_t xWriter = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xLock = xCreateLockWrittenBy( xWriter );
+
+    TEST_ASSERT_EQUAL( xWriter, xSemaphoreGetWriteLockHolder( xLock ) );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTakeRead( xLock, 0 ) );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTakeWrite( xLock, 0 ) );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreGiveRead( xLock ) );
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xWriter );
+    xTaskPriorityDisinherit_ExpectAndReturn( xWriter, pdFALSE );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveWrite( xLock ) );
+
+    TEST_ASSERT_EQUAL( NULL, xSemaphoreGetWriteLockHolder( xLock ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test xSemaphoreGiveWrite from a task that does not hold the lock.
+ * @coverage xQueueGiveWriteLock
+ */
+void test_macro_xSemaphoreGiveWrite_not_writer( void )
+{
+    SemaphoreHandle_t xLock = xCreateLockWrittenBy( ( TaskHandle_t ) &xFakeTaskA );
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( ( TaskHandle_t ) &xFakeTaskB );
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreGiveWrite( xLock ) );
+
+    TEST_ASSERT_EQUAL( ( TaskHandle_t ) &xFakeTaskA, xSemaphoreGetWriteLockHolder( xLock ) );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test xSemaphoreGiveWrite on a lock that no task holds for writing.
+ * @coverage xQueueGiveWriteLock
+ */
+void test_macro_xSemaphoreGiveWrite_not_taken( void )
+{
+    SemaphoreHandle_t xLock = xSemaphoreCreateReadWriteLock();
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreGiveWrite( xLock ) );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test that the semaphore and queue APIs refuse a read write lock.
+ * @details They would treat the readers as a count and the lock state as
+ * queue pointers.
+ * @coverage xQueueGenericReset xQueueGenericSend xQueueSemaphoreTake xQueueReceive xQueuePeek
+ */
+void test_macro_xSemaphoreTake_xSemaphoreGive_read_write_lock( void )
+{
+    SemaphoreHandle_t xLock = xSemaphoreCreateReadWriteLock();
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+
+    EXPECT_ASSERT_BREAK( xSemaphoreTake( xLock, 0 ) );
+    EXPECT_ASSERT_BREAK( xSemaphoreGive( xLock ) );
+    EXPECT_ASSERT_BREAK( xQueueReset( xLock ) );
+    EXPECT_ASSERT_BREAK( xQueueReceive( xLock, NULL, 0 ) );
+    EXPECT_ASSERT_BREAK( xQueuePeek( xLock, NULL, 0 ) );
+
+    TEST_ASSERT_EQUAL( 1, uxSemaphoreGetCount( xLock ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRead( xLock ) );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test that the semaphore ISR APIs refuse a read write lock.
+ * @coverage xQueueGiveFromISR xQueueGenericSendFromISR xQueueReceiveFromISR
+ */
+void test_macro_xSemaphoreGiveFromISR_read_write_lock( void )
+{
+    SemaphoreHandle_t xLock = xSemaphoreCreateReadWriteLock();
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    EXPECT_ASSERT_BREAK( xSemaphoreGiveFromISR( xLock, &xHigherPriorityTaskWoken ) );
+    EXPECT_ASSERT_BREAK( xQueueSendFromISR( xLock, NULL, &xHigherPriorityTaskWoken ) );
+    EXPECT_ASSERT_BREAK( xSemaphoreTakeFromISR( xLock, &xHigherPriorityTaskWoken ) );
+
+    TEST_ASSERT_EQUAL( 0, uxSemaphoreGetCount( xLock ) );
+    TEST_ASSERT_EQUAL( pdFALSE, xHigherPriorityTaskWoken );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test that the read write lock APIs refuse a counting semaphore.
+ * @details A counting semaphore of the same length is not mistaken for a lock.
+ * @coverage prvTakeReadWriteLock xQueueGiveReadLock xQueueGiveWriteLock xQueueGetWriteLockHolder
+ */
+void test_macro_xSemaphoreTakeRead_counting_semaphore( void )
+{
+    SemaphoreHandle_t xSemaphore = xSemaphoreCreateCounting( ~( ( UBaseType_t ) 0U ), 1 );
+
+    EXPECT_ASSERT_BREAK( xSemaphoreTakeRead( xSemaphore, 0 ) );
+    EXPECT_ASSERT_BREAK( xSemaphoreTakeWrite( xSemaphore, 0 ) );
+    EXPECT_ASSERT_BREAK( xSemaphoreGiveRead( xSemaphore ) );
+    EXPECT_ASSERT_BREAK( xSemaphoreGiveWrite( xSemaphore ) );
+    EXPECT_ASSERT_BREAK( xSemaphoreGetWriteLockHolder( xSemaphore ) );
+
+    TEST_ASSERT_EQUAL( 1, uxSemaphoreGetCount( xSemaphore ) );
+
+    vSemaphoreDelete( xSemaphore );
+}
+
+/**
+ * @brief Test a blocking xSemaphoreTakeRead on a lock held for writing.
+ * @details The writer inherits the priority of the waiting task, and
+ * disinherits it again when the waiting task times out.
+ * @coverage prvTakeReadWriteLock prvAbandonReadWriteLockWait prvGetDisinheritPriorityAfterTimeout
+ */
+void test_macro_xSemaphoreTakeRead_blocking_writer_inherit_timeout( void )
+{
+    TaskHandle_t xWriter = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xLock = xCreateLockWrittenBy( xWriter );
+
+    for( int i = 0; i < TICKS_TO_WAIT; i++ )
+    {
+        /* Return pdTRUE to signify that priority inheritance occurred */
+        xTaskPriorityInherit_ExpectAndReturn( xWriter, pdTRUE );
+    }
+
+    vTaskPriorityDisinheritAfterTimeout_Expect( xWriter, tskIDLE_PRIORITY );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTakeRead( xLock, TICKS_TO_WAIT ) );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getCount_vPortYieldWithinAPI() );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test a blocking xSemaphoreTakeRead that times out while a higher
+ * priority writer is still waiting.
+ * @details The writer holding the lock only disinherits down to the priority
+ * of the waiting writer, which is in xTasksWaitingToSend.
+ * @coverage prvAbandonReadWriteLockWait prvGetDisinheritPriorityAfterTimeout
+ */
+void test_macro_xSemaphoreTakeRead_timeout_writer_still_waiting( void )
+{
+    TaskHandle_t xWriter = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xLock = xCreateLockWrittenBy( xWriter );
+
+    td_task_addFakeTaskWaitingToSendToQueue( xLock );
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+
+    for( int i = 0; i < TICKS_TO_WAIT; i++ )
+    {
+        xTaskPriorityInherit_ExpectAndReturn( xWriter, pdTRUE );
+    }
+
+    vTaskPriorityDisinheritAfterTimeout_Expect( xWriter, DEFAULT_PRIORITY + 1 );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTakeRead( xLock, TICKS_TO_WAIT ) );
+
+    /* The pending writer also makes the final xTaskResumeAll() yield */
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT + 1, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT + 1, td_task_getCount_YieldFromTaskResumeAll() );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test a blocking xSemaphoreTakeWrite on a lock held for reading.
+ * @details The readers are not recorded, so nothing is inherited.  Readers
+ * can take the lock again once the writer has stopped waiting.
+ * @coverage prvTakeReadWriteLock prvAbandonReadWriteLockWait prvUnblockReadWriteLockWaiters
+ */
+void test_macro_xSemaphoreTakeWrite_blocking_readers_timeout( void )
+{
+    SemaphoreHandle_t xLock = xSemaphoreCreateReadWriteLock();
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xSemaphoreTakeWrite( xLock, TICKS_TO_WAIT ) );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getCount_vPortYieldWithinAPI() );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+    TEST_ASSERT_EQUAL( 2, uxSemaphoreGetCount( xLock ) );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test xSemaphoreGiveRead by the last reader with a writer waiting.
+ * @details The waiting writer is unblocked, and has a higher priority.
+ * @coverage xQueueGiveReadLock prvUnblockReadWriteLockWaiters
+ */
+void test_macro_xSemaphoreGiveRead_unblocks_writer( void )
+{
+    SemaphoreHandle_t xLock = xSemaphoreCreateReadWriteLock();
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+
+    td_task_addFakeTaskWaitingToSendToQueue( xLock );
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+
+    /* Another reader still holds the lock */
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRead( xLock ) );
+    TEST_ASSERT_EQUAL( 0, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveRead( xLock ) );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test xSemaphoreGiveWrite with a reader waiting.
+ * @details The waiting reader is unblocked, and has a higher priority.
+ * @coverage xQueueGiveWriteLock prvUnblockReadWriteLockWaiters
+ */
+void test_macro_xSemaphoreGiveWrite_unblocks_reader( void )
+{
+    TaskHandle_t xWriter = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xLock = xCreateLockWrittenBy( xWriter );
+
+    td_task_addFakeTaskWaitingToReceiveFromQueue( xLock );
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xWriter );
+    xTaskPriorityDisinherit_ExpectAndReturn( xWriter, pdFALSE );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveWrite( xLock ) );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    vSemaphoreDelete( xLock );
+}
+
+/**
+ * @brief Test xSemaphoreGiveWrite with a writer waiting.
+ * @details The writer goes first, so its priority decides if a yield is needed.
+ * @coverage xQueueGiveWriteLock prvUnblockReadWriteLockWaiters
+ */
+void test_macro_xSemaphoreGiveWrite_unblocks_writer( void )
+{
+    TaskHandle_t xWriter = ( TaskHandle_t ) &xFakeTaskA;
+    SemaphoreHandle_t xLock = xCreateLockWrittenBy( xWriter );
+
+    td_task_addFakeTaskWaitingToSendToQueue( xLock );
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY - 1 );
+
+    /* The writer disinherits a priority, so yields anyway */
+    xTaskGetCurrentTaskHandle_ExpectAndReturn( xWriter );
+    xTaskPriorityDisinherit_ExpectAndReturn( xWriter, pdTRUE );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreGiveWrite( xLock ) );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    /* The unblocked writer has not taken the lock yet */
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTakeRead( xLock, 0 ) );
+
+    vSemaphoreDelete( xLock );
+}
@@ -0,0 +1,391 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file queue_zero_copy_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../queue_utest_common.h"
+
+/* Queue includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "queue.h"
+#include "mock_fake_port.h"
+
+/* ===============================  CONSTANTS =============================== */
+
+#define ZERO_COPY_QUEUE_LENGTH    4
+
+/* ============================  GLOBAL VARIABLES =========================== */
+
+/* ==========================  CALLBACK FUNCTIONS =========================== */
+
+/* ============================= Unity Fixtures ============================= */
+
+void setUp( void )
+{
+    commonSetUp();
+}
+
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+void suiteSetUp()
+{
+    commonSuiteSetUp();
+}
+
+int suiteTearDown( int numFailures )
+{
+    return commonSuiteTearDown( numFailures );
+}
+
+
+/* ==========================  Helper functions =========================== */
+
+/* =============================  Test Cases ============================== */
+
+/**
+ * @brief Test xQueueReserve with an invalid QueueHandle
+ * @coverage xQueueReserve
+ */
+void test_xQueueReserve_invalid_handle( void )
+{
+    void * pvSlot = NULL;
+
+    EXPECT_ASSERT_BREAK( xQueueReserve( NULL, &pvSlot, 0 ) );
+}
+
+/**
+ * @brief Test xQueueReserve and xQueueCommit on an empty queue
+ * @details The item is only received once the slot is committed, and is
+ * received from the slot it was written to.
+ * @coverage xQueueReserve xQueueCommit
+ */
+void test_xQueueReserve_commit_success( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+    uint32_t checkVal = INVALID_UINT32;
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueReserve( xQueue, &pvSlot, 0 ) );
+    TEST_ASSERT_NOT_NULL( pvSlot );
+
+    TEST_ASSERT_EQUAL( ZERO_COPY_QUEUE_LENGTH - 1, uxQueueSpacesAvailable( xQueue ) );
+    TEST_ASSERT_EQUAL( ZERO_COPY_QUEUE_LENGTH, uxQueueGetQueueLength( xQueue ) );
+    TEST_ASSERT_EQUAL( pdFALSE, xQueueReceive( xQueue, &checkVal, 0 ) );
+
+    *( uint32_t * ) pvSlot = getNextMonotonicTestValue();
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueCommit( xQueue, pvSlot ) );
+    TEST_ASSERT_EQUAL( 1, uxQueueMessagesWaiting( xQueue ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xQueueReceive( xQueue, &checkVal, 0 ) );
+    TEST_ASSERT_EQUAL( getLastMonotonicTestValue(), checkVal );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test sending behind a reserved slot
+ * @details Items sent to the back while a slot is reserved are not received
+ * before the reserved item.
+ * @coverage xQueueReserve xQueueCommit prvHoldBackSentItems
+ */
+void test_xQueueReserve_send_behind( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+    void * pvSecondSlot = NULL;
+    uint32_t testVal = 1;
+    uint32_t checkVals[ ZERO_COPY_QUEUE_LENGTH ];
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueReserve( xQueue, &pvSlot, 0 ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xQueueSend( xQueue, &testVal, 0 ) );
+    TEST_ASSERT_EQUAL( 0, uxQueueMessagesWaiting( xQueue ) );
+    TEST_ASSERT_EQUAL( ZERO_COPY_QUEUE_LENGTH - 2, uxQueueSpacesAvailable( xQueue ) );
+
+    /* Only one slot can be reserved at a time. */
+    TEST_ASSERT_EQUAL( errQUEUE_FULL, xQueueReserve( xQueue, &pvSecondSlot, 0 ) );
+
+    *( uint32_t * ) pvSlot = 0;
+    TEST_ASSERT_EQUAL( pdPASS, xQueueCommit( xQueue, pvSlot ) );
+
+    TEST_ASSERT_EQUAL( 2, xQueueReceiveMultiple( xQueue, checkVals, ZERO_COPY_QUEUE_LENGTH, 0 ) );
+    TEST_ASSERT_EQUAL( 0, checkVals[ 0 ] );
+    TEST_ASSERT_EQUAL( 1, checkVals[ 1 ] );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueCommit with a higher priority task waiting to receive
+ * @coverage xQueueCommit
+ */
+void test_xQueueCommit_task_waiting_higher_priority( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+    td_task_addFakeTaskWaitingToReceiveFromQueue( xQueue );
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueReserve( xQueue, &pvSlot, 0 ) );
+    TEST_ASSERT_EQUAL( pdPASS, xQueueCommit( xQueue, pvSlot ) );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueCommit with a slot that was not reserved
+ * @coverage xQueueCommit
+ */
+void test_xQueueCommit_not_reserved( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    uint32_t testVal = 0;
+
+    EXPECT_ASSERT_BREAK( xQueueCommit( xQueue, &testVal ) );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueOverwrite while a slot is reserved
+ * @details The only slot of the queue is the reserved one, so the overwrite
+ * asserts instead of writing to it.
+ * @coverage xQueueGenericSend prvCopyDataToQueue
+ */
+void test_xQueueOverwrite_while_reserved( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+    uint32_t testVal = 1;
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueReserve( xQueue, &pvSlot, 0 ) );
+    *( uint32_t * ) pvSlot = 0;
+
+    EXPECT_ASSERT_BREAK( xQueueOverwrite( xQueue, &testVal ) );
+
+    /* The reserved item is untouched. */
+    TEST_ASSERT_EQUAL( 0, *( uint32_t * ) pvSlot );
+    TEST_ASSERT_EQUAL( 0, uxQueueMessagesWaiting( xQueue ) );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueOverwriteFromISR while a slot is reserved
+ * @coverage xQueueGenericSendFromISR prvCopyDataToQueue
+ */
+void test_xQueueOverwriteFromISR_while_reserved( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+    uint32_t testVal = 1;
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueReserve( xQueue, &pvSlot, 0 ) );
+    *( uint32_t * ) pvSlot = 0;
+
+    vFakePortAssertIfInterruptPriorityInvalid_Ignore();
+
+    EXPECT_ASSERT_BREAK( xQueueOverwriteFromISR( xQueue, &testVal, NULL ) );
+
+    TEST_ASSERT_EQUAL( 0, *( uint32_t * ) pvSlot );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test a blocking call to xQueueReserve while a slot is reserved
+ * @details The call fails without blocking, so the task waiting to send is
+ * the one unblocked when space is freed.
+ * @coverage xQueueReserve
+ */
+void test_xQueueReserve_while_reserved_task_waiting_to_send( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( 2, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+    void * pvSecondSlot = NULL;
+    uint32_t checkVal = INVALID_UINT32;
+
+    queue_common_add_sequential_to_queue( xQueue, 1 );
+    TEST_ASSERT_EQUAL( pdPASS, xQueueReserve( xQueue, &pvSlot, 0 ) );
+    TEST_ASSERT_EQUAL( 0, uxQueueSpacesAvailable( xQueue ) );
+
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+    td_task_addFakeTaskWaitingToSendToQueue( xQueue );
+
+    TEST_ASSERT_EQUAL( errQUEUE_FULL, xQueueReserve( xQueue, &pvSecondSlot, TICKS_TO_WAIT ) );
+    TEST_ASSERT_EQUAL( 0, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xQueueReceive( xQueue, &checkVal, 0 ) );
+    TEST_ASSERT_EQUAL( 0, checkVal );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    *( uint32_t * ) pvSlot = 1;
+    TEST_ASSERT_EQUAL( pdPASS, xQueueCommit( xQueue, pvSlot ) );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test a blocking call to xQueueReserve on a full queue
+ * @coverage xQueueReserve prvIsQueueFull
+ */
+void test_xQueueReserve_blocking_timeout( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+
+    queue_common_add_sequential_to_queue( xQueue, ZERO_COPY_QUEUE_LENGTH );
+
+    TEST_ASSERT_EQUAL( errQUEUE_FULL, xQueueReserve( xQueue, &pvSlot, TICKS_TO_WAIT ) );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getCount_vPortYieldWithinAPI() );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueAcquire and xQueueRelease
+ * @details The acquired slot and any slot read behind it are only freed when
+ * the slot is released.
+ * @coverage xQueueAcquire xQueueRelease prvHoldBackFreedSlots
+ */
+void test_xQueueAcquire_release_success( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+    void * pvSecondSlot = NULL;
+    uint32_t checkVal = INVALID_UINT32;
+
+    queue_common_add_sequential_to_queue( xQueue, ZERO_COPY_QUEUE_LENGTH );
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueAcquire( xQueue, &pvSlot, 0 ) );
+    TEST_ASSERT_EQUAL( 0, *( uint32_t * ) pvSlot );
+    TEST_ASSERT_EQUAL( ZERO_COPY_QUEUE_LENGTH - 1, uxQueueMessagesWaiting( xQueue ) );
+    TEST_ASSERT_EQUAL( 0, uxQueueSpacesAvailable( xQueue ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xQueueReceive( xQueue, &checkVal, 0 ) );
+    TEST_ASSERT_EQUAL( 1, checkVal );
+    TEST_ASSERT_EQUAL( 0, uxQueueSpacesAvailable( xQueue ) );
+
+    /* Only one slot can be acquired at a time. */
+    TEST_ASSERT_EQUAL( errQUEUE_EMPTY, xQueueAcquire( xQueue, &pvSecondSlot, 0 ) );
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueRelease( xQueue, pvSlot ) );
+    TEST_ASSERT_EQUAL( 2, uxQueueSpacesAvailable( xQueue ) );
+    TEST_ASSERT_EQUAL( ZERO_COPY_QUEUE_LENGTH, uxQueueGetQueueLength( xQueue ) );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test xQueueRelease with a higher priority task waiting to send
+ * @coverage xQueueRelease
+ */
+void test_xQueueRelease_task_waiting_higher_priority( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+
+    queue_common_add_sequential_to_queue( xQueue, 1 );
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueAcquire( xQueue, &pvSlot, 0 ) );
+
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+    td_task_addFakeTaskWaitingToSendToQueue( xQueue );
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueRelease( xQueue, pvSlot ) );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test a blocking call to xQueueAcquire while a slot is acquired
+ * @details The call fails without blocking, so the task waiting to receive is
+ * the one unblocked by the next send.
+ * @coverage xQueueAcquire
+ */
+void test_xQueueAcquire_while_acquired_task_waiting_to_receive( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+    void * pvSecondSlot = NULL;
+    uint32_t testVal = 1;
+
+    queue_common_add_sequential_to_queue( xQueue, 1 );
+    TEST_ASSERT_EQUAL( pdPASS, xQueueAcquire( xQueue, &pvSlot, 0 ) );
+    TEST_ASSERT_EQUAL( 0, uxQueueMessagesWaiting( xQueue ) );
+
+    td_task_setFakeTaskPriority( DEFAULT_PRIORITY + 1 );
+    td_task_addFakeTaskWaitingToReceiveFromQueue( xQueue );
+
+    TEST_ASSERT_EQUAL( errQUEUE_EMPTY, xQueueAcquire( xQueue, &pvSecondSlot, TICKS_TO_WAIT ) );
+    TEST_ASSERT_EQUAL( 0, td_task_getYieldCount() );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xQueueSend( xQueue, &testVal, 0 ) );
+
+    TEST_ASSERT_EQUAL( 1, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( 1, td_task_getCount_vPortYieldWithinAPI() );
+
+    TEST_ASSERT_EQUAL( pdPASS, xQueueRelease( xQueue, pvSlot ) );
+
+    vQueueDelete( xQueue );
+}
+
+/**
+ * @brief Test a blocking call to xQueueAcquire on an empty queue
+ * @coverage xQueueAcquire prvIsQueueEmpty
+ */
+void test_xQueueAcquire_blocking_timeout( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ZERO_COPY_QUEUE_LENGTH, sizeof( uint32_t ) );
+    void * pvSlot = NULL;
+
+    TEST_ASSERT_EQUAL( errQUEUE_EMPTY, xQueueAcquire( xQueue, &pvSlot, TICKS_TO_WAIT ) );
+
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getYieldCount() );
+    TEST_ASSERT_EQUAL( TICKS_TO_WAIT, td_task_getCount_vPortYieldWithinAPI() );
+
+    vQueueDelete( xQueue );
+}
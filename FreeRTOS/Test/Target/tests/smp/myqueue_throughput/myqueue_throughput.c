@@ -0,0 +1,482 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file myqueue_throughput.c
+ * @brief MyQueue and MySemaphore shall stay correct when used from several
+ *        cores at once, and report how many items per millisecond they move.
+ *
+ * Procedure:
+ *   - Pin one producer and one consumer task to every core, with each
+ *     consumer on a different core from the producer it mostly pairs with,
+ *     and pass a fixed number of numbered items through one MyQueue.
+ *   - Repeat with a single producer and consumer on an SPSC MyQueue.
+ *   - Have one task per core increment a shared counter while holding a
+ *     binary MySemaphore.
+ *   - Repeat with a MySemaphore mutex, checking the holder on every take.
+ * Expected:
+ *   - Every item is received exactly once.
+ *   - The shared counter ends up at the total number of increments.
+ *   - The mutex is always held by the task that took it.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h" /* Must come first. */
+#include "task.h"     /* RTOS task related API prototypes. */
+#include "my_queue.h" /* MyQueue and MySemaphore API prototypes. */
+
+/* Unity includes. */
+#include "unity.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+/*-----------------------------------------------------------*/
+
+#ifndef TEST_CONFIG_H
+    #error test_config.h must be included at the end of FreeRTOSConfig.h.
+#endif
+
+#if ( configNUMBER_OF_CORES < 2 )
+    #error This test is for FreeRTOS SMP and therefore, requires at least 2 cores.
+#endif /* if configNUMBER_OF_CORES != 2 */
+
+#if ( configUSE_CORE_AFFINITY != 1 )
+    #error configUSE_CORE_AFFINITY must be set to 1 for this test.
+#endif /* if ( configUSE_CORE_AFFINITY != 1 ) */
+
+#if ( configMAX_PRIORITIES <= 2 )
+    #error configMAX_PRIORITIES must be larger than 2 to avoid scheduling idle tasks unexpectedly.
+#endif /* if ( configMAX_PRIORITIES <= 2 ) */
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of items each producer sends.
+ */
+#define ITEMS_PER_PRODUCER      ( 2000U )
+
+/**
+ * @brief Number of slots in the queue under test.
+ */
+#define QUEUE_LENGTH            ( 16U )
+
+/**
+ * @brief Number of times each task increments the shared counter.
+ */
+#define INCREMENTS_PER_TASK     ( 5000U )
+
+/**
+ * @brief Longest any single operation may wait before the test fails.
+ */
+#define MAX_WAIT_TICKS          pdMS_TO_TICKS( 1000 )
+
+/**
+ * @brief Longest the whole of one test case may take.
+ */
+#define TEST_TIMEOUT_TICKS      pdMS_TO_TICKS( 10000 )
+
+/**
+ * @brief Items carry the producer number in the top byte and a sequence
+ *        number in the rest.
+ */
+#define ITEM( ulProducer, ulSequence )    ( ( ( ulProducer ) << 24 ) | ( ulSequence ) )
+#define ITEM_PRODUCER( ulItem )           ( ( ulItem ) >> 24 )
+#define ITEM_SEQUENCE( ulItem )           ( ( ulItem ) & 0x00FFFFFFUL )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sends ITEMS_PER_PRODUCER numbered items to xQueueUnderTest.
+ */
+static void prvProducerTask( void * pvParameters );
+
+/**
+ * @brief Receives its share of the items from xQueueUnderTest and marks each
+ *        one as seen.
+ */
+static void prvConsumerTask( void * pvParameters );
+
+/**
+ * @brief Increments ulSharedCounter while holding xCounterLock. A non-zero
+ *        parameter means xCounterLock is a mutex whose holder is checked.
+ */
+static void prvCounterTask( void * pvParameters );
+
+/**
+ * @brief Create a worker task pinned to xCore.
+ */
+static void prvCreatePinnedTask( TaskFunction_t pxTaskCode,
+                                 const char * pcName,
+                                 UBaseType_t uxParameter,
+                                 BaseType_t xCore );
+
+/**
+ * @brief Start uxProducers producers and as many consumers on xQueueUnderTest,
+ *        wait for them all and check every item arrived exactly once.
+ */
+static void prvRunQueueTest( UBaseType_t uxProducers,
+                             const char * pcName );
+
+/**
+ * @brief Test case "MyQueue Multiple Producers And Consumers".
+ */
+static void Test_MyQueueMultipleProducersAndConsumers( void );
+
+/**
+ * @brief Test case "MyQueue SPSC Across Cores".
+ */
+static void Test_MyQueueSPSCAcrossCores( void );
+
+/**
+ * @brief Start one counter task per core and check the shared counter.
+ */
+static void prvRunCounterTest( UBaseType_t uxIsMutex );
+
+/**
+ * @brief Test case "MySemaphore Guards Shared Counter".
+ */
+static void Test_MySemaphoreGuardsSharedCounter( void );
+
+/**
+ * @brief Test case "MySemaphore Mutex Guards Shared Counter".
+ */
+static void Test_MySemaphoreMutexGuardsSharedCounter( void );
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Queue the current test case passes items through.
+ */
+static MyQueueHandle_t xQueueUnderTest = NULL;
+
+/**
+ * @brief Given once by every worker task when it is done.
+ */
+static MySemaphoreHandle_t xDoneSemaphore = NULL;
+
+/**
+ * @brief Binary semaphore or mutex used as a lock around ulSharedCounter.
+ */
+static MySemaphoreHandle_t xCounterLock = NULL;
+
+/**
+ * @brief Incremented by every counter task without any atomic instruction.
+ */
+static volatile uint32_t ulSharedCounter = 0;
+
+/**
+ * @brief How many items each consumer should receive.
+ */
+static uint32_t ulItemsPerConsumer = 0;
+
+/**
+ * @brief Set when a consumer receives an item twice or an item that was
+ *        never sent, or when a worker gives up waiting.
+ */
+static volatile BaseType_t xWorkerFailed = pdFALSE;
+
+/**
+ * @brief One flag per item, set by the consumer that received it.
+ */
+static uint8_t ucItemSeen[ configNUMBER_OF_CORES ][ ITEMS_PER_PRODUCER ];
+
+/**
+ * @brief Handles of the worker tasks created in the current test case.
+ */
+static TaskHandle_t xWorkerHandles[ 2 * configNUMBER_OF_CORES ];
+static UBaseType_t uxWorkerCount = 0;
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    uint32_t ulProducer = ( uint32_t ) ( UBaseType_t ) pvParameters;
+    uint32_t ulSequence;
+
+    for( ulSequence = 0; ulSequence < ITEMS_PER_PRODUCER; ulSequence++ )
+    {
+        uint32_t ulItem = ITEM( ulProducer, ulSequence );
+
+        if( xMyQueueSendToBack( xQueueUnderTest, &ulItem, MAX_WAIT_TICKS ) != pdTRUE )
+        {
+            xWorkerFailed = pdTRUE;
+            break;
+        }
+    }
+
+    ( void ) xMySemaphoreGive( xDoneSemaphore, 0 );
+
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    uint32_t ulReceived;
+
+    ( void ) pvParameters;
+
+    for( ulReceived = 0; ulReceived < ulItemsPerConsumer; ulReceived++ )
+    {
+        uint32_t ulItem;
+
+        if( xMyQueueReceive( xQueueUnderTest, &ulItem, MAX_WAIT_TICKS ) != pdTRUE )
+        {
+            xWorkerFailed = pdTRUE;
+            break;
+        }
+
+        /* Each item is received by one consumer only, so the flags need no
+         * lock. */
+        if( ( ITEM_PRODUCER( ulItem ) >= configNUMBER_OF_CORES ) ||
+            ( ITEM_SEQUENCE( ulItem ) >= ITEMS_PER_PRODUCER ) ||
+            ( ucItemSeen[ ITEM_PRODUCER( ulItem ) ][ ITEM_SEQUENCE( ulItem ) ] != 0U ) )
+        {
+            xWorkerFailed = pdTRUE;
+            break;
+        }
+
+        ucItemSeen[ ITEM_PRODUCER( ulItem ) ][ ITEM_SEQUENCE( ulItem ) ] = 1U;
+    }
+
+    ( void ) xMySemaphoreGive( xDoneSemaphore, 0 );
+
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCounterTask( void * pvParameters )
+{
+    UBaseType_t uxIsMutex = ( UBaseType_t ) pvParameters;
+    uint32_t i;
+
+    for( i = 0; i < INCREMENTS_PER_TASK; i++ )
+    {
+        if( xMySemaphoreTake( xCounterLock, MAX_WAIT_TICKS ) != pdTRUE )
+        {
+            xWorkerFailed = pdTRUE;
+            break;
+        }
+
+        if( ( uxIsMutex != 0U ) &&
+            ( xMySemaphoreGetMutexHolder( xCounterLock ) != xTaskGetCurrentTaskHandle() ) )
+        {
+            xWorkerFailed = pdTRUE;
+            ( void ) xMySemaphoreGive( xCounterLock, 0 );
+            break;
+        }
+
+        /* A read, modify and write that another core would tear if the lock
+         * did not keep it out. */
+        uint32_t ulValue = ulSharedCounter;
+        ulSharedCounter = ulValue + 1U;
+
+        ( void ) xMySemaphoreGive( xCounterLock, 0 );
+    }
+
+    ( void ) xMySemaphoreGive( xDoneSemaphore, 0 );
+
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCreatePinnedTask( TaskFunction_t pxTaskCode,
+                                 const char * pcName,
+                                 UBaseType_t uxParameter,
+                                 BaseType_t xCore )
+{
+    BaseType_t xTaskCreationResult;
+
+    xTaskCreationResult = xTaskCreateAffinitySet( pxTaskCode,
+                                                  pcName,
+                                                  configMINIMAL_STACK_SIZE * 2,
+                                                  ( void * ) uxParameter,
+                                                  configMAX_PRIORITIES - 2,
+                                                  ( UBaseType_t ) 1 << xCore,
+                                                  &( xWorkerHandles[ uxWorkerCount ] ) );
+
+    TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xTaskCreationResult, "Task creation failed." );
+
+    uxWorkerCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunQueueTest( UBaseType_t uxProducers,
+                             const char * pcName )
+{
+    UBaseType_t i;
+    uint32_t ulProducer;
+    uint32_t ulSequence;
+    TickType_t xStartTime;
+    TickType_t xElapsedTicks;
+    char cMessage[ 80 ];
+
+    ulItemsPerConsumer = ITEMS_PER_PRODUCER;
+    xStartTime = xTaskGetTickCount();
+
+    /* Consumer i runs on the core after producer i's, so items cross cores. */
+    for( i = 0; i < uxProducers; i++ )
+    {
+        prvCreatePinnedTask( prvConsumerTask, "Consumer", i, ( BaseType_t ) ( ( i + 1 ) % configNUMBER_OF_CORES ) );
+        prvCreatePinnedTask( prvProducerTask, "Producer", i, ( BaseType_t ) ( i % configNUMBER_OF_CORES ) );
+    }
+
+    TEST_ASSERT_EQUAL_MESSAGE( pdTRUE,
+                               xMySemaphoreTakeN( xDoneSemaphore, 2 * uxProducers, TEST_TIMEOUT_TICKS ),
+                               "Workers did not finish in time." );
+
+    xElapsedTicks = xTaskGetTickCount() - xStartTime;
+
+    TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xWorkerFailed, "An item was lost, duplicated or corrupted." );
+
+    for( ulProducer = 0; ulProducer < uxProducers; ulProducer++ )
+    {
+        for( ulSequence = 0; ulSequence < ITEMS_PER_PRODUCER; ulSequence++ )
+        {
+            TEST_ASSERT_EQUAL_MESSAGE( 1U, ucItemSeen[ ulProducer ][ ulSequence ], "An item was never received." );
+        }
+    }
+
+    /* Never divide by zero ticks on a fast run. */
+    if( xElapsedTicks == 0 )
+    {
+        xElapsedTicks = 1;
+    }
+
+    ( void ) snprintf( cMessage, sizeof( cMessage ), "%s: %lu items in %lu ms, %lu items/ms",
+                       pcName,
+                       ( unsigned long ) ( uxProducers * ITEMS_PER_PRODUCER ),
+                       ( unsigned long ) ( xElapsedTicks * portTICK_PERIOD_MS ),
+                       ( unsigned long ) ( ( uxProducers * ITEMS_PER_PRODUCER ) / ( xElapsedTicks * portTICK_PERIOD_MS ) ) );
+    TEST_MESSAGE( cMessage );
+}
+/*-----------------------------------------------------------*/
+
+static void Test_MyQueueMultipleProducersAndConsumers( void )
+{
+    xQueueUnderTest = pxMyQueueCreate( QUEUE_LENGTH, sizeof( uint32_t ) );
+    TEST_ASSERT_NOT_NULL( xQueueUnderTest );
+
+    prvRunQueueTest( configNUMBER_OF_CORES, "MyQueue MPMC" );
+}
+/*-----------------------------------------------------------*/
+
+static void Test_MyQueueSPSCAcrossCores( void )
+{
+    xQueueUnderTest = pxMyQueueCreateSPSC( QUEUE_LENGTH, sizeof( uint32_t ) );
+    TEST_ASSERT_NOT_NULL( xQueueUnderTest );
+
+    prvRunQueueTest( 1, "MyQueue SPSC" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunCounterTest( UBaseType_t uxIsMutex )
+{
+    BaseType_t xCore;
+
+    for( xCore = 0; xCore < configNUMBER_OF_CORES; xCore++ )
+    {
+        prvCreatePinnedTask( prvCounterTask, "Counter", uxIsMutex, xCore );
+    }
+
+    TEST_ASSERT_EQUAL_MESSAGE( pdTRUE,
+                               xMySemaphoreTakeN( xDoneSemaphore, configNUMBER_OF_CORES, TEST_TIMEOUT_TICKS ),
+                               "Workers did not finish in time." );
+    TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xWorkerFailed, "A worker timed out taking the lock." );
+    TEST_ASSERT_EQUAL_UINT32( configNUMBER_OF_CORES * INCREMENTS_PER_TASK, ulSharedCounter );
+}
+/*-----------------------------------------------------------*/
+
+static void Test_MySemaphoreGuardsSharedCounter( void )
+{
+    xCounterLock = pxMySemaphoreCreate( 1, 1 );
+    TEST_ASSERT_NOT_NULL( xCounterLock );
+
+    prvRunCounterTest( 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void Test_MySemaphoreMutexGuardsSharedCounter( void )
+{
+    /* Mutexes use the kernel lock rather than their own, so this covers the
+     * other branch of the SMP critical section. */
+    xCounterLock = pxMySemaphoreCreateMutex();
+    TEST_ASSERT_NOT_NULL( xCounterLock );
+
+    prvRunCounterTest( 1 );
+    TEST_ASSERT_NULL( xMySemaphoreGetMutexHolder( xCounterLock ) );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs before every test, put init calls here. */
+void setUp( void )
+{
+    xDoneSemaphore = pxMySemaphoreCreate( 2 * configNUMBER_OF_CORES, 0 );
+    TEST_ASSERT_NOT_NULL( xDoneSemaphore );
+
+    ( void ) memset( ucItemSeen, 0x00, sizeof( ucItemSeen ) );
+    ulSharedCounter = 0;
+    xWorkerFailed = pdFALSE;
+    uxWorkerCount = 0;
+}
+/*-----------------------------------------------------------*/
+
+/* Runs after every test, put clean-up calls here. */
+void tearDown( void )
+{
+    UBaseType_t i;
+
+    /* Delete all the tasks. */
+    for( i = 0; i < uxWorkerCount; i++ )
+    {
+        vTaskDelete( xWorkerHandles[ i ] );
+    }
+
+    if( xQueueUnderTest != NULL )
+    {
+        vMyQueueDelete( xQueueUnderTest );
+        xQueueUnderTest = NULL;
+    }
+
+    if( xCounterLock != NULL )
+    {
+        vMySemaphoreDelete( xCounterLock );
+        xCounterLock = NULL;
+    }
+
+    vMySemaphoreDelete( xDoneSemaphore );
+}
+/*-----------------------------------------------------------*/
+
+void vRunMyQueueThroughputTest( void )
+{
+    UNITY_BEGIN();
+
+    RUN_TEST( Test_MyQueueMultipleProducersAndConsumers );
+    RUN_TEST( Test_MyQueueSPSCAcrossCores );
+    RUN_TEST( Test_MySemaphoreGuardsSharedCounter );
+    RUN_TEST( Test_MySemaphoreMutexGuardsSharedCounter );
+
+    UNITY_END();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,94 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TEST_CONFIG_H
+#define TEST_CONFIG_H
+
+/* This file must be included at the end of the FreeRTOSConfig.h. It contains
+ * any FreeRTOS specific configurations that the test requires. */
+
+#ifdef configRUN_MULTIPLE_PRIORITIES
+    #undef configRUN_MULTIPLE_PRIORITIES
+#endif /* ifdef configRUN_MULTIPLE_PRIORITIES */
+
+#ifdef configUSE_CORE_AFFINITY
+    #undef configUSE_CORE_AFFINITY
+#endif /* ifdef configUSE_CORE_AFFINITY */
+
+#ifdef configUSE_MINIMAL_IDLE_HOOK
+    #undef configUSE_MINIMAL_IDLE_HOOK
+#endif /* ifdef configUSE_MINIMAL_IDLE_HOOK */
+
+#ifdef configUSE_TASK_PREEMPTION_DISABLE
+    #undef configUSE_TASK_PREEMPTION_DISABLE
+#endif /* ifdef configUSE_TASK_PREEMPTION_DISABLE */
+
+#ifdef configUSE_TIME_SLICING
+    #undef configUSE_TIME_SLICING
+#endif /* ifdef configUSE_TIME_SLICING */
+
+#ifdef configUSE_PREEMPTION
+    #undef configUSE_PREEMPTION
+#endif /* ifdef configUSE_PREEMPTION */
+
+#ifdef configTASK_NOTIFICATION_ARRAY_ENTRIES
+    #undef configTASK_NOTIFICATION_ARRAY_ENTRIES
+#endif /* ifdef configTASK_NOTIFICATION_ARRAY_ENTRIES */
+
+#define configRUN_MULTIPLE_PRIORITIES        1
+#define configUSE_CORE_AFFINITY              1
+#define configUSE_MINIMAL_IDLE_HOOK          0
+#define configUSE_TASK_PREEMPTION_DISABLE    0
+#define configUSE_TIME_SLICING               0
+#define configUSE_PREEMPTION                 1
+
+/* Gives MySemaphore and MyQueue a notification index of their own. */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES    2
+
+/* The Cortex-M0+ cores of the RP2040 have no atomic read-modify-write, so
+ * MySemaphore's per-object locks are test-and-set words guarded by one of
+ * the SIO hardware spinlocks. The port's portmacro.h already includes
+ * hardware/sync.h. */
+#define configMYSEMAPHORE_SPIN_LOCK( pulLock )                                               \
+    do {                                                                                     \
+        spin_lock_t * pxHardwareLock = spin_lock_instance( PICO_SPINLOCK_ID_STRIPED_FIRST ); \
+        uint32_t ulWasLocked;                                                                \
+                                                                                             \
+        do {                                                                                 \
+            spin_lock_unsafe_blocking( pxHardwareLock );                                     \
+            ulWasLocked = *( pulLock );                                                      \
+            *( pulLock ) = 1U;                                                               \
+            spin_unlock_unsafe( pxHardwareLock );                                            \
+        } while( ulWasLocked != 0U );                                                        \
+    } while( 0 )
+
+#define configMYSEMAPHORE_SPIN_UNLOCK( pulLock ) \
+    do {                                         \
+        __mem_fence_release();                   \
+        *( pulLock ) = 0U;                       \
+    } while( 0 )
+
+#endif /* ifndef TEST_CONFIG_H */